@@ -0,0 +1,78 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/autocode/breit1.c" "CMakeFiles/cint.dir/src/autocode/breit1.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/breit1.c.o.d"
+  "/root/repo/src/autocode/deriv3.c" "CMakeFiles/cint.dir/src/autocode/deriv3.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/deriv3.c.o.d"
+  "/root/repo/src/autocode/dkb.c" "CMakeFiles/cint.dir/src/autocode/dkb.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/dkb.c.o.d"
+  "/root/repo/src/autocode/gaunt1.c" "CMakeFiles/cint.dir/src/autocode/gaunt1.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/gaunt1.c.o.d"
+  "/root/repo/src/autocode/grad1.c" "CMakeFiles/cint.dir/src/autocode/grad1.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/grad1.c.o.d"
+  "/root/repo/src/autocode/grad2.c" "CMakeFiles/cint.dir/src/autocode/grad2.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/grad2.c.o.d"
+  "/root/repo/src/autocode/hess.c" "CMakeFiles/cint.dir/src/autocode/hess.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/hess.c.o.d"
+  "/root/repo/src/autocode/int1e_grids1.c" "CMakeFiles/cint.dir/src/autocode/int1e_grids1.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/int1e_grids1.c.o.d"
+  "/root/repo/src/autocode/int3c1e.c" "CMakeFiles/cint.dir/src/autocode/int3c1e.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/int3c1e.c.o.d"
+  "/root/repo/src/autocode/int3c2e.c" "CMakeFiles/cint.dir/src/autocode/int3c2e.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/int3c2e.c.o.d"
+  "/root/repo/src/autocode/intor1.c" "CMakeFiles/cint.dir/src/autocode/intor1.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/intor1.c.o.d"
+  "/root/repo/src/autocode/intor2.c" "CMakeFiles/cint.dir/src/autocode/intor2.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/intor2.c.o.d"
+  "/root/repo/src/autocode/intor3.c" "CMakeFiles/cint.dir/src/autocode/intor3.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/intor3.c.o.d"
+  "/root/repo/src/autocode/intor4.c" "CMakeFiles/cint.dir/src/autocode/intor4.c.o" "gcc" "CMakeFiles/cint.dir/src/autocode/intor4.c.o.d"
+  "/root/repo/src/breit.c" "CMakeFiles/cint.dir/src/breit.c.o" "gcc" "CMakeFiles/cint.dir/src/breit.c.o.d"
+  "/root/repo/src/c2f.c" "CMakeFiles/cint.dir/src/c2f.c.o" "gcc" "CMakeFiles/cint.dir/src/c2f.c.o.d"
+  "/root/repo/src/cart2sph.c" "CMakeFiles/cint.dir/src/cart2sph.c.o" "gcc" "CMakeFiles/cint.dir/src/cart2sph.c.o.d"
+  "/root/repo/src/cint1e.c" "CMakeFiles/cint.dir/src/cint1e.c.o" "gcc" "CMakeFiles/cint.dir/src/cint1e.c.o.d"
+  "/root/repo/src/cint1e_a.c" "CMakeFiles/cint.dir/src/cint1e_a.c.o" "gcc" "CMakeFiles/cint.dir/src/cint1e_a.c.o.d"
+  "/root/repo/src/cint1e_grids.c" "CMakeFiles/cint.dir/src/cint1e_grids.c.o" "gcc" "CMakeFiles/cint.dir/src/cint1e_grids.c.o.d"
+  "/root/repo/src/cint1e_multi.c" "CMakeFiles/cint.dir/src/cint1e_multi.c.o" "gcc" "CMakeFiles/cint.dir/src/cint1e_multi.c.o.d"
+  "/root/repo/src/cint2c2e.c" "CMakeFiles/cint.dir/src/cint2c2e.c.o" "gcc" "CMakeFiles/cint.dir/src/cint2c2e.c.o.d"
+  "/root/repo/src/cint2e.c" "CMakeFiles/cint.dir/src/cint2e.c.o" "gcc" "CMakeFiles/cint.dir/src/cint2e.c.o.d"
+  "/root/repo/src/cint2e_fill.c" "CMakeFiles/cint.dir/src/cint2e_fill.c.o" "gcc" "CMakeFiles/cint.dir/src/cint2e_fill.c.o.d"
+  "/root/repo/src/cint2e_rsh.c" "CMakeFiles/cint.dir/src/cint2e_rsh.c.o" "gcc" "CMakeFiles/cint.dir/src/cint2e_rsh.c.o.d"
+  "/root/repo/src/cint2e_tower.c" "CMakeFiles/cint.dir/src/cint2e_tower.c.o" "gcc" "CMakeFiles/cint.dir/src/cint2e_tower.c.o.d"
+  "/root/repo/src/cint3c1e.c" "CMakeFiles/cint.dir/src/cint3c1e.c.o" "gcc" "CMakeFiles/cint.dir/src/cint3c1e.c.o.d"
+  "/root/repo/src/cint3c1e_a.c" "CMakeFiles/cint.dir/src/cint3c1e_a.c.o" "gcc" "CMakeFiles/cint.dir/src/cint3c1e_a.c.o.d"
+  "/root/repo/src/cint3c2e.c" "CMakeFiles/cint.dir/src/cint3c2e.c.o" "gcc" "CMakeFiles/cint.dir/src/cint3c2e.c.o.d"
+  "/root/repo/src/cint_bas.c" "CMakeFiles/cint.dir/src/cint_bas.c.o" "gcc" "CMakeFiles/cint.dir/src/cint_bas.c.o.d"
+  "/root/repo/src/cint_eri_cache.c" "CMakeFiles/cint.dir/src/cint_eri_cache.c.o" "gcc" "CMakeFiles/cint.dir/src/cint_eri_cache.c.o.d"
+  "/root/repo/src/cint_eri_file.c" "CMakeFiles/cint.dir/src/cint_eri_file.c.o" "gcc" "CMakeFiles/cint.dir/src/cint_eri_file.c.o.d"
+  "/root/repo/src/cint_multipole.c" "CMakeFiles/cint.dir/src/cint_multipole.c.o" "gcc" "CMakeFiles/cint.dir/src/cint_multipole.c.o.d"
+  "/root/repo/src/cint_params.c" "CMakeFiles/cint.dir/src/cint_params.c.o" "gcc" "CMakeFiles/cint.dir/src/cint_params.c.o.d"
+  "/root/repo/src/cint_pipeline.c" "CMakeFiles/cint.dir/src/cint_pipeline.c.o" "gcc" "CMakeFiles/cint.dir/src/cint_pipeline.c.o.d"
+  "/root/repo/src/cint_sched.c" "CMakeFiles/cint.dir/src/cint_sched.c.o" "gcc" "CMakeFiles/cint.dir/src/cint_sched.c.o.d"
+  "/root/repo/src/eigh.c" "CMakeFiles/cint.dir/src/eigh.c.o" "gcc" "CMakeFiles/cint.dir/src/eigh.c.o.d"
+  "/root/repo/src/fblas.c" "CMakeFiles/cint.dir/src/fblas.c.o" "gcc" "CMakeFiles/cint.dir/src/fblas.c.o.d"
+  "/root/repo/src/find_roots.c" "CMakeFiles/cint.dir/src/find_roots.c.o" "gcc" "CMakeFiles/cint.dir/src/find_roots.c.o.d"
+  "/root/repo/src/fmt.c" "CMakeFiles/cint.dir/src/fmt.c.o" "gcc" "CMakeFiles/cint.dir/src/fmt.c.o.d"
+  "/root/repo/src/g1e.c" "CMakeFiles/cint.dir/src/g1e.c.o" "gcc" "CMakeFiles/cint.dir/src/g1e.c.o.d"
+  "/root/repo/src/g1e_grids.c" "CMakeFiles/cint.dir/src/g1e_grids.c.o" "gcc" "CMakeFiles/cint.dir/src/g1e_grids.c.o.d"
+  "/root/repo/src/g2e.c" "CMakeFiles/cint.dir/src/g2e.c.o" "gcc" "CMakeFiles/cint.dir/src/g2e.c.o.d"
+  "/root/repo/src/g2e_f32.c" "CMakeFiles/cint.dir/src/g2e_f32.c.o" "gcc" "CMakeFiles/cint.dir/src/g2e_f32.c.o.d"
+  "/root/repo/src/g2e_simd1.c" "CMakeFiles/cint.dir/src/g2e_simd1.c.o" "gcc" "CMakeFiles/cint.dir/src/g2e_simd1.c.o.d"
+  "/root/repo/src/g3c1e.c" "CMakeFiles/cint.dir/src/g3c1e.c.o" "gcc" "CMakeFiles/cint.dir/src/g3c1e.c.o.d"
+  "/root/repo/src/g3c2e.c" "CMakeFiles/cint.dir/src/g3c2e.c.o" "gcc" "CMakeFiles/cint.dir/src/g3c2e.c.o.d"
+  "/root/repo/src/gout2e.c" "CMakeFiles/cint.dir/src/gout2e.c.o" "gcc" "CMakeFiles/cint.dir/src/gout2e.c.o.d"
+  "/root/repo/src/misc.c" "CMakeFiles/cint.dir/src/misc.c.o" "gcc" "CMakeFiles/cint.dir/src/misc.c.o.d"
+  "/root/repo/src/optimizer.c" "CMakeFiles/cint.dir/src/optimizer.c.o" "gcc" "CMakeFiles/cint.dir/src/optimizer.c.o.d"
+  "/root/repo/src/polyfits.c" "CMakeFiles/cint.dir/src/polyfits.c.o" "gcc" "CMakeFiles/cint.dir/src/polyfits.c.o.d"
+  "/root/repo/src/rys_roots.c" "CMakeFiles/cint.dir/src/rys_roots.c.o" "gcc" "CMakeFiles/cint.dir/src/rys_roots.c.o.d"
+  "/root/repo/src/rys_wheeler.c" "CMakeFiles/cint.dir/src/rys_wheeler.c.o" "gcc" "CMakeFiles/cint.dir/src/rys_wheeler.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/build/libcint.so" "/root/repo/build/libcint.so.7.0.0"
+  "/root/repo/build/libcint.so.7" "/root/repo/build/libcint.so.7.0.0"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
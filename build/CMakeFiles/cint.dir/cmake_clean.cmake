@@ -0,0 +1,117 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cint.dir/src/autocode/breit1.c.o"
+  "CMakeFiles/cint.dir/src/autocode/breit1.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/deriv3.c.o"
+  "CMakeFiles/cint.dir/src/autocode/deriv3.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/dkb.c.o"
+  "CMakeFiles/cint.dir/src/autocode/dkb.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/gaunt1.c.o"
+  "CMakeFiles/cint.dir/src/autocode/gaunt1.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/grad1.c.o"
+  "CMakeFiles/cint.dir/src/autocode/grad1.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/grad2.c.o"
+  "CMakeFiles/cint.dir/src/autocode/grad2.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/hess.c.o"
+  "CMakeFiles/cint.dir/src/autocode/hess.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/int1e_grids1.c.o"
+  "CMakeFiles/cint.dir/src/autocode/int1e_grids1.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/int3c1e.c.o"
+  "CMakeFiles/cint.dir/src/autocode/int3c1e.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/int3c2e.c.o"
+  "CMakeFiles/cint.dir/src/autocode/int3c2e.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/intor1.c.o"
+  "CMakeFiles/cint.dir/src/autocode/intor1.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/intor2.c.o"
+  "CMakeFiles/cint.dir/src/autocode/intor2.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/intor3.c.o"
+  "CMakeFiles/cint.dir/src/autocode/intor3.c.o.d"
+  "CMakeFiles/cint.dir/src/autocode/intor4.c.o"
+  "CMakeFiles/cint.dir/src/autocode/intor4.c.o.d"
+  "CMakeFiles/cint.dir/src/breit.c.o"
+  "CMakeFiles/cint.dir/src/breit.c.o.d"
+  "CMakeFiles/cint.dir/src/c2f.c.o"
+  "CMakeFiles/cint.dir/src/c2f.c.o.d"
+  "CMakeFiles/cint.dir/src/cart2sph.c.o"
+  "CMakeFiles/cint.dir/src/cart2sph.c.o.d"
+  "CMakeFiles/cint.dir/src/cint1e.c.o"
+  "CMakeFiles/cint.dir/src/cint1e.c.o.d"
+  "CMakeFiles/cint.dir/src/cint1e_a.c.o"
+  "CMakeFiles/cint.dir/src/cint1e_a.c.o.d"
+  "CMakeFiles/cint.dir/src/cint1e_grids.c.o"
+  "CMakeFiles/cint.dir/src/cint1e_grids.c.o.d"
+  "CMakeFiles/cint.dir/src/cint1e_multi.c.o"
+  "CMakeFiles/cint.dir/src/cint1e_multi.c.o.d"
+  "CMakeFiles/cint.dir/src/cint2c2e.c.o"
+  "CMakeFiles/cint.dir/src/cint2c2e.c.o.d"
+  "CMakeFiles/cint.dir/src/cint2e.c.o"
+  "CMakeFiles/cint.dir/src/cint2e.c.o.d"
+  "CMakeFiles/cint.dir/src/cint2e_fill.c.o"
+  "CMakeFiles/cint.dir/src/cint2e_fill.c.o.d"
+  "CMakeFiles/cint.dir/src/cint2e_rsh.c.o"
+  "CMakeFiles/cint.dir/src/cint2e_rsh.c.o.d"
+  "CMakeFiles/cint.dir/src/cint2e_tower.c.o"
+  "CMakeFiles/cint.dir/src/cint2e_tower.c.o.d"
+  "CMakeFiles/cint.dir/src/cint3c1e.c.o"
+  "CMakeFiles/cint.dir/src/cint3c1e.c.o.d"
+  "CMakeFiles/cint.dir/src/cint3c1e_a.c.o"
+  "CMakeFiles/cint.dir/src/cint3c1e_a.c.o.d"
+  "CMakeFiles/cint.dir/src/cint3c2e.c.o"
+  "CMakeFiles/cint.dir/src/cint3c2e.c.o.d"
+  "CMakeFiles/cint.dir/src/cint_bas.c.o"
+  "CMakeFiles/cint.dir/src/cint_bas.c.o.d"
+  "CMakeFiles/cint.dir/src/cint_eri_cache.c.o"
+  "CMakeFiles/cint.dir/src/cint_eri_cache.c.o.d"
+  "CMakeFiles/cint.dir/src/cint_eri_file.c.o"
+  "CMakeFiles/cint.dir/src/cint_eri_file.c.o.d"
+  "CMakeFiles/cint.dir/src/cint_multipole.c.o"
+  "CMakeFiles/cint.dir/src/cint_multipole.c.o.d"
+  "CMakeFiles/cint.dir/src/cint_params.c.o"
+  "CMakeFiles/cint.dir/src/cint_params.c.o.d"
+  "CMakeFiles/cint.dir/src/cint_pipeline.c.o"
+  "CMakeFiles/cint.dir/src/cint_pipeline.c.o.d"
+  "CMakeFiles/cint.dir/src/cint_sched.c.o"
+  "CMakeFiles/cint.dir/src/cint_sched.c.o.d"
+  "CMakeFiles/cint.dir/src/eigh.c.o"
+  "CMakeFiles/cint.dir/src/eigh.c.o.d"
+  "CMakeFiles/cint.dir/src/fblas.c.o"
+  "CMakeFiles/cint.dir/src/fblas.c.o.d"
+  "CMakeFiles/cint.dir/src/find_roots.c.o"
+  "CMakeFiles/cint.dir/src/find_roots.c.o.d"
+  "CMakeFiles/cint.dir/src/fmt.c.o"
+  "CMakeFiles/cint.dir/src/fmt.c.o.d"
+  "CMakeFiles/cint.dir/src/g1e.c.o"
+  "CMakeFiles/cint.dir/src/g1e.c.o.d"
+  "CMakeFiles/cint.dir/src/g1e_grids.c.o"
+  "CMakeFiles/cint.dir/src/g1e_grids.c.o.d"
+  "CMakeFiles/cint.dir/src/g2e.c.o"
+  "CMakeFiles/cint.dir/src/g2e.c.o.d"
+  "CMakeFiles/cint.dir/src/g2e_f32.c.o"
+  "CMakeFiles/cint.dir/src/g2e_f32.c.o.d"
+  "CMakeFiles/cint.dir/src/g2e_simd1.c.o"
+  "CMakeFiles/cint.dir/src/g2e_simd1.c.o.d"
+  "CMakeFiles/cint.dir/src/g3c1e.c.o"
+  "CMakeFiles/cint.dir/src/g3c1e.c.o.d"
+  "CMakeFiles/cint.dir/src/g3c2e.c.o"
+  "CMakeFiles/cint.dir/src/g3c2e.c.o.d"
+  "CMakeFiles/cint.dir/src/gout2e.c.o"
+  "CMakeFiles/cint.dir/src/gout2e.c.o.d"
+  "CMakeFiles/cint.dir/src/misc.c.o"
+  "CMakeFiles/cint.dir/src/misc.c.o.d"
+  "CMakeFiles/cint.dir/src/optimizer.c.o"
+  "CMakeFiles/cint.dir/src/optimizer.c.o.d"
+  "CMakeFiles/cint.dir/src/polyfits.c.o"
+  "CMakeFiles/cint.dir/src/polyfits.c.o.d"
+  "CMakeFiles/cint.dir/src/rys_roots.c.o"
+  "CMakeFiles/cint.dir/src/rys_roots.c.o.d"
+  "CMakeFiles/cint.dir/src/rys_wheeler.c.o"
+  "CMakeFiles/cint.dir/src/rys_wheeler.c.o.d"
+  "libcint.pdb"
+  "libcint.so"
+  "libcint.so.7"
+  "libcint.so.7.0.0"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/cint.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,572 @@
+/*
+ * Qints is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qints.
+ *
+ * Qints is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Parameters and function prototypes for libcint.
+ */
+
+#define QCINT_VERSION           "7.0.0"
+#define CINT_SOVERSION          7
+
+/* #undef CACHE_SIZE_I8 */
+#ifdef CACHE_SIZE_I8
+#include <stdint.h>
+#define CACHE_SIZE_T int64_t
+#else
+#define CACHE_SIZE_T int
+#endif
+
+// global parameters in env
+// Overall cutoff for integral prescreening, value needs to be ~ln(threshold)
+#define PTR_EXPCUTOFF           0
+// R_C of (r-R_C) in dipole, GIAO operators
+#define PTR_COMMON_ORIG         1
+// R_O in 1/|r-R_O|
+#define PTR_RINV_ORIG           4
+// ZETA parameter for Gaussian charge distribution (Gaussian nuclear model)
+#define PTR_RINV_ZETA           7
+// omega parameter in range-separated coulomb operator
+// LR interaction: erf(omega*r12)/r12 if omega > 0
+// SR interaction: erfc(omega*r12)/r12 if omega < 0
+#define PTR_RANGE_OMEGA         8
+// Yukawa potential and Slater-type geminal e^{-zeta r}
+#define PTR_F12_ZETA            9
+// Gaussian type geminal e^{-zeta r^2}
+#define PTR_GTG_ZETA            10
+#define NGRIDS                  11
+#define PTR_GRIDS               12
+// Evaluate the Rys recurrences of int2e in single precision if != 0, for
+// shell quartets of li+lj+lk+ll <= 8 (errors ~1e-7 of the largest integral)
+#define PTR_MIXED_PRECISION     13
+// Operators of int2e_rsh: their number, the env offset of the omegas, and the
+// env offset of the coefficients (0 for one component per operator)
+#define NRSH_OMEGA              14
+#define PTR_RSH_OMEGA           15
+#define PTR_RSH_COEFF           16
+#define PTR_ENV_START           20
+
+
+// slots of atm
+#define CHARGE_OF       0
+#define PTR_COORD       1
+#define NUC_MOD_OF      2
+#define PTR_ZETA        3
+#define PTR_FRAC_CHARGE 4
+#define RESERVE_ATMSLOT 5
+#define ATM_SLOTS       6
+
+
+// slots of bas
+#define ATOM_OF         0
+#define ANG_OF          1
+#define NPRIM_OF        2
+#define NCTR_OF         3
+#define KAPPA_OF        4
+#define PTR_EXP         5
+#define PTR_COEFF       6
+#define RESERVE_BASLOT  7
+#define BAS_SLOTS       8
+
+// slots of gout
+#define POSX            0
+#define POSY            1
+#define POSZ            2
+#define POS1            3
+// For 2-electron integral with two spin operators
+// SIGMA1X * SIGMA2X     0
+// SIGMA1Y * SIGMA2X     1
+// SIGMA1Z * SIGMA2X     2
+// I1_2x2  * SIGMA2X     3
+// SIGMA1X * SIGMA2Y     4
+// SIGMA1Y * SIGMA2Y     5
+// SIGMA1Z * SIGMA2Y     6
+// I1_2x2  * SIGMA2Y     7
+// SIGMA1X * SIGMA2Z     8
+// SIGMA1Y * SIGMA2Z     9
+// SIGMA1Z * SIGMA2Z     10
+// I1_2x2  * SIGMA2Z     11
+// SIGMA1X * I2_2x2      12
+// SIGMA1Y * I2_2x2      13
+// SIGMA1Z * I2_2x2      14
+// I1_2x2  * I2_2x2      15
+#define POSXX           0
+#define POSYX           1
+#define POSZX           2
+#define POS1X           3
+#define POSXY           4
+#define POSYY           5
+#define POSZY           6
+#define POS1Y           7
+#define POSXZ           8
+#define POSYZ           9
+#define POSZZ           10
+#define POS1Z           11
+#define POSX1           12
+#define POSY1           13
+#define POSZ1           14
+#define POS11           15
+
+// tensor
+#define TSRX        0
+#define TSRY        1
+#define TSRZ        2
+#define TSRXX       0
+#define TSRXY       1
+#define TSRXZ       2
+#define TSRYX       3
+#define TSRYY       4
+#define TSRYZ       5
+#define TSRZX       6
+#define TSRZY       7
+#define TSRZZ       8
+
+// other boundaries
+#define MXRYSROOTS      32 // > ANG_MAX*2+1 for 4c2e
+#define ANG_MAX         15 // l = 0..15
+#define LMAX1           16 // > ANG_MAX
+#define CART_MAX        136 // > (ANG_MAX*(ANG_MAX+1)/2)
+#define SHLS_MAX        1048576
+#define NPRIM_MAX       64
+#define NCTR_MAX        64
+
+#define POINT_NUC       1
+#define GAUSSIAN_NUC    2
+#define FRAC_CHARGE_NUC 3
+
+#define bas(SLOT,I)     bas[BAS_SLOTS * (I) + (SLOT)]
+#define atm(SLOT,I)     atm[ATM_SLOTS * (I) + (SLOT)]
+
+#include <immintrin.h>
+#include <mm_malloc.h>
+
+#define QCINT_SIMDD 8
+#ifdef QCINT_SIMDD
+#define SIMDD QCINT_SIMDD
+#else
+#ifdef __AVX512F__
+#define SIMDD   8
+#elif __AVX__
+#define SIMDD   4
+#elif __SSE3__
+#define SIMDD   2
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define ALIGN16 __attribute__((aligned(16)))
+#define ALIGN32 __attribute__((aligned(32)))
+#define ALIGNMM __attribute__((aligned(SIMDD*8)))
+#define RESTRICT __restrict__
+#else
+#define ALIGN16
+#define ALIGN32
+#define ALIGNMM
+#define RESTRICT
+#endif
+
+#ifndef HAVE_DEFINED_CINTOPT_H
+#define HAVE_DEFINED_CINTOPT_H
+typedef struct {
+    double rij[3];
+    double eij;
+    double cceij;
+} PairData;
+typedef struct {
+    int **index_xyz_array; // LMAX1**4 pointers to index_xyz
+    int **non0ctr;
+    int **sortedidx;
+    int nbas;
+    double **log_max_coeff;
+    PairData **pairdata;  // NULL indicates not-initialized, NO_VALUE can be skipped
+    int ijkl_inc;  // increment of angular momentum used by pairdata screening
+    double *pair_shift;  // angular momentum term of the pairdata screening
+    struct CINTBasisData *basis;  // shared by the optimizers of the same basis
+    double expcutoff;  // cutoff of the pairdata screening, from env[PTR_EXPCUTOFF]
+} CINTOpt;
+
+// Add this macro def to make pyscf compatible with both v4 and v5
+#define HAVE_DEFINED_CINTENVVARS_H
+typedef struct {
+        int *atm;
+        int *bas;
+        double *env;
+        int *shls;
+        int natm;
+        int nbas;
+
+        int i_l;
+        int j_l;
+        int k_l;
+        int l_l;
+        int nfi;  // number of cartesian components
+        int nfj;
+        // in int1e_grids, the grids_offset and the number of grids
+        union {int nfk; int grids_offset;};
+        union {int nfl; int ngrids;};
+        int nf;  // = nfi*nfj*nfk*nfl;
+        int rys_order; // = nrys_roots for regular ERIs. can be nrys_roots/2 for SR ERIs
+        int x_ctr[4];
+
+        int gbits;
+        int ncomp_e1; // = 1 if spin free, = 4 when spin included, it
+        int ncomp_e2; // corresponds to POSX,POSY,POSZ,POS1, see cint.h
+        int ncomp_tensor; // e.g. = 3 for gradients
+
+        /* values may diff based on the g0_2d4d algorithm */
+        int li_ceil; // power of x, == i_l if nabla is involved, otherwise == i_l
+        int lj_ceil;
+        int lk_ceil;
+        int ll_ceil;
+        int g_stride_i; // nrys_roots * shift of (i++,k,l,j)
+        int g_stride_k; // nrys_roots * shift of (i,k++,l,j)
+        int g_stride_l; // nrys_roots * shift of (i,k,l++,j)
+        int g_stride_j; // nrys_roots * shift of (i,k,l,j++)
+        int nrys_roots;
+        int g_size;  // ref to cint2e.c g = malloc(sizeof(double)*g_size)
+
+        int g2d_ijmax;
+        int g2d_klmax;
+        double common_factor;
+        double expcutoff;
+        double rirj[3]; // diff by sign in different g0_2d4d algorithm
+        double rkrl[3];
+        double *rx_in_rijrx;
+        double *rx_in_rklrx;
+
+        double *ri;
+        double *rj;
+        double *rk;
+        // in int2e or int3c2e, the coordinates of the fourth shell
+        // in int1e_grids, the pointer for the grids coordinates
+        union {double *rl; double *grids;};
+
+        int (*f_g0_2e)();
+        int (*f_g0_2e_simd1)();
+        void (*f_g0_2d4d)();
+        void (*f_g0_2d4d_simd1)();
+        void (*f_gout)();
+        void (*f_gout_simd1)();
+        CINTOpt *opt;
+
+        /* values are assigned during calculation */
+        int *idx;
+        ALIGNMM double ai[SIMDD];
+        ALIGNMM double aj[SIMDD];
+        ALIGNMM double ak[SIMDD];
+        ALIGNMM double al[SIMDD];
+        ALIGNMM double fac[SIMDD];
+        ALIGNMM double rij[SIMDD*3];
+        ALIGNMM double rkl[SIMDD*3];
+
+        /* appended to keep the layout of the fields above.  The size of
+         * CINTEnvVars changes and the soname is bumped to CINT_SOVERSION 7 */
+        // != 0 if the cost model of CINTinit_int2e_EnvVars prefers to
+        // transform the primitive integrals to spherical before contraction
+        int c2s_prim;
+        // the global parameters env[0:PTR_ENV_START], or the overrides of
+        // CINTcall_with_params
+        double *params;
+} CINTEnvVars;
+
+// Operator parameters which override the global parameters of env for one
+// call of CINTcall_with_params.  grids (ngrids*3 coordinates indexed by
+// shls[2:4]) are used by int1e_grids if not NULL.  The optimizer is built
+// from env; for the short-range Coulomb operator, the optimizer should be
+// created with an omega < 0 of magnitude >= |range_omega|.
+typedef struct {
+        double common_orig[3];
+        double rinv_orig[3];
+        double rinv_zeta;
+        double range_omega;
+        double f12_zeta;
+        double gtg_zeta;
+        double *grids;
+} CINTOpParams;
+
+// Integral cache of CINTeri_cache_create
+typedef struct CINTEriCache CINTEriCache;
+// Integral file of CINTeri_file_open
+typedef struct CINTEriFile CINTEriFile;
+#endif
+
+int CINTlen_cart(const int l);
+int CINTlen_spinor(const int bas_id, const int *bas);
+
+int CINTcgtos_cart(const int bas_id, const int *bas);
+int CINTcgtos_spheric(const int bas_id, const int *bas);
+int CINTcgtos_spinor(const int bas_id, const int *bas);
+int CINTcgto_cart(const int bas_id, const int *bas);
+int CINTcgto_spheric(const int bas_id, const int *bas);
+int CINTcgto_spinor(const int bas_id, const int *bas);
+
+int CINTtot_pgto_spheric(const int *bas, const int nbas);
+int CINTtot_pgto_spinor(const int *bas, const int nbas);
+
+int CINTtot_cgto_cart(const int *bas, const int nbas);
+int CINTtot_cgto_spheric(const int *bas, const int nbas);
+int CINTtot_cgto_spinor(const int *bas, const int nbas);
+
+void CINTshells_cart_offset(int ao_loc[], const int *bas, const int nbas);
+void CINTshells_spheric_offset(int ao_loc[], const int *bas, const int nbas);
+void CINTshells_spinor_offset(int ao_loc[], const int *bas, const int nbas);
+// Same as CINTshells_*_offset with the total number of AOs in ao_loc[nbas]
+void CINTshells_cart_loc(int ao_loc[], const int *bas, const int nbas);
+void CINTshells_spheric_loc(int ao_loc[], const int *bas, const int nbas);
+
+double *CINTc2s_bra_sph(double *sph, int nket, double *cart, int l);
+double *CINTc2s_ket_sph(double *sph, int nket, double *cart, int l);
+double *CINTc2s_ket_sph1(double *sph, double *cart, int lds, int ldc, int l);
+
+
+double CINTgto_norm(int n, double a);
+
+// operators of the multi-operator 1e driver int1e_multi_*
+// <i|j>
+#define INT1E_MULTI_OVLP        0
+// <i|-1/2 nabla^2|j>
+#define INT1E_MULTI_KIN         1
+// <i|sum_A -Z_A/|r-R_A||j>
+#define INT1E_MULTI_NUC         2
+// <i|r-R_C|j>, 3 components, R_C = env[PTR_COMMON_ORIG]
+#define INT1E_MULTI_R           3
+// <i|(r-R_C)(r-R_C)|j>, 9 components
+#define INT1E_MULTI_RR          4
+#define INT1E_MULTI_NOPS_MAX    16
+
+int int1e_multi_ncomp(int *ops, int nops);
+void int1e_multi_optimizer(CINTOpt **opt, int *ops, int nops,
+                           int *atm, int natm, int *bas, int nbas, double *env);
+CACHE_SIZE_T int1e_multi_cart(double *out, int *dims, int *ops, int nops, int *shls,
+                              int *atm, int natm, int *bas, int nbas, double *env,
+                              CINTOpt *opt, double *cache);
+CACHE_SIZE_T int1e_multi_sph(double *out, int *dims, int *ops, int nops, int *shls,
+                             int *atm, int natm, int *bas, int nbas, double *env,
+                             CINTOpt *opt, double *cache);
+// Fill the matrices of all operators for the shell ranges
+// shls_slice = [ish0, ish1, jsh0, jsh1].  The output is stored as
+// out[comp, j, i] with the components of the operators in the order of ops.
+void int1e_multi_fill_cart(double *out, int *ops, int nops, int *shls_slice,
+                           int *atm, int natm, int *bas, int nbas, double *env);
+void int1e_multi_fill_sph(double *out, int *ops, int nops, int *shls_slice,
+                          int *atm, int natm, int *bas, int nbas, double *env);
+
+// Multipole approximation of far-field ERIs
+#define MULTIPOLE_ORDER_MAX     8
+// Number of Cartesian moments up to the given order
+int CINTpair_multipole_ncomp(int order);
+// Moments <i|(r-C)^a|j> of a shell pair about center, |a| <= order.  The
+// output is stored as out[moment, j, i], moments sorted by |a| first
+void int1e_pair_multipole_optimizer(CINTOpt **opt, int order, int *atm, int natm,
+                                    int *bas, int nbas, double *env);
+CACHE_SIZE_T int1e_pair_multipole_cart(double *out, int *dims, int order, double *center,
+                                       int *shls, int *atm, int natm,
+                                       int *bas, int nbas, double *env,
+                                       CINTOpt *opt, double *cache);
+CACHE_SIZE_T int1e_pair_multipole_sph(double *out, int *dims, int order, double *center,
+                                      int *shls, int *atm, int natm,
+                                      int *bas, int nbas, double *env,
+                                      CINTOpt *opt, double *cache);
+// Center and extent of the charge distribution of the pair shls[0], shls[1]
+double CINTpair_extent(double *center, double eps, int *shls,
+                       int *atm, int natm, int *bas, int nbas, double *env);
+// Whether the multipole expansion of the quartet at the given order is
+// accurate to eps
+int CINTquartet_is_far(int order, double eps, int *shls,
+                       int *atm, int natm, int *bas, int nbas, double *env);
+// (ij|kl) from the moments of the pairs ij and kl
+void CINTmultipole_eri(double *out, int nij, int nkl, int order,
+                       double *mij, double *cij, double *mkl, double *ckl,
+                       double *buf);
+// Multipole approximation of int2e_cart and int2e_sph
+CACHE_SIZE_T int2e_far_cart(double *out, int *dims, int order, int *shls,
+                            int *atm, int natm, int *bas, int nbas, double *env,
+                            double *cache);
+CACHE_SIZE_T int2e_far_sph(double *out, int *dims, int order, int *shls,
+                           int *atm, int natm, int *bas, int nbas, double *env,
+                           double *cache);
+
+// ERIs of several attenuated Coulomb operators in one pass.  The n-th
+// operator is 1/r for omega = 0, erf(omega r)/r for omega > 0 and
+// erfc(|omega| r)/r for omega < 0, omega = env[env[PTR_RSH_OMEGA]+n],
+// n < env[NRSH_OMEGA] <= 4.  If env[PTR_RSH_COEFF] is 0, one component is
+// returned for each operator, otherwise sum_n coeffs[n] (ij|op_n|kl) with
+// coeffs[n] = env[env[PTR_RSH_COEFF]+n].  env[PTR_RANGE_OMEGA] must be 0.
+// The optimizer of int2e_cart/int2e_sph can be used.
+CACHE_SIZE_T int2e_rsh_cart(double *out, int *dims, int *shls,
+                            int *atm, int natm, int *bas, int nbas, double *env,
+                            CINTOpt *opt, double *cache);
+CACHE_SIZE_T int2e_rsh_sph(double *out, int *dims, int *shls,
+                           int *atm, int natm, int *bas, int nbas, double *env,
+                           CINTOpt *opt, double *cache);
+
+// ERI tensor of a shell range in symmetry-packed storage.  intor is a
+// single-component 2e integral function with 8-fold symmetry (int2e_sph,
+// int2e_cart) and opt its optimizer (can be NULL).  ao_loc[nbas+1] are the
+// AO offsets of the shells for intor.  AO indices are relative to the first
+// AO of the slice and pairs are packed as ij = i*(i+1)/2+j, i >= j.
+// s8: shls_slice = [sh0, sh1], out[ij*(ij+1)/2+kl] for kl <= ij
+void CINTeri_fill_s8(double *out, CACHE_SIZE_T (*intor)(), int *ao_loc,
+                     int *shls_slice, CINTOpt *opt,
+                     int *atm, int natm, int *bas, int nbas, double *env);
+// s4: shls_slice = [ish0, ish1, ksh0, ksh1], out[ij*nkl+kl], nkl the number
+// of pairs k >= l in the ket range
+void CINTeri_fill_s4(double *out, CACHE_SIZE_T (*intor)(), int *ao_loc,
+                     int *shls_slice, CINTOpt *opt,
+                     int *atm, int natm, int *bas, int nbas, double *env);
+// AO-to-MO transformation of the ket of (ij|kl) for the shell ranges
+// shls_slice = [ish0, ish1, jsh0, jsh1, ksh0, ksh1], k and l both in the
+// third range.  intor needs the ij and kl symmetries (int2e_sph, int2e_cart):
+// the blocks (jsh,ish) of the overlapping bra ranges are not evaluated but
+// taken as the transpose of (ish,jsh).
+// mo_k[p,kappa] and mo_l[q,lambda] are the MO coefficients of the AOs in
+// the ket range (nao_k rows).  The output is stored as out[q,p,j,i].  If
+// mo_l is NULL, only the first index is transformed and out[lambda,p,j,i]
+// is returned.  The bra ranges can be split into batches to bound memory.
+void CINTeri_ket_ao2mo(double *out, CACHE_SIZE_T (*intor)(), int *ao_loc,
+                       int *shls_slice, double *mo_k, int nmo_k,
+                       double *mo_l, int nmo_l, CINTOpt *opt,
+                       int *atm, int natm, int *bas, int nbas, double *env);
+// Pivoted Cholesky decomposition (ij|kl) = sum_m L[m,ij] L[m,kl] over the AO
+// pairs ij = i*(i+1)/2+j of shls_slice = [sh0, sh1], until the largest
+// residual diagonal is below threshold.  The vectors are stored in
+// out[max_vec,npair].  Returns the number of vectors.
+int CINTcholesky_eri(double *out, int max_vec, double threshold,
+                     CACHE_SIZE_T (*intor)(), int *ao_loc, int *shls_slice,
+                     CINTOpt *opt, int *atm, int natm, int *bas, int nbas, double *env);
+
+// Electronic part of the electrostatic potential on grids[ngrids,3],
+// out_v[g] = sum_ij dm[i,j] <i|1/|r-r_g||j>, for the AO density matrix
+// dm[nao,nao] of all shells
+void CINTesp_grids_sph(double *out_v, double *dm, double *grids, int ngrids,
+                       int *atm, int natm, int *bas, int nbas, double *env);
+void CINTesp_grids_cart(double *out_v, double *dm, double *grids, int ngrids,
+                        int *atm, int natm, int *bas, int nbas, double *env);
+
+// Potential matrix of point charges charges[ncharges] at coords[ncharges,3],
+// out[j,i] = sum_g q_g <i|1/|r-R_g||j>.  Gaussian charges are used if
+// env[PTR_RINV_ZETA] is set.
+void CINTpoint_charges_fock_sph(double *out, double *coords, double *charges, int ncharges,
+                                int *atm, int natm, int *bas, int nbas, double *env);
+void CINTpoint_charges_fock_cart(double *out, double *coords, double *charges, int ncharges,
+                                 int *atm, int natm, int *bas, int nbas, double *env);
+
+// Initializes params with the global parameters of env
+void CINTinit_op_params(CINTOpParams *params, double *env);
+// Evaluates intor with the parameters of params.  env is not modified and
+// can be shared by threads which use different params.
+CACHE_SIZE_T CINTcall_with_params(CACHE_SIZE_T (*intor)(), CINTOpParams *params,
+                                  double *out, int *dims, int *shls,
+                                  int *atm, int natm, int *bas, int nbas, double *env,
+                                  CINTOpt *opt, double *cache);
+
+// Estimated cost of the shell quartet shls[4] for the screening of opt (an
+// int2e optimizer).  Returns 0 if the quartet is screened by the optimizer
+// and -1 if opt does not have the basis data.
+double CINTquartet_cost(CINTOpt *opt, int *shls);
+
+// Integral-direct pipeline.  nproducer threads evaluate intor for the shells
+// shls[ntask,4] (the first ncenter of each row are used) while nconsumer
+// threads digest the results with digest(eri, shls, consumer_id, data).
+// eri holds the ncomp components of the shells, sized by ao_loc[nbas+1].
+// Screened quartets (intor returns 0) are not digested.  consumer_id is in
+// [0, nconsumer), each consumer calls digest sequentially.
+int CINTpipeline_eri(CACHE_SIZE_T (*intor)(), int ncomp, int ncenter,
+                     int *shls, size_t ntask, int *ao_loc, CINTOpt *opt,
+                     void (*digest)(double *eri, int *shls, int consumer_id, void *data),
+                     void *data, int nproducer, int nconsumer,
+                     int *atm, int natm, int *bas, int nbas, double *env);
+
+// Memory-bounded cache of the shell quartets of intor for repeated Fock
+// builds.  intor is an ERI of one component with the 8-fold permutation
+// symmetry (int2e_sph, int2e_cart).  At most max_memory bytes are used, the
+// quartets of the highest estimated cost per byte are kept.  opt is the
+// int2e optimizer of the basis, the cache is cleared when its geometry is
+// updated.  Returns NULL for other intors or if opt does not have the basis
+// data.
+CINTEriCache *CINTeri_cache_create(CACHE_SIZE_T (*intor)(), int *ao_loc,
+                                   size_t max_memory, CINTOpt *opt);
+// Evaluates the quartet shls as intor, from the cache if it was stored.
+// Can be called by multiple threads.
+CACHE_SIZE_T CINTeri_cache_eval(CINTEriCache *ec, double *out, int *dims, int *shls,
+                                int *atm, int natm, int *bas, int nbas, double *env,
+                                double *cache);
+void CINTeri_cache_del(CINTEriCache *ec);
+
+// Out-of-core storage of shell blocks.  CINTeri_file_write evaluates intor
+// (ncomp components, 2 to 4 centers) for the shells shls[ntask,4] with
+// CINTpipeline_eri and writes the blocks to path, indexed by the task.  The
+// elements below cutoff are dropped and a block is stored in float32 if
+// the rounding errors are below cutoff.  cutoff = 0 stores the integrals
+// exactly.  Returns 0 on success.
+int CINTeri_file_write(const char *path, CACHE_SIZE_T (*intor)(), int ncomp, int ncenter,
+                       int *shls, size_t ntask, int *ao_loc, double cutoff, CINTOpt *opt,
+                       int *atm, int natm, int *bas, int nbas, double *env);
+// Maps a file of CINTeri_file_write.  The readers can be called by multiple
+// threads.  Returns NULL on failure.
+CINTEriFile *CINTeri_file_open(const char *path);
+void CINTeri_file_close(CINTEriFile *f);
+size_t CINTeri_file_ntask(CINTEriFile *f);
+int *CINTeri_file_shls(CINTEriFile *f, size_t task);
+// The block of task in place in the mapping (aligned to 64 bytes) if it is
+// stored as doubles, otherwise NULL and the block needs CINTeri_file_read.
+double *CINTeri_file_block(CINTEriFile *f, size_t task);
+// Copies the block of task to out.  Returns 0 if the block is zero.
+size_t CINTeri_file_read(double *out, CINTEriFile *f, size_t task);
+
+
+void CINTinit_2e_optimizer(CINTOpt **opt, int *atm, int natm,
+                           int *bas, int nbas, double *env);
+void CINTinit_optimizer(CINTOpt **opt, int *atm, int natm,
+                        int *bas, int nbas, double *env);
+void CINTdel_2e_optimizer(CINTOpt **opt);
+void CINTdel_optimizer(CINTOpt **opt);
+void CINTdel_index_xyz_cache(void);
+void CINTOpt_update_geometry(CINTOpt *opt, int *atm, int natm,
+                             int *bas, int nbas, double *env);
+
+
+int cint2e_cart(double *opijkl, int *shls,
+                int *atm, int natm, int *bas, int nbas, double *env,
+                CINTOpt *opt);
+void cint2e_cart_optimizer(CINTOpt **opt, int *atm, int natm,
+                           int *bas, int nbas, double *env);
+int cint2e_sph(double *opijkl, int *shls,
+               int *atm, int natm, int *bas, int nbas, double *env,
+               CINTOpt *opt);
+void cint2e_sph_optimizer(CINTOpt **opt, int *atm, int natm,
+                          int *bas, int nbas, double *env);
+int cint2e(double *opijkl, int *shls,
+           int *atm, int natm, int *bas, int nbas, double *env,
+           CINTOpt *opt);
+void cint2e_optimizer(CINTOpt **opt, int *atm, int natm,
+                      int *bas, int nbas, double *env);
+
+#ifndef __cplusplus
+#include <complex.h>
+
+void CINTc2s_ket_spinor_sf1(double complex *gspa, double complex *gspb, double *gcart,
+                            int lds, int ldc, int nctr, int l, int kappa);
+void CINTc2s_iket_spinor_sf1(double complex *gspa, double complex *gspb, double *gcart,
+                             int lds, int ldc, int nctr, int l, int kappa);
+void CINTc2s_ket_spinor_si1(double complex *gspa, double complex *gspb, double *gcart,
+                            int lds, int ldc, int nctr, int l, int kappa);
+void CINTc2s_iket_spinor_si1(double complex *gspa, double complex *gspb, double *gcart,
+                             int lds, int ldc, int nctr, int l, int kappa);
+#endif
@@ -1108,3 +1108,21 @@ extern CINTIntegralFunction int1e_grids_spvsp_cart;
 extern CINTIntegralFunction int1e_grids_spvsp_sph;
 extern CINTIntegralFunction int1e_grids_spvsp_spinor;
 
+
+/* (ij|kl) and (NABLA i j|R12 |k l), components [1, 3] */
+extern CINTOptimizerFunction int2e_tower1_optimizer;
+extern CINTIntegralFunction int2e_tower1_cart;
+extern CINTIntegralFunction int2e_tower1_sph;
+extern CINTIntegralFunction int2e_tower1_spinor;
+
+/* (ij|kl) and NABLA_i derivatives up to second order, components [1, 3, 9] */
+extern CINTOptimizerFunction int2e_tower2_optimizer;
+extern CINTIntegralFunction int2e_tower2_cart;
+extern CINTIntegralFunction int2e_tower2_sph;
+extern CINTIntegralFunction int2e_tower2_spinor;
+
+/* (ij|kl) and NABLA_i derivatives up to third order, components [1, 3, 9, 27] */
+extern CINTOptimizerFunction int2e_tower3_optimizer;
+extern CINTIntegralFunction int2e_tower3_cart;
+extern CINTIntegralFunction int2e_tower3_sph;
+extern CINTIntegralFunction int2e_tower3_spinor;
@@ -232,9 +232,9 @@
 (defun dump-declare-dri-for-rc (fout i-ops symb)
   (when (intersection '(rc xc yc zc) i-ops)
     (format fout "double dr~a[3];~%" symb)
-    (format fout "dr~a[0] = envs->r~a[0] - envs->env[PTR_COMMON_ORIG+0];~%" symb symb)
-    (format fout "dr~a[1] = envs->r~a[1] - envs->env[PTR_COMMON_ORIG+1];~%" symb symb)
-    (format fout "dr~a[2] = envs->r~a[2] - envs->env[PTR_COMMON_ORIG+2];~%" symb symb))
+    (format fout "dr~a[0] = envs->r~a[0] - envs->params[PTR_COMMON_ORIG+0];~%" symb symb)
+    (format fout "dr~a[1] = envs->r~a[1] - envs->params[PTR_COMMON_ORIG+1];~%" symb symb)
+    (format fout "dr~a[2] = envs->r~a[2] - envs->params[PTR_COMMON_ORIG+2];~%" symb symb))
   (when (intersection '(ri xi yi zi) i-ops)
     (if (intersection '(rc xc yc zc) i-ops)
       (error "Cannot declare dri because rc and ri coexist"))
@@ -976,9 +976,9 @@ double *RESTRICT g1 = g0 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2 + envs->g_size * 3 * SIMDD;
 double dri[3];
-dri[0] = envs->ri[0] - envs->env[PTR_COMMON_ORIG+0];
-dri[1] = envs->ri[1] - envs->env[PTR_COMMON_ORIG+1];
-dri[2] = envs->ri[2] - envs->env[PTR_COMMON_ORIG+2];
+dri[0] = envs->ri[0] - envs->params[PTR_COMMON_ORIG+0];
+dri[1] = envs->ri[1] - envs->params[PTR_COMMON_ORIG+1];
+dri[2] = envs->ri[2] - envs->params[PTR_COMMON_ORIG+2];
 G2E_D_L(g1, g0, envs->i_l+1, envs->j_l+0, envs->k_l+0, envs->l_l+0);
 G2E_RCI(g2, g0, envs->i_l+0, envs->j_l, envs->k_l, envs->l_l);
 G2E_RCI(g3, g1, envs->i_l+0, envs->j_l, envs->k_l, envs->l_l);
@@ -1159,9 +1159,9 @@ double *RESTRICT g1 = g0 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2 + envs->g_size * 3 * SIMDD;
 double dri[3];
-dri[0] = envs->ri[0] - envs->env[PTR_COMMON_ORIG+0];
-dri[1] = envs->ri[1] - envs->env[PTR_COMMON_ORIG+1];
-dri[2] = envs->ri[2] - envs->env[PTR_COMMON_ORIG+2];
+dri[0] = envs->ri[0] - envs->params[PTR_COMMON_ORIG+0];
+dri[1] = envs->ri[1] - envs->params[PTR_COMMON_ORIG+1];
+dri[2] = envs->ri[2] - envs->params[PTR_COMMON_ORIG+2];
 G2E_D_L_SIMD1(g1, g0, envs->i_l+1, envs->j_l+0, envs->k_l+0, envs->l_l+0);
 G2E_RCI_SIMD1(g2, g0, envs->i_l+0, envs->j_l, envs->k_l, envs->l_l);
 G2E_RCI_SIMD1(g3, g1, envs->i_l+0, envs->j_l, envs->k_l, envs->l_l);
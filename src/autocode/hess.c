@@ -826,9 +826,9 @@ double *RESTRICT g5 = g4  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g6 = g5  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g7 = g6  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[27];
 G1E_RCJ(g1, g0, envs->i_l+2, envs->j_l+0, 0);
@@ -943,9 +943,9 @@ double *RESTRICT g5 = g4  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g6 = g5  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g7 = g6  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[27];
 G1E_D_J(g1, g0, envs->i_l+1, envs->j_l+0, 0);
@@ -242,9 +242,9 @@ double *RESTRICT g1 = g0  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[9];
 G1E_D_J(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -388,9 +388,9 @@ double *RESTRICT g1 = g0 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2 + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[9];
 G2E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, 0, 0);
@@ -1026,9 +1026,9 @@ DECLARE_GOUT;
 double *RESTRICT g0 = g;
 double *RESTRICT g1 = g0  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[3];
 G1E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -1083,9 +1083,9 @@ double *RESTRICT g1 = g0  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[9];
 G1E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -1146,9 +1146,9 @@ DECLARE_GOUT;
 double *RESTRICT g0 = g;
 double *RESTRICT g1 = g0  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[3];
 G1E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -1205,9 +1205,9 @@ double *RESTRICT g1 = g0  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[9];
 G1E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -1282,9 +1282,9 @@ double *RESTRICT g13 = g12  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g14 = g13  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g15 = g14  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[81];
 G1E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -1431,9 +1431,9 @@ double *RESTRICT g1 = g0  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[9];
 G1E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -1508,9 +1508,9 @@ double *RESTRICT g5 = g4  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g6 = g5  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g7 = g6  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[27];
 G1E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -1633,9 +1633,9 @@ double *RESTRICT g13 = g12  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g14 = g13  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g15 = g14  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[81];
 G1E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -2675,9 +2675,9 @@ double *RESTRICT g1 = g0  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[9];
 G1E_D_J(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -2752,9 +2752,9 @@ double *RESTRICT g5 = g4  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g6 = g5  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g7 = g6  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[27];
 G1E_D_J(g1, g0, envs->i_l+0, envs->j_l+0, 0);
@@ -2869,9 +2869,9 @@ double *RESTRICT g5 = g4  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g6 = g5  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g7 = g6  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[27];
 G1E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, 0);
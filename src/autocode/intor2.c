@@ -1057,9 +1057,9 @@ double *RESTRICT g1 = g0 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2 + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 G2E_RCJ(g1, g0, envs->i_l+0, envs->j_l+0, envs->k_l, envs->l_l);
 G2E_D_J(g2, g0, envs->i_l+0, envs->j_l+1, envs->k_l, envs->l_l);
 G2E_D_I(g3, g0, envs->i_l+0, envs->j_l+1, envs->k_l, envs->l_l);
@@ -1203,9 +1203,9 @@ double *RESTRICT g1 = g0 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2 + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 G2E_RCJ_SIMD1(g1, g0, envs->i_l+0, envs->j_l+0, envs->k_l, envs->l_l);
 G2E_D_J_SIMD1(g2, g0, envs->i_l+0, envs->j_l+1, envs->k_l, envs->l_l);
 G2E_D_I_SIMD1(g3, g0, envs->i_l+0, envs->j_l+1, envs->k_l, envs->l_l);
@@ -1961,9 +1961,9 @@ double *RESTRICT g1 = g0  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[9];
 for (n = 0; n < nfc*SIMDD; n++) { gout1[n] = 0; }
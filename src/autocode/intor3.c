@@ -691,9 +691,9 @@ double *RESTRICT g5 = g4  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g6 = g5  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g7 = g6  + envs->g_size * 3 * SIMDD;
 double drj[3];
-drj[0] = envs->rj[0] - envs->env[PTR_COMMON_ORIG+0];
-drj[1] = envs->rj[1] - envs->env[PTR_COMMON_ORIG+1];
-drj[2] = envs->rj[2] - envs->env[PTR_COMMON_ORIG+2];
+drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[27];
 G1E_D_J(g1, g0, envs->i_l+1, envs->j_l+0, 0);
@@ -997,9 +997,9 @@ double *RESTRICT g1 = g0 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2 + envs->g_size * 3 * SIMDD;
 double dri[3];
-dri[0] = envs->ri[0] - envs->env[PTR_COMMON_ORIG+0];
-dri[1] = envs->ri[1] - envs->env[PTR_COMMON_ORIG+1];
-dri[2] = envs->ri[2] - envs->env[PTR_COMMON_ORIG+2];
+dri[0] = envs->ri[0] - envs->params[PTR_COMMON_ORIG+0];
+dri[1] = envs->ri[1] - envs->params[PTR_COMMON_ORIG+1];
+dri[2] = envs->ri[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[9];
 G2E_D_J(g1, g0, envs->i_l+1, envs->j_l+0, 0, 0);
@@ -1105,9 +1105,9 @@ double *RESTRICT g1 = g0  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2  + envs->g_size * 3 * SIMDD;
 double dri[3];
-dri[0] = envs->ri[0] - envs->env[PTR_COMMON_ORIG+0];
-dri[1] = envs->ri[1] - envs->env[PTR_COMMON_ORIG+1];
-dri[2] = envs->ri[2] - envs->env[PTR_COMMON_ORIG+2];
+dri[0] = envs->ri[0] - envs->params[PTR_COMMON_ORIG+0];
+dri[1] = envs->ri[1] - envs->params[PTR_COMMON_ORIG+1];
+dri[2] = envs->ri[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[9];
 G1E_D_J(g1, g0, envs->i_l+1, envs->j_l+0, 0);
@@ -1184,9 +1184,9 @@ double *RESTRICT g1 = g0  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1  + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2  + envs->g_size * 3 * SIMDD;
 double dri[3];
-dri[0] = envs->ri[0] - envs->env[PTR_COMMON_ORIG+0];
-dri[1] = envs->ri[1] - envs->env[PTR_COMMON_ORIG+1];
-dri[2] = envs->ri[2] - envs->env[PTR_COMMON_ORIG+2];
+dri[0] = envs->ri[0] - envs->params[PTR_COMMON_ORIG+0];
+dri[1] = envs->ri[1] - envs->params[PTR_COMMON_ORIG+1];
+dri[2] = envs->ri[2] - envs->params[PTR_COMMON_ORIG+2];
 __MD r1;
 __MD rs[9];
 for (n = 0; n < nfc*SIMDD; n++) { gout1[n] = 0; }
@@ -1104,9 +1104,9 @@ double *RESTRICT g1 = g0 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2 + envs->g_size * 3 * SIMDD;
 double dri[3];
-dri[0] = envs->ri[0] - envs->env[PTR_COMMON_ORIG+0];
-dri[1] = envs->ri[1] - envs->env[PTR_COMMON_ORIG+1];
-dri[2] = envs->ri[2] - envs->env[PTR_COMMON_ORIG+2];
+dri[0] = envs->ri[0] - envs->params[PTR_COMMON_ORIG+0];
+dri[1] = envs->ri[1] - envs->params[PTR_COMMON_ORIG+1];
+dri[2] = envs->ri[2] - envs->params[PTR_COMMON_ORIG+2];
 G2E_D_J(g1, g0, envs->i_l+1, envs->j_l+0, envs->k_l, envs->l_l);
 G2E_RCI(g2, g0, envs->i_l+0, envs->j_l, envs->k_l, envs->l_l);
 G2E_RCI(g3, g1, envs->i_l+0, envs->j_l, envs->k_l, envs->l_l);
@@ -1251,9 +1251,9 @@ double *RESTRICT g1 = g0 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g2 = g1 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g3 = g2 + envs->g_size * 3 * SIMDD;
 double dri[3];
-dri[0] = envs->ri[0] - envs->env[PTR_COMMON_ORIG+0];
-dri[1] = envs->ri[1] - envs->env[PTR_COMMON_ORIG+1];
-dri[2] = envs->ri[2] - envs->env[PTR_COMMON_ORIG+2];
+dri[0] = envs->ri[0] - envs->params[PTR_COMMON_ORIG+0];
+dri[1] = envs->ri[1] - envs->params[PTR_COMMON_ORIG+1];
+dri[2] = envs->ri[2] - envs->params[PTR_COMMON_ORIG+2];
 G2E_D_J_SIMD1(g1, g0, envs->i_l+1, envs->j_l+0, envs->k_l, envs->l_l);
 G2E_RCI_SIMD1(g2, g0, envs->i_l+0, envs->j_l, envs->k_l, envs->l_l);
 G2E_RCI_SIMD1(g3, g1, envs->i_l+0, envs->j_l, envs->k_l, envs->l_l);
@@ -1349,9 +1349,9 @@ double *RESTRICT g13 = g12 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g14 = g13 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g15 = g14 + envs->g_size * 3 * SIMDD;
 double dri[3];
-dri[0] = envs->ri[0] - envs->env[PTR_COMMON_ORIG+0];
-dri[1] = envs->ri[1] - envs->env[PTR_COMMON_ORIG+1];
-dri[2] = envs->ri[2] - envs->env[PTR_COMMON_ORIG+2];
+dri[0] = envs->ri[0] - envs->params[PTR_COMMON_ORIG+0];
+dri[1] = envs->ri[1] - envs->params[PTR_COMMON_ORIG+1];
+dri[2] = envs->ri[2] - envs->params[PTR_COMMON_ORIG+2];
 G2E_D_L(g1, g0, envs->i_l+1, envs->j_l+1, envs->k_l+1, envs->l_l+0);
 G2E_D_K(g2, g0, envs->i_l+1, envs->j_l+1, envs->k_l+0, envs->l_l);
 G2E_D_K(g3, g1, envs->i_l+1, envs->j_l+1, envs->k_l+0, envs->l_l);
@@ -1528,9 +1528,9 @@ double *RESTRICT g13 = g12 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g14 = g13 + envs->g_size * 3 * SIMDD;
 double *RESTRICT g15 = g14 + envs->g_size * 3 * SIMDD;
 double dri[3];
-dri[0] = envs->ri[0] - envs->env[PTR_COMMON_ORIG+0];
-dri[1] = envs->ri[1] - envs->env[PTR_COMMON_ORIG+1];
-dri[2] = envs->ri[2] - envs->env[PTR_COMMON_ORIG+2];
+dri[0] = envs->ri[0] - envs->params[PTR_COMMON_ORIG+0];
+dri[1] = envs->ri[1] - envs->params[PTR_COMMON_ORIG+1];
+dri[2] = envs->ri[2] - envs->params[PTR_COMMON_ORIG+2];
 G2E_D_L_SIMD1(g1, g0, envs->i_l+1, envs->j_l+1, envs->k_l+1, envs->l_l+0);
 G2E_D_K_SIMD1(g2, g0, envs->i_l+1, envs->j_l+1, envs->k_l+0, envs->l_l);
 G2E_D_K_SIMD1(g3, g1, envs->i_l+1, envs->j_l+1, envs->k_l+0, envs->l_l);
@@ -3596,21 +3596,149 @@ static struct cart2sp_t g_c2s[] = {
         {g_trans_cart2sph+14960, NULL, NULL, NULL, NULL},
 };
 
-// transform integrals from cartesian to spheric
-static double *a_bra_cart2spheric(double *gsph, int nket, double *gcart, int l)
+/*
+ * Sparse form of g_c2s[l].cart2sph for l >= 5.  Only about 1/6 of the
+ * dense coefficients are nonzero, so the generic transformations walk the
+ * nonzero list of each spherical component instead of calling dgemm.  The
+ * lists are generated from the dense tables on first use and shared by
+ * all threads.  The dense tables are used if the lists cannot be allocated.
+ */
+#define C2S_SPARSE_LMIN 5
+struct cart2sph_sparse_t {
+        // nonzeros of the spherical component m of angular momentum l are
+        // idx[k], coeff[k] for k in loc[l][m] .. loc[l][m+1]
+        int loc[LMAX1][ANG_MAX*2+2];
+        int *idx;
+        double *coeff;
+};
+static struct cart2sph_sparse_t *_c2s_sparse = NULL;
+
+static struct cart2sph_sparse_t *_c2s_sparse_tables()
 {
-        int nf = _len_cart[l];
-        int nd = l * 2 + 1;
-        CINTdgemm_TN(nd, nket, nf, g_c2s[l].cart2sph, gcart, gsph);
-        return gsph;
+        struct cart2sph_sparse_t *tab = __atomic_load_n(&_c2s_sparse, __ATOMIC_ACQUIRE);
+        if (tab != NULL) {
+                return tab;
+        }
+
+        int l, m, n, nf, nd, nnz;
+        double *c2s;
+        nnz = 0;
+        for (l = C2S_SPARSE_LMIN; l <= ANG_MAX; l++) {
+                nf = _len_cart[l];
+                nd = l * 2 + 1;
+                c2s = g_c2s[l].cart2sph;
+                for (n = 0; n < nd * nf; n++) {
+                        nnz += (c2s[n] != 0);
+                }
+        }
+        tab = malloc(sizeof(struct cart2sph_sparse_t)
+                     + sizeof(double) * nnz + sizeof(int) * nnz);
+        if (tab == NULL) {
+                // the callers fall back to the dense transformations
+                return NULL;
+        }
+        tab->coeff = (double *)(tab + 1);
+        tab->idx = (int *)(tab->coeff + nnz);
+        nnz = 0;
+        for (l = C2S_SPARSE_LMIN; l <= ANG_MAX; l++) {
+                nf = _len_cart[l];
+                nd = l * 2 + 1;
+                c2s = g_c2s[l].cart2sph;
+                for (m = 0; m < nd; m++) {
+                        tab->loc[l][m] = nnz;
+                        for (n = 0; n < nf; n++) {
+                                if (c2s[m*nf+n] != 0) {
+                                        tab->idx[nnz] = n;
+                                        tab->coeff[nnz] = c2s[m*nf+n];
+                                        nnz++;
+                                }
+                        }
+                }
+                tab->loc[l][nd] = nnz;
+        }
+
+        struct cart2sph_sparse_t *expected = NULL;
+        if (!__atomic_compare_exchange_n(&_c2s_sparse, &expected, tab, 0,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                free(tab);
+                tab = expected;
+        }
+        return tab;
 }
 
 static double *a_ket_cart2spheric(double *gsph, double *gcart,
                                   int lds, int nbra, int l)
+{
+        struct cart2sph_sparse_t *tab = _c2s_sparse_tables();
+        if (tab == NULL) {
+                int nf = _len_cart[l];
+                CINTdgemm_NN1(nbra, l * 2 + 1, nf, gcart, g_c2s[l].cart2sph, gsph, lds);
+                return gsph;
+        }
+        const int *loc = tab->loc[l];
+        const int *idx = tab->idx;
+        const double *coeff = tab->coeff;
+        int nd = l * 2 + 1;
+        int i, m, k;
+        __MD r0, r1;
+        double s;
+        for (m = 0; m < nd; m++) {
+                for (i = 0; i + SIMDD*2 <= nbra; i += SIMDD*2) {
+                        r0 = MM_SET1(0.);
+                        r1 = MM_SET1(0.);
+                        for (k = loc[m]; k < loc[m+1]; k++) {
+                                r0 += MM_SET1(coeff[k]) * MM_LOADU(gcart+idx[k]*nbra+i);
+                                r1 += MM_SET1(coeff[k]) * MM_LOADU(gcart+idx[k]*nbra+i+SIMDD);
+                        }
+                        MM_STOREU(gsph+m*lds+i, r0);
+                        MM_STOREU(gsph+m*lds+i+SIMDD, r1);
+                }
+                if (i + SIMDD <= nbra) {
+                        r0 = MM_SET1(0.);
+                        for (k = loc[m]; k < loc[m+1]; k++) {
+                                r0 += MM_SET1(coeff[k]) * MM_LOADU(gcart+idx[k]*nbra+i);
+                        }
+                        MM_STOREU(gsph+m*lds+i, r0);
+                        i += SIMDD;
+                }
+                for (; i < nbra; i++) {
+                        s = 0;
+                        for (k = loc[m]; k < loc[m+1]; k++) {
+                                s += coeff[k] * gcart[idx[k]*nbra+i];
+                        }
+                        gsph[m*lds+i] = s;
+                }
+        }
+        return gsph;
+}
+
+/*
+ * Blocks of kets are transposed so that the sparse transformation runs
+ * vectorized along nket, the same way as the ket transformation.
+ */
+static double *a_bra_cart2spheric(double *gsph, int nket, double *gcart, int l)
 {
         int nf = _len_cart[l];
         int nd = l * 2 + 1;
-        CINTdgemm_NN1(nbra, nd, nf, gcart, g_c2s[l].cart2sph, gsph, lds);
+        int i0, i, n, nb;
+        ALIGNMM double gcartT[CART_MAX*SIMDD*2];
+        ALIGNMM double gsphT[(ANG_MAX*2+1)*SIMDD*2];
+        if (_c2s_sparse_tables() == NULL) {
+                CINTdgemm_TN(nd, nket, nf, g_c2s[l].cart2sph, gcart, gsph);
+                return gsph;
+        }
+        for (i0 = 0; i0 < nket; i0 += SIMDD*2) {
+                nb = MIN(nket - i0, SIMDD*2);
+                for (i = 0; i < nb; i++) {
+                for (n = 0; n < nf; n++) {
+                        gcartT[n*nb+i] = gcart[(i0+i)*nf+n];
+                } }
+                a_ket_cart2spheric(gsphT, gcartT, nb, nb, l);
+                for (i = 0; i < nb; i++) {
+                for (n = 0; n < nd; n++) {
+                        gsph[(i0+i)*nd+n] = gsphT[n*nb+i];
+                } }
+        }
         return gsph;
 }
 
@@ -5549,6 +5677,87 @@ void c2s_sph_2e1(double *out, double *gctr, int *dims,
         } } } }
 }
 
+/*
+ * Transform the primitive integrals of nlanes quartets, each in the layout
+ * of gctr of c2s_sph_2e1, to the spherical components (i,k,l,j) before
+ * contraction.  cache needs nfikl*dj*2 doubles.
+ */
+void c2s_sph_2e1_prim(double *gsph, double *gcart, int nlanes,
+                      CINTEnvVars *envs, double *cache)
+{
+        int i_l = envs->i_l;
+        int j_l = envs->j_l;
+        int k_l = envs->k_l;
+        int l_l = envs->l_l;
+        int di = i_l * 2 + 1;
+        int dj = j_l * 2 + 1;
+        int dk = k_l * 2 + 1;
+        int dl = l_l * 2 + 1;
+        int nfi = envs->nfi;
+        int nfk = envs->nfk;
+        int nfl = envs->nfl;
+        int nfik = nfi * nfk;
+        int nfikl = nfik * nfl;
+        int dlj = dl * dj;
+        int nf = nfikl * envs->nfj;
+        int nd = di * dk * dlj;
+        double *buf1 = cache;
+        double *buf2 = buf1 + nfikl * dj;
+        double *tmp1;
+        int n, k;
+
+        for (n = 0; n < nlanes; n++) {
+                tmp1 = (c2s_ket_sph[j_l])(buf1, gcart, nfikl, nfikl, j_l);
+                tmp1 = sph2e_inner(buf2, tmp1, l_l, nfik, dj, nfik*dl, nfikl);
+                tmp1 = sph2e_inner(tmp1 == buf1 ? buf2 : buf1,
+                                   tmp1, k_l, nfi, dlj, nfi*dk, nfik);
+                tmp1 = (c2s_bra_sph[i_l])(gsph, dk*dlj, tmp1, i_l);
+                if (tmp1 != gsph) {
+                        for (k = 0; k < nd; k++) {
+                                gsph[k] = tmp1[k];
+                        }
+                }
+                gsph += nd;
+                gcart += nf;
+        }
+}
+
+/*
+ * The counterpart of c2s_sph_2e1 for gctr which was transformed by
+ * c2s_sph_2e1_prim before contraction.
+ */
+void c2s_sph_2e1_copy(double *out, double *gctr, int *dims,
+                      CINTEnvVars *envs, double *cache)
+{
+        int i_ctr = envs->x_ctr[0];
+        int j_ctr = envs->x_ctr[1];
+        int k_ctr = envs->x_ctr[2];
+        int l_ctr = envs->x_ctr[3];
+        int di = envs->i_l * 2 + 1;
+        int dj = envs->j_l * 2 + 1;
+        int dk = envs->k_l * 2 + 1;
+        int dl = envs->l_l * 2 + 1;
+        int ni = dims[0];
+        int nj = dims[1];
+        int nk = dims[2];
+        int nl = dims[3];
+        int nd = di * dj * dk * dl;
+        int ofj = ni * dj;
+        int ofk = ni * nj * dk;
+        int ofl = ni * nj * nk * dl;
+        int ic, jc, kc, lc;
+        double *pout;
+
+        for (lc = 0; lc < l_ctr; lc++) {
+        for (kc = 0; kc < k_ctr; kc++) {
+        for (jc = 0; jc < j_ctr; jc++) {
+        for (ic = 0; ic < i_ctr; ic++) {
+                pout = out + ofl * lc + ofk * kc + ofj * jc + di * ic;
+                dcopy_iklj(pout, gctr, ni, nj, nk, nl, di, dj, dk, dl);
+                gctr += nd;
+        } } } }
+}
+
 
 /*
  * 2e integrals, cartesian to spin-free spinor for electron 1.
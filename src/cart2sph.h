@@ -23,6 +23,8 @@
 
 void c2s_sph_1e(double *opij, double *gctr, int *dims, CINTEnvVars *envs, double *cache);
 void c2s_sph_2e1(double *fijkl, double *gctr, int *dims, CINTEnvVars *envs, double *cache);
+void c2s_sph_2e1_prim(double *gsph, double *gcart, int nlanes, CINTEnvVars *envs, double *cache);
+void c2s_sph_2e1_copy(double *fijkl, double *gctr, int *dims, CINTEnvVars *envs, double *cache);
 void c2s_sph_2e2();
 
 void c2s_cart_1e(double *opij, double *gctr, int *dims, CINTEnvVars *envs, double *cache);
@@ -250,7 +250,8 @@ int CINT1e_loop(double *out, CINTEnvVars *envs, CINTOpt *opt, double *cache)
         double expcutoff = envs->expcutoff;
         double aij, eij, cceij;
         double rij[4];
-        int *idx = opt->index_xyz_array[envs->i_l*LMAX1+envs->j_l];
+        int *idx = CINTOpt_index_xyz(opt, envs->i_l*LMAX1+envs->j_l,
+                                     &CINTg2c_index_xyz, envs);
         int *non0ctr[2] = {opt->non0ctr[i_sh], opt->non0ctr[j_sh]};
         int *non0idx[2] = {opt->sortedidx[i_sh], opt->sortedidx[j_sh]};
 
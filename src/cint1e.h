@@ -35,3 +35,10 @@ CACHE_SIZE_T CINT1e_grids_spinor_drv(double complex *out, int *dims, CINTEnvVars
                              double *cache, void (*f_c2s)());
 CACHE_SIZE_T CINT1e_grids_drv(double *out, int *dims, CINTEnvVars *envs,
                       double *cache, void (*f_c2s)());
+
+// multipole expansion of shell pairs, see cint_multipole.c
+double CINTpair_extent_bounds(double *center, double *size, double *spread,
+                              double eps, int *shls,
+                              int *atm, int natm, int *bas, int nbas, double *env);
+void CINTmultipole_potential(double *phi, int order, double *center,
+                             double *coords, double *q, int n);
@@ -5,11 +5,13 @@
  */
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <math.h>
 #include "cint_bas.h"
 #include "optimizer.h"
 #include "g1e.h"
 #include "g1e_grids.h"
+#include "cint1e.h"
 #include "misc.h"
 #include "cart2sph.h"
 #include "c2f.h"
@@ -237,7 +239,7 @@ size_t int1e_grids_cache_size(CINTEnvVars *envs)
         size_t leni = len0 * x_ctr[0];
         size_t lenj = leni * x_ctr[1];
         size_t cache_size = MAX(nc*n_comp + leng + len0 + leni + lenj + pdata_size +
-                                GRID_BLKSIZE*MAX(n_comp, nroots+6),
+                                GRID_BLKSIZE*MAX(n_comp, nroots+7),
                                 nc*n_comp + GRID_BLKSIZE * nf*8*OF_CMPLX);
         return cache_size + SIMDD*8;
 }
@@ -382,3 +384,570 @@ CACHE_SIZE_T int1e_grids_spinor(double complex *out, int *dims, int *shls, int *
 
 ALL_CINT(int1e_grids)
 
+
+/*
+ * Electronic part of the electrostatic potential
+ *      V(r_g) = sum_ij D_ij <i|1/|r-r_g||j>
+ * The density matrix is transformed to the Cartesian functions of each
+ * shell pair (ish >= jsh, D_ij + D_ji) once, and contracted with the
+ * Cartesian integrals of a chunk of grids right after CINT1e_grids_loop.
+ * Neither the spherical transformation nor the (ngrids,nao,nao) integrals
+ * are needed.  The expcutoff of each shell pair is reduced by the largest
+ * density element of the pair.
+ */
+#define ESP_GRIDS_CHUNK         (GRID_BLKSIZE * 4)
+
+// c2s[l][m,n] cart-to-spherical coefficients, obtained from the
+// transformation of the unit matrix
+static void _c2s_coeff(double **c2s, int lmax, double *buf)
+{
+        int nflmax = (lmax+1)*(lmax+2)/2;
+        double *unit = buf;
+        double *pc2s;
+        int l, n, nfl;
+        buf += nflmax * nflmax;
+        for (l = 0; l <= lmax; l++) {
+                nfl = (l+1)*(l+2)/2;
+                for (n = 0; n < nfl*nfl; n++) {
+                        unit[n] = 0;
+                }
+                for (n = 0; n < nfl; n++) {
+                        unit[n*nfl+n] = 1;
+                }
+                pc2s = CINTc2s_ket_sph(buf, nfl, unit, l);
+                if (pc2s != buf) {
+                        for (n = 0; n < (l*2+1)*nfl; n++) {
+                                buf[n] = pc2s[n];
+                        }
+                }
+                c2s[l] = buf;
+                buf += (l*2+1) * nfl;
+        }
+}
+
+/*
+ * Cartesian density of the shell pair, stored as dmc[jc,ic,fj,fi] to match
+ * the layout of gctr
+ */
+static double _dm_cart_pair(double *dmc, double *dm, int nao, int *ao_loc,
+                            int ish, int jsh, int *bas, double **c2s, double *buf)
+{
+        int li = bas(ANG_OF, ish);
+        int lj = bas(ANG_OF, jsh);
+        int i_ctr = bas(NCTR_OF, ish);
+        int j_ctr = bas(NCTR_OF, jsh);
+        int nfi = (li+1)*(li+2)/2;
+        int nfj = (lj+1)*(lj+2)/2;
+        int di = (ao_loc[ish+1] - ao_loc[ish]) / i_ctr;
+        int dj = (ao_loc[jsh+1] - ao_loc[jsh]) / j_ctr;
+        int is_cart = (c2s == NULL);
+        int ic, jc, a, b, fi, fj, n;
+        size_t i, j;
+        double s, dmax = 0;
+        double *pdm;
+
+        for (jc = 0; jc < j_ctr; jc++) {
+        for (ic = 0; ic < i_ctr; ic++) {
+                // buf[b,a] = D_ab (+ D_ba)
+                for (b = 0; b < dj; b++) {
+                for (a = 0; a < di; a++) {
+                        i = ao_loc[ish] + ic * di + a;
+                        j = ao_loc[jsh] + jc * dj + b;
+                        buf[b*di+a] = dm[i*nao+j];
+                        if (ish != jsh) {
+                                buf[b*di+a] += dm[j*nao+i];
+                        }
+                } }
+                pdm = dmc + (jc * i_ctr + ic) * nfi * nfj;
+                if (is_cart) {
+                        for (n = 0; n < nfi * nfj; n++) {
+                                pdm[n] = buf[n];
+                        }
+                } else {
+                        for (fj = 0; fj < nfj; fj++) {
+                        for (fi = 0; fi < nfi; fi++) {
+                                s = 0;
+                                for (b = 0; b < dj; b++) {
+                                for (a = 0; a < di; a++) {
+                                        s += c2s[li][a*nfi+fi] * buf[b*di+a]
+                                           * c2s[lj][b*nfj+fj];
+                                } }
+                                pdm[fj*nfi+fi] = s;
+                        } }
+                }
+                for (n = 0; n < nfi * nfj; n++) {
+                        dmax = MAX(dmax, fabs(pdm[n]));
+                }
+        } }
+        return dmax;
+}
+
+static void _esp_grids(double *out_v, double *dm, double *grids, int ngrids,
+                       int *atm, int natm, int *bas, int nbas, double *env,
+                       int is_cart)
+{
+        int ng[] = {0, 0, 0, 0, 0, 1, 0, 1};
+        int *ao_loc = malloc(sizeof(int) * (nbas+1));
+        if (is_cart) {
+                CINTshells_cart_loc(ao_loc, bas, nbas);
+        } else {
+                CINTshells_spheric_loc(ao_loc, bas, nbas);
+        }
+        int nao = ao_loc[nbas];
+        size_t npair = (size_t)nbas * (nbas + 1) / 2;
+        size_t *dm_loc = malloc(sizeof(size_t) * (npair + 1));
+        double *dm_max = malloc(sizeof(double) * npair);
+        int ish, jsh, lmax = 0, dmax = 0;
+        size_t ij, ncart = 0;
+        for (ish = 0; ish < nbas; ish++) {
+                lmax = MAX(lmax, bas(ANG_OF, ish));
+                dmax = MAX(dmax, ao_loc[ish+1] - ao_loc[ish]);
+        }
+        for (ish = 0, ij = 0; ish < nbas; ish++) {
+        for (jsh = 0; jsh <= ish; jsh++, ij++) {
+                dm_loc[ij] = ncart;
+                ncart += (size_t)CINTcgto_cart(ish, bas) * CINTcgto_cart(jsh, bas);
+        } }
+        dm_loc[npair] = ncart;
+
+        int nflmax = (lmax+1)*(lmax+2)/2;
+        double *dmc = malloc(sizeof(double) * ncart);
+        double *buf = malloc(sizeof(double) * (dmax * dmax + nflmax * nflmax
+                                               + (lmax+1) * (lmax*2+1) * nflmax));
+        double *c2s[LMAX1];
+        if (!is_cart) {
+                _c2s_coeff(c2s, lmax, buf + dmax * dmax);
+        }
+        for (ish = 0, ij = 0; ish < nbas; ish++) {
+        for (jsh = 0; jsh <= ish; jsh++, ij++) {
+                dm_max[ij] = _dm_cart_pair(dmc+dm_loc[ij], dm, nao, ao_loc, ish, jsh,
+                                           bas, is_cart ? NULL : c2s, buf);
+        } }
+
+        CINTEnvVars envs;
+        int shls[4] = {0, 0, 0, ESP_GRIDS_CHUNK};
+        size_t cache_size = 0;
+        for (ish = 0; ish < nbas; ish++) {
+        for (jsh = 0; jsh <= ish; jsh++) {
+                shls[0] = ish;
+                shls[1] = jsh;
+                CINTinit_int1e_grids_EnvVars(&envs, ng, shls, atm, natm, bas, nbas, env);
+                cache_size = MAX(cache_size, int1e_grids_cache_size(&envs));
+        } }
+
+#pragma omp parallel private(envs, ish, jsh, ij)
+{
+        int shls[4] = {0, 0, 0, ESP_GRIDS_CHUNK};
+        int g0, bg, bgrids, ig, n, nfc;
+        double expcutoff, d;
+        int gb, nb;
+        double *cache, *gctr, *pdm, *pgctr, *v;
+        double *gridbuf = malloc(sizeof(double) * ESP_GRIDS_CHUNK * 3);
+        double *stack = malloc(sizeof(double) * cache_size);
+#pragma omp for schedule(dynamic, 1)
+        for (g0 = 0; g0 < ngrids; g0 += ESP_GRIDS_CHUNK) {
+                bg = MIN(ngrids - g0, ESP_GRIDS_CHUNK);
+                bgrids = ALIGN_UP(bg, SIMDD);
+                // CINT1e_grids_loop reads the grids up to the SIMDD boundary
+                for (ig = 0; ig < bgrids*3; ig++) {
+                        gridbuf[ig] = grids[g0*3 + MIN(ig, bg*3-3+ig%3)];
+                }
+                v = out_v + g0;
+                for (ig = 0; ig < bg; ig++) {
+                        v[ig] = 0;
+                }
+                for (ish = 0, ij = 0; ish < nbas; ish++) {
+                for (jsh = 0; jsh <= ish; jsh++, ij++) {
+                        if (dm_max[ij] == 0) {
+                                continue;
+                        }
+                        shls[0] = ish;
+                        shls[1] = jsh;
+                        CINTinit_int1e_grids_EnvVars(&envs, ng, shls, atm, natm,
+                                                     bas, nbas, env);
+                        expcutoff = envs.expcutoff + log(dm_max[ij]);
+                        if (expcutoff <= 0) {
+                                continue;
+                        }
+                        envs.expcutoff = expcutoff;
+                        envs.f_gout = &CINTgout1e_grids;
+                        envs.ngrids = bg;
+                        envs.grids = gridbuf;
+                        cache = stack;
+                        nfc = envs.nf * envs.x_ctr[0] * envs.x_ctr[1];
+                        MALLOC_ALIGNED_DOUBLE_INSTACK(gctr, bgrids * nfc);
+                        if (!CINT1e_grids_loop(gctr, &envs, cache)) {
+                                continue;
+                        }
+                        pdm = dmc + dm_loc[ij];
+                        // gctr[block,jc,ic,fj,fi,grid]
+                        for (gb = 0; gb < bg; gb += GRID_BLKSIZE) {
+                                nb = MIN(bgrids - gb, GRID_BLKSIZE);
+                                for (n = 0; n < nfc; n++) {
+                                        d = pdm[n];
+                                        pgctr = gctr + gb * nfc + n * nb;
+#pragma GCC ivdep
+                                        for (ig = 0; ig < MIN(nb, bg - gb); ig++) {
+                                                v[gb+ig] += d * pgctr[ig];
+                                        }
+                                }
+                        }
+                } }
+        }
+        free(stack);
+        free(gridbuf);
+}
+        free(buf);
+        free(dmc);
+        free(dm_max);
+        free(dm_loc);
+        free(ao_loc);
+}
+
+void CINTesp_grids_sph(double *out_v, double *dm, double *grids, int ngrids,
+                       int *atm, int natm, int *bas, int nbas, double *env)
+{
+        _esp_grids(out_v, dm, grids, ngrids, atm, natm, bas, nbas, env, 0);
+}
+
+void CINTesp_grids_cart(double *out_v, double *dm, double *grids, int ngrids,
+                        int *atm, int natm, int *bas, int nbas, double *env)
+{
+        _esp_grids(out_v, dm, grids, ngrids, atm, natm, bas, nbas, env, 1);
+}
+
+/*
+ * Potential matrix of point charges
+ *      out[j,i] = sum_g q_g <i|1/|r-R_g||j>
+ * The charges are sorted along a Morton curve and grouped in blocks of
+ * GRID_BLKSIZE.  For each shell pair, a charge block is
+ *  - far if it does not overlap the pair density and the multipole
+ *    expansion of the pair (see CINTquartet_is_far) with the total
+ *    absolute charge of the block converges at some order <= 8.  The
+ *    charges are then contracted with D^a 1/R at the pair center and the
+ *    moments of the pair.
+ *  - near otherwise.  The exact integrals of the block are evaluated with
+ *    CINT1e_grids_loop, vectorized over the charges, and contracted with
+ *    the charges before the cart-to-spherical transformation.
+ * Gaussian charges exp(-zeta r^2) are used if env[PTR_RINV_ZETA] > 0.
+ */
+#define QMMM_EPS        1e-13
+
+typedef struct {
+        double center[3];
+        double radius;
+        double qabs;
+} CINTChargeBlock;
+
+static uint64_t _morton_spread(uint64_t x)
+{
+        x &= 0x1fffff;
+        x = (x | x << 32) & 0x1f00000000ffffULL;
+        x = (x | x << 16) & 0x1f0000ff0000ffULL;
+        x = (x | x << 8)  & 0x100f00f00f00f00fULL;
+        x = (x | x << 4)  & 0x10c30c30c30c30c3ULL;
+        x = (x | x << 2)  & 0x1249249249249249ULL;
+        return x;
+}
+
+typedef struct {
+        uint64_t key;
+        int id;
+} _MortonKey;
+
+static int _morton_cmp(const void *a, const void *b)
+{
+        uint64_t ka = ((_MortonKey *)a)->key;
+        uint64_t kb = ((_MortonKey *)b)->key;
+        return (ka > kb) - (ka < kb);
+}
+
+/*
+ * Sort the charges along a Morton curve.  The sorted coordinates and
+ * charges are padded to a multiple of SIMDD with zero charges.
+ */
+static int _sort_charges(double *sorted_coords, double *sorted_q, CINTChargeBlock *blocks,
+                         double *coords, double *charges, int ncharges)
+{
+        _MortonKey *keys = malloc(sizeof(_MortonKey) * ncharges);
+        int nsorted = ALIGN_UP(ncharges, SIMDD);
+        double lo[3], hi[3], scale;
+        int g, ig, ib, nb, d;
+        for (d = 0; d < 3; d++) {
+                lo[d] = coords[d];
+                hi[d] = coords[d];
+        }
+        for (g = 1; g < ncharges; g++) {
+                for (d = 0; d < 3; d++) {
+                        lo[d] = MIN(lo[d], coords[g*3+d]);
+                        hi[d] = MAX(hi[d], coords[g*3+d]);
+                }
+        }
+        scale = MAX(MAX(hi[0]-lo[0], hi[1]-lo[1]), hi[2]-lo[2]);
+        scale = (scale > 0) ? 2097151. / scale : 0;
+        for (g = 0; g < ncharges; g++) {
+                keys[g].id = g;
+                keys[g].key = _morton_spread((uint64_t)((coords[g*3+0]-lo[0]) * scale))
+                           | _morton_spread((uint64_t)((coords[g*3+1]-lo[1]) * scale)) << 1
+                           | _morton_spread((uint64_t)((coords[g*3+2]-lo[2]) * scale)) << 2;
+        }
+        qsort(keys, ncharges, sizeof(_MortonKey), _morton_cmp);
+
+        for (g = 0; g < ncharges; g++) {
+                sorted_coords[g*3+0] = coords[keys[g].id*3+0];
+                sorted_coords[g*3+1] = coords[keys[g].id*3+1];
+                sorted_coords[g*3+2] = coords[keys[g].id*3+2];
+                sorted_q[g] = charges[keys[g].id];
+        }
+        for (; g < nsorted; g++) {
+                sorted_coords[g*3+0] = sorted_coords[g*3-3];
+                sorted_coords[g*3+1] = sorted_coords[g*3-2];
+                sorted_coords[g*3+2] = sorted_coords[g*3-1];
+                sorted_q[g] = 0;
+        }
+        free(keys);
+
+        nb = (ncharges + GRID_BLKSIZE - 1) / GRID_BLKSIZE;
+        for (ib = 0; ib < nb; ib++) {
+                int g0 = ib * GRID_BLKSIZE;
+                int g1 = MIN(g0 + GRID_BLKSIZE, ncharges);
+                double *c = blocks[ib].center;
+                double r2 = 0;
+                c[0] = 0;
+                c[1] = 0;
+                c[2] = 0;
+                blocks[ib].qabs = 0;
+                for (ig = g0; ig < g1; ig++) {
+                        c[0] += sorted_coords[ig*3+0];
+                        c[1] += sorted_coords[ig*3+1];
+                        c[2] += sorted_coords[ig*3+2];
+                        blocks[ib].qabs += fabs(sorted_q[ig]);
+                }
+                c[0] /= g1 - g0;
+                c[1] /= g1 - g0;
+                c[2] /= g1 - g0;
+                for (ig = g0; ig < g1; ig++) {
+                        r2 = MAX(r2, CINTsquare_dist(c, sorted_coords+ig*3));
+                }
+                blocks[ib].radius = sqrt(r2);
+        }
+        return nb;
+}
+
+/*
+ * The lowest order of the expansion for the charge block, -1 if the block
+ * is near.  rw is the radius beyond which Gaussian charges are points.
+ */
+static int _charge_block_order(CINTChargeBlock *block, double *center,
+                               double extent, double size, double spread,
+                               double rw, int lij)
+{
+        double r = sqrt(CINTsquare_dist(center, block->center)) - block->radius;
+        int order;
+        if (r <= extent + rw || r <= spread) {
+                return -1;
+        }
+        double err = size * block->qabs / (r - spread);
+        double ratio = spread / r;
+        for (order = lij; order <= MULTIPOLE_ORDER_MAX; order++) {
+                if (err * pow(ratio, order + 1 - lij) < QMMM_EPS) {
+                        return order;
+                }
+        }
+        return -1;
+}
+
+static void _point_charges_fock(double *out, double *coords, double *charges, int ncharges,
+                                int *atm, int natm, int *bas, int nbas, double *env,
+                                int is_cart)
+{
+        int (*f_cgto)() = is_cart ? &CINTcgto_cart : &CINTcgto_spheric;
+        CACHE_SIZE_T (*f_moments)() = is_cart ? &int1e_pair_multipole_cart
+                                              : &int1e_pair_multipole_sph;
+        void (*f_c2s)() = is_cart ? &c2s_cart_1e : &c2s_sph_1e;
+        int *ao_loc = malloc(sizeof(int) * (nbas+1));
+        if (is_cart) {
+                CINTshells_cart_loc(ao_loc, bas, nbas);
+        } else {
+                CINTshells_spheric_loc(ao_loc, bas, nbas);
+        }
+        int nao = ao_loc[nbas];
+        int ish, jsh;
+        for (ish = 0; ish < nao*nao; ish++) {
+                out[ish] = 0;
+        }
+        if (ncharges <= 0) {
+                free(ao_loc);
+                return;
+        }
+
+        int nblk = (ncharges + GRID_BLKSIZE - 1) / GRID_BLKSIZE;
+        double *sorted_coords = malloc(sizeof(double) * ALIGN_UP(ncharges, SIMDD) * 4);
+        double *sorted_q = sorted_coords + ALIGN_UP(ncharges, SIMDD) * 3;
+        CINTChargeBlock *blocks = malloc(sizeof(CINTChargeBlock) * nblk);
+        _sort_charges(sorted_coords, sorted_q, blocks, coords, charges, ncharges);
+
+        // The multipole expansion is only valid for the bare Coulomb operator
+        int with_far = (env[PTR_RANGE_OMEGA] == 0);
+        double zeta = env[PTR_RINV_ZETA];
+        double rw = (zeta > 0) ? sqrt(-log(QMMM_EPS) / zeta) : 0;
+        int ng[] = {0, 0, 0, 0, 0, 1, 0, 1};
+        int shls[4] = {0, 0, 0, GRID_BLKSIZE};
+        int dmax = 0;
+        int dcart_max = 0;
+        size_t cache_size = 0;
+        CINTEnvVars envs;
+        for (ish = 0; ish < nbas; ish++) {
+                dmax = MAX(dmax, (*f_cgto)(ish, bas));
+                dcart_max = MAX(dcart_max, CINTcgto_cart(ish, bas));
+                for (jsh = 0; jsh <= ish; jsh++) {
+                        shls[0] = ish;
+                        shls[1] = jsh;
+                        CINTinit_int1e_grids_EnvVars(&envs, ng, shls, atm, natm,
+                                                     bas, nbas, env);
+                        cache_size = MAX(cache_size, int1e_grids_cache_size(&envs));
+                        cache_size = MAX(cache_size, (size_t)
+                                         (*f_moments)(NULL, NULL, MULTIPOLE_ORDER_MAX, NULL,
+                                                      shls, atm, natm, bas, nbas, env,
+                                                      NULL, NULL));
+                }
+        }
+        size_t npair = (size_t)nbas * (nbas + 1) / 2;
+        int nmom_max = CINTpair_multipole_ncomp(MULTIPOLE_ORDER_MAX);
+
+#pragma omp parallel private(envs, ish, jsh)
+{
+        int shls[4] = {0, 0, 0, GRID_BLKSIZE};
+        int *order = malloc(sizeof(int) * nblk);
+        double *mom = malloc(sizeof(double) * (nmom_max * (dmax * dmax + 1)));
+        double *phi = mom + nmom_max * dmax * dmax;
+        double *cart = malloc(sizeof(double) * dcart_max * dcart_max);
+        double *stack = malloc(sizeof(double) * cache_size);
+        double *cache, *gctr, *q;
+        double center[3], extent, size, spread, s;
+        int ib, nb, bgrids, n, ig, nfc, di, dj, dij, a, i, j, nmom;
+        int li, lj, order_max, has_near;
+        size_t ij;
+#pragma omp for schedule(dynamic, 1)
+        for (ij = 0; ij < npair; ij++) {
+                ish = (int)((sqrt(8.*ij + 1) - 1) * .5);
+                if ((size_t)ish * (ish + 1) / 2 > ij) {
+                        ish--;
+                } else if ((size_t)(ish + 1) * (ish + 2) / 2 <= ij) {
+                        ish++;
+                }
+                jsh = ij - (size_t)ish * (ish + 1) / 2;
+                shls[0] = ish;
+                shls[1] = jsh;
+                li = bas(ANG_OF, ish);
+                lj = bas(ANG_OF, jsh);
+                di = (*f_cgto)(ish, bas);
+                dj = (*f_cgto)(jsh, bas);
+                dij = di * dj;
+                order_max = -1;
+                if (with_far) {
+                        extent = CINTpair_extent_bounds(center, &size, &spread,
+                                                        QMMM_EPS, shls,
+                                                        atm, natm, bas, nbas, env);
+                        for (ib = 0; ib < nblk; ib++) {
+                                order[ib] = _charge_block_order(blocks+ib, center, extent,
+                                                                size, spread, rw, li+lj);
+                                order_max = MAX(order_max, order[ib]);
+                        }
+                } else {
+                        for (ib = 0; ib < nblk; ib++) {
+                                order[ib] = -1;
+                        }
+                }
+
+                CINTinit_int1e_grids_EnvVars(&envs, ng, shls, atm, natm, bas, nbas, env);
+                envs.f_gout = &CINTgout1e_grids;
+                nfc = envs.nf * envs.x_ctr[0] * envs.x_ctr[1];
+                for (n = 0; n < nfc; n++) {
+                        cart[n] = 0;
+                }
+                has_near = 0;
+                for (ib = 0; ib < nblk; ib++) {
+                        if (order[ib] >= 0) {
+                                continue;
+                        }
+                        nb = MIN(ncharges - ib * GRID_BLKSIZE, GRID_BLKSIZE);
+                        bgrids = ALIGN_UP(nb, SIMDD);
+                        envs.ngrids = nb;
+                        envs.grids = sorted_coords + ib * GRID_BLKSIZE * 3;
+                        cache = stack;
+                        MALLOC_ALIGNED_DOUBLE_INSTACK(gctr, bgrids * nfc);
+                        if (!CINT1e_grids_loop(gctr, &envs, cache)) {
+                                continue;
+                        }
+                        has_near = 1;
+                        q = sorted_q + ib * GRID_BLKSIZE;
+                        for (n = 0; n < nfc; n++) {
+                                s = 0;
+#pragma GCC ivdep
+                                for (ig = 0; ig < bgrids; ig++) {
+                                        s += q[ig] * gctr[n*bgrids+ig];
+                                }
+                                cart[n] += s;
+                        }
+                }
+
+                // cart -> out[j,i] of the shell pair, in the order of CINT1e_drv
+                int dims[2] = {nao, nao};
+                double *pout = out + (size_t)ao_loc[jsh] * nao + ao_loc[ish];
+                if (has_near) {
+                        (*f_c2s)(pout, cart, dims, &envs, stack);
+                }
+                if (order_max >= 0) {
+                        nmom = CINTpair_multipole_ncomp(order_max);
+                        for (a = 0; a < nmom; a++) {
+                                phi[a] = 0;
+                        }
+                        for (ib = 0; ib < nblk; ib++) {
+                                if (order[ib] < 0) {
+                                        continue;
+                                }
+                                nb = MIN(ncharges - ib * GRID_BLKSIZE, GRID_BLKSIZE);
+                                CINTmultipole_potential(phi, order[ib], center,
+                                                        sorted_coords + ib * GRID_BLKSIZE * 3,
+                                                        sorted_q + ib * GRID_BLKSIZE, nb);
+                        }
+                        (*f_moments)(mom, NULL, order_max, center, shls,
+                                     atm, natm, bas, nbas, env, NULL, stack);
+                        for (j = 0; j < dj; j++) {
+                        for (i = 0; i < di; i++) {
+                                s = 0;
+                                for (a = 0; a < nmom; a++) {
+                                        s += mom[a*dij+j*di+i] * phi[a];
+                                }
+                                pout[j*nao+i] += s;
+                        } }
+                }
+                if (ish != jsh) {
+                        for (j = 0; j < dj; j++) {
+                        for (i = 0; i < di; i++) {
+                                out[(size_t)(ao_loc[ish]+i)*nao+ao_loc[jsh]+j] = pout[j*nao+i];
+                        } }
+                }
+        }
+        free(stack);
+        free(cart);
+        free(mom);
+        free(order);
+}
+        free(blocks);
+        free(sorted_coords);
+        free(ao_loc);
+}
+
+void CINTpoint_charges_fock_sph(double *out, double *coords, double *charges, int ncharges,
+                                int *atm, int natm, int *bas, int nbas, double *env)
+{
+        _point_charges_fock(out, coords, charges, ncharges, atm, natm, bas, nbas, env, 0);
+}
+
+void CINTpoint_charges_fock_cart(double *out, double *coords, double *charges, int ncharges,
+                                 int *atm, int natm, int *bas, int nbas, double *env)
+{
+        _point_charges_fock(out, coords, charges, ncharges, atm, natm, bas, nbas, env, 1);
+}
@@ -0,0 +1,341 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Several 1e operators evaluated in one pass over the primitive pairs.
+ *
+ * The operators share the pair exponents, prefactors, the primitive loop
+ * and the contraction of CINT1e_loop.  Overlap, kinetic and multipole
+ * operators are all derived from one set of CINTg1e_ovlp tables (built
+ * with lj_ceil raised to the highest requirement).  The nuclear attraction
+ * adds the Rys g arrays on top of them.
+ */
+
+#include <stdlib.h>
+#include "cint_bas.h"
+#include "misc.h"
+#include "g1e.h"
+#include "optimizer.h"
+#include "cint1e.h"
+#include "cart2sph.h"
+
+typedef struct {
+        CINTEnvVars envs;
+        int nops;
+        int ops[INT1E_MULTI_NOPS_MAX];
+} CINTMulti1eEnvVars;
+
+static int _op_ncomp(int op)
+{
+        switch (op) {
+        case INT1E_MULTI_R: return 3;
+        case INT1E_MULTI_RR: return 9;
+        default: return 1;
+        }
+}
+
+static int _multi_ng(int *ng, int *ops, int nops)
+{
+        int i;
+        int ncomp = 0;
+        ng[IINC] = 0;
+        ng[JINC] = 0;
+        ng[KINC] = 0;
+        ng[LINC] = 0;
+        // g0 + 2 for kinetic + 2 for multipoles + 1 for nuclear attraction
+        ng[GSHIFT] = 3;
+        ng[POS_E1] = 1;
+        ng[SLOT_RYS_ROOTS] = 1;
+        for (i = 0; i < nops; i++) {
+                switch (ops[i]) {
+                case INT1E_MULTI_OVLP:
+                        break;
+                case INT1E_MULTI_KIN:
+                case INT1E_MULTI_RR:
+                        ng[JINC] = 2;
+                        break;
+                case INT1E_MULTI_NUC:
+                        ng[SLOT_RYS_ROOTS] = 0;
+                        break;
+                case INT1E_MULTI_R:
+                        ng[JINC] = MAX(ng[JINC], 1);
+                        break;
+                default:
+                        return -1;
+                }
+                ncomp += _op_ncomp(ops[i]);
+        }
+        ng[TENSOR] = ncomp;
+        return ncomp;
+}
+
+static void gout1e_multi(double *gout, double *g, int *idx, CINTEnvVars *envs, int count)
+{
+        CINTMulti1eEnvVars *menvs = (CINTMulti1eEnvVars *)envs;
+        int nf = envs->nf;
+        int ncomp = envs->ncomp_tensor;
+        int nfc = nf * ncomp;
+        int nrys_roots = envs->nrys_roots;
+        int i_l = envs->i_l;
+        int j_l = envs->j_l;
+        int has_kin = 0;
+        int has_nuc = 0;
+        int has_r = 0;
+        int has_rr = 0;
+        int ix, iy, iz, i, n, iop, ia, comp;
+        DECLARE_GOUT;
+        __MD r1;
+        double *RESTRICT g0 = g;
+        double *RESTRICT gkin1 = g0    + envs->g_size * 3 * SIMDD;
+        double *RESTRICT gkin2 = gkin1 + envs->g_size * 3 * SIMDD;
+        double *RESTRICT gr1   = gkin2 + envs->g_size * 3 * SIMDD;
+        double *RESTRICT gr2   = gr1   + envs->g_size * 3 * SIMDD;
+        double *RESTRICT gnuc  = gr2   + envs->g_size * 3 * SIMDD;
+        // gout is allocated with twice the size of the output in CINT1e_loop
+        double *RESTRICT gv    = gout  + nfc * SIMDD;
+        double *gr[3];
+        double *gx, *gy, *gz;
+
+        for (iop = 0; iop < menvs->nops; iop++) {
+                switch (menvs->ops[iop]) {
+                case INT1E_MULTI_KIN: has_kin = 1; break;
+                case INT1E_MULTI_NUC: has_nuc = 1; break;
+                case INT1E_MULTI_R  : has_r   = 1; break;
+                case INT1E_MULTI_RR : has_rr  = 1; break;
+                }
+        }
+
+        if (has_nuc) {
+                for (n = 0; n < nf*SIMDD; n++) {
+                        gv[n] = 0;
+                }
+                for (ia = 0; ia < envs->natm; ia++) {
+                        CINTg1e_nuc(gnuc, envs, count, ia);
+                        for (n = 0; n < nf; n++) {
+                                gx = gnuc + idx[n*3+0] * SIMDD;
+                                gy = gnuc + idx[n*3+1] * SIMDD;
+                                gz = gnuc + idx[n*3+2] * SIMDD;
+                                r1 = MM_LOAD(gv+n*SIMDD);
+                                for (i = 0; i < nrys_roots; i++) {
+                                        r1 += MM_LOAD(gx+i*SIMDD) * MM_LOAD(gy+i*SIMDD)
+                                            * MM_LOAD(gz+i*SIMDD);
+                                }
+                                MM_STORE(gv+n*SIMDD, r1);
+                        }
+                }
+        }
+
+        CINTg1e_ovlp(g0, envs, count);
+        if (has_kin) {
+                G1E_D_J(gkin1, g0, i_l, j_l+1, 0);
+                G1E_D_J(gkin2, gkin1, i_l, j_l, 0);
+        }
+        if (has_r || has_rr) {
+                double drj[3];
+                drj[0] = envs->rj[0] - envs->params[PTR_COMMON_ORIG+0];
+                drj[1] = envs->rj[1] - envs->params[PTR_COMMON_ORIG+1];
+                drj[2] = envs->rj[2] - envs->params[PTR_COMMON_ORIG+2];
+                G1E_RCJ(gr1, g0, i_l, j_l+has_rr, 0);
+                if (has_rr) {
+                        G1E_RCJ(gr2, gr1, i_l, j_l, 0);
+                }
+        }
+        gr[0] = g0;
+        gr[1] = gr1;
+        gr[2] = gr2;
+
+        for (n = 0; n < nf; n++) {
+                ix = idx[0+n*3] * SIMDD;
+                iy = idx[1+n*3] * SIMDD;
+                iz = idx[2+n*3] * SIMDD;
+                comp = 0;
+                for (iop = 0; iop < menvs->nops; iop++) {
+                        switch (menvs->ops[iop]) {
+                        case INT1E_MULTI_OVLP:
+                                r1 = MM_LOAD(g0+ix) * MM_LOAD(g0+iy) * MM_LOAD(g0+iz);
+                                GOUT_SCATTER(gout, n*ncomp+comp, r1);
+                                comp++;
+                                break;
+                        case INT1E_MULTI_KIN:
+                                r1 = MM_LOAD(gkin2+ix) * MM_LOAD(g0   +iy) * MM_LOAD(g0   +iz)
+                                   + MM_LOAD(g0   +ix) * MM_LOAD(gkin2+iy) * MM_LOAD(g0   +iz)
+                                   + MM_LOAD(g0   +ix) * MM_LOAD(g0   +iy) * MM_LOAD(gkin2+iz);
+                                r1 = MM_SET1(-.5) * r1;
+                                GOUT_SCATTER(gout, n*ncomp+comp, r1);
+                                comp++;
+                                break;
+                        case INT1E_MULTI_NUC:
+                                r1 = MM_LOAD(gv+n*SIMDD);
+                                GOUT_SCATTER(gout, n*ncomp+comp, r1);
+                                comp++;
+                                break;
+                        case INT1E_MULTI_R:
+                                r1 = MM_LOAD(gr1+ix) * MM_LOAD(g0 +iy) * MM_LOAD(g0 +iz);
+                                GOUT_SCATTER(gout, n*ncomp+comp+0, r1);
+                                r1 = MM_LOAD(g0 +ix) * MM_LOAD(gr1+iy) * MM_LOAD(g0 +iz);
+                                GOUT_SCATTER(gout, n*ncomp+comp+1, r1);
+                                r1 = MM_LOAD(g0 +ix) * MM_LOAD(g0 +iy) * MM_LOAD(gr1+iz);
+                                GOUT_SCATTER(gout, n*ncomp+comp+2, r1);
+                                comp += 3;
+                                break;
+                        case INT1E_MULTI_RR:
+                                for (i = 0; i < 9; i++) {
+                                        int nx = (i/3 == 0) + (i%3 == 0);
+                                        int ny = (i/3 == 1) + (i%3 == 1);
+                                        int nz = (i/3 == 2) + (i%3 == 2);
+                                        r1 = MM_LOAD(gr[nx]+ix) * MM_LOAD(gr[ny]+iy)
+                                           * MM_LOAD(gr[nz]+iz);
+                                        GOUT_SCATTER(gout, n*ncomp+comp+i, r1);
+                                }
+                                comp += 9;
+                                break;
+                        }
+                }
+        }
+}
+
+static int _init_multi_envs(CINTMulti1eEnvVars *menvs, int *ops, int nops, int *shls,
+                            int *atm, int natm, int *bas, int nbas, double *env)
+{
+        int ng[8];
+        int i;
+        if (nops <= 0 || nops > INT1E_MULTI_NOPS_MAX ||
+            _multi_ng(ng, ops, nops) < 0) {
+                return -1;
+        }
+        CINTinit_int1e_EnvVars(&menvs->envs, ng, shls, atm, natm, bas, nbas, env);
+        menvs->envs.f_gout = &gout1e_multi;
+        menvs->nops = nops;
+        for (i = 0; i < nops; i++) {
+                menvs->ops[i] = ops[i];
+        }
+        return 0;
+}
+
+int int1e_multi_ncomp(int *ops, int nops)
+{
+        int ng[8];
+        if (nops <= 0 || nops > INT1E_MULTI_NOPS_MAX) {
+                return -1;
+        }
+        return _multi_ng(ng, ops, nops);
+}
+
+void int1e_multi_optimizer(CINTOpt **opt, int *ops, int nops,
+                           int *atm, int natm, int *bas, int nbas, double *env)
+{
+        int ng[8];
+        if (nops <= 0 || nops > INT1E_MULTI_NOPS_MAX ||
+            _multi_ng(ng, ops, nops) < 0) {
+                *opt = NULL;
+                return;
+        }
+        CINTall_1e_optimizer(opt, ng, atm, natm, bas, nbas, env);
+}
+
+CACHE_SIZE_T int1e_multi_cart(double *out, int *dims, int *ops, int nops, int *shls,
+                              int *atm, int natm, int *bas, int nbas, double *env,
+                              CINTOpt *opt, double *cache)
+{
+        CINTMulti1eEnvVars menvs;
+        if (_init_multi_envs(&menvs, ops, nops, shls, atm, natm, bas, nbas, env)) {
+                return 0;
+        }
+        return CINT1e_drv(out, dims, &menvs.envs, opt, cache, &c2s_cart_1e);
+}
+
+CACHE_SIZE_T int1e_multi_sph(double *out, int *dims, int *ops, int nops, int *shls,
+                             int *atm, int natm, int *bas, int nbas, double *env,
+                             CINTOpt *opt, double *cache)
+{
+        CINTMulti1eEnvVars menvs;
+        if (_init_multi_envs(&menvs, ops, nops, shls, atm, natm, bas, nbas, env)) {
+                return 0;
+        }
+        return CINT1e_drv(out, dims, &menvs.envs, opt, cache, &c2s_sph_1e);
+}
+
+static void _multi_fill(double *out, int *ops, int nops, int *shls_slice,
+                        int *atm, int natm, int *bas, int nbas, double *env,
+                        int is_cart)
+{
+        CACHE_SIZE_T (*intor)(double *out, int *dims, int *ops, int nops, int *shls,
+                              int *atm, int natm, int *bas, int nbas, double *env,
+                              CINTOpt *opt, double *cache);
+        intor = is_cart ? &int1e_multi_cart : &int1e_multi_sph;
+        int ish0 = shls_slice[0];
+        int ish1 = shls_slice[1];
+        int jsh0 = shls_slice[2];
+        int jsh1 = shls_slice[3];
+        int ncomp = int1e_multi_ncomp(ops, nops);
+        if (ncomp <= 0) {
+                return;
+        }
+        int *ao_loc = malloc(sizeof(int) * (nbas+1));
+        if (is_cart) {
+                CINTshells_cart_loc(ao_loc, bas, nbas);
+        } else {
+                CINTshells_spheric_loc(ao_loc, bas, nbas);
+        }
+        int naoi = ao_loc[ish1] - ao_loc[ish0];
+        int naoj = ao_loc[jsh1] - ao_loc[jsh0];
+        int dims[2] = {naoi, naoj};
+
+        CINTOpt *opt = NULL;
+        int1e_multi_optimizer(&opt, ops, nops, atm, natm, bas, nbas, env);
+
+        int ish, jsh;
+        int shls[2];
+        CACHE_SIZE_T cache_size = 0;
+        for (ish = ish0; ish < ish1; ish++) {
+        for (jsh = jsh0; jsh < jsh1; jsh++) {
+                shls[0] = ish;
+                shls[1] = jsh;
+                cache_size = MAX(cache_size, (*intor)(NULL, NULL, ops, nops, shls,
+                                                      atm, natm, bas, nbas, env,
+                                                      NULL, NULL));
+        } }
+        double *cache = _mm_malloc(sizeof(double) * cache_size, sizeof(double)*SIMDD);
+
+        for (jsh = jsh0; jsh < jsh1; jsh++) {
+        for (ish = ish0; ish < ish1; ish++) {
+                shls[0] = ish;
+                shls[1] = jsh;
+                (*intor)(out + (size_t)(ao_loc[jsh]-ao_loc[jsh0]) * naoi
+                         + ao_loc[ish] - ao_loc[ish0], dims, ops, nops, shls,
+                         atm, natm, bas, nbas, env, opt, cache);
+        } }
+
+        _mm_free(cache);
+        CINTdel_optimizer(&opt);
+        free(ao_loc);
+}
+
+void int1e_multi_fill_cart(double *out, int *ops, int nops, int *shls_slice,
+                           int *atm, int natm, int *bas, int nbas, double *env)
+{
+        _multi_fill(out, ops, nops, shls_slice, atm, natm, bas, nbas, env, 1);
+}
+
+void int1e_multi_fill_sph(double *out, int *ops, int nops, int *shls_slice,
+                          int *atm, int natm, int *bas, int nbas, double *env)
+{
+        _multi_fill(out, ops, nops, shls_slice, atm, natm, bas, nbas, env, 0);
+}
@@ -306,7 +306,8 @@ int CINT2c2e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty)
         double common_factor = envs->common_factor;
 
         CINTOpt *opt = envs->opt;
-        int *idx = opt->index_xyz_array[envs->i_l*LMAX1+envs->k_l];
+        int *idx = CINTOpt_index_xyz(opt, envs->i_l*LMAX1+envs->k_l,
+                                     &CINTg2c_index_xyz, envs);
         int *non0ctr[2] = {opt->non0ctr[i_sh], opt->non0ctr[k_sh]};
         int *non0idx[2] = {opt->sortedidx[i_sh], opt->sortedidx[k_sh]};
 
@@ -344,6 +345,7 @@ void CINTinit_int2c2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->atm = atm;
         envs->bas = bas;
         envs->env = env;
+        envs->params = CINTparams_env(env);
         envs->shls = shls;
 
         int i_sh = shls[0];
@@ -367,10 +369,10 @@ void CINTinit_int2c2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
 
         envs->common_factor = (M_PI*M_PI*M_PI)*2/SQRTPI
                 * CINTcommon_fac_sp(envs->i_l) * CINTcommon_fac_sp(envs->k_l);
-        if (env[PTR_EXPCUTOFF] == 0) {
+        if (envs->params[PTR_EXPCUTOFF] == 0) {
                 envs->expcutoff = EXPCUTOFF;
         } else {
-                envs->expcutoff = MAX(MIN_EXPCUTOFF, env[PTR_EXPCUTOFF]);
+                envs->expcutoff = MAX(MIN_EXPCUTOFF, envs->params[PTR_EXPCUTOFF]);
         }
 
         envs->gbits = ng[GSHIFT];
@@ -384,7 +386,7 @@ void CINTinit_int2c2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->ll_ceil = 0;
         int rys_order =(envs->li_ceil + envs->lk_ceil)/2 + 1;
         int nrys_roots = rys_order;
-        double omega = env[PTR_RANGE_OMEGA];
+        double omega = envs->params[PTR_RANGE_OMEGA];
         if (omega < 0 && rys_order <= 3) {
                 nrys_roots *= 2;
         }
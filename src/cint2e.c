@@ -79,13 +79,64 @@
         } \
         *csymb##empty = 0;
 
+/*
+ * For i_ctr == 1, the consecutive lanes of a batch which are contracted to
+ * the same target are summed in one pass, instead of one CINTiprim_to_ctr
+ * call per lane.  Returns the number of queue entries consumed.
+ */
+static int _iprim_to_ctr_lanes(double **gp2c, double **gprim, int *iprim,
+                               void (**fp2c)(), int *shltyp, int nentries,
+                               double *ci, size_t nf)
+{
+        double *RESTRICT gc = gp2c[0];
+        double *RESTRICT gp = gprim[0];
+        double c[SIMDD];
+        int nlanes, l;
+        size_t n;
+
+        c[0] = ci[iprim[0]];
+        for (nlanes = 1; nlanes < MIN(nentries, SIMDD); nlanes++) {
+                if (shltyp[nlanes] != SHLTYPi || gp2c[nlanes] != gc ||
+                    gprim[nlanes] != gp + nf * nlanes ||
+                    fp2c[nlanes] != CINTiprim_to_ctr_1) {
+                        break;
+                }
+                c[nlanes] = ci[iprim[nlanes]];
+        }
+
+        if (fp2c[0] == CINTiprim_to_ctr_0) {
+                for (n = 0; n < nf; n++) {
+                        gc[n] = 0;
+                }
+        }
+        n = 0;
+        for (; n + SIMDD <= nf; n += SIMDD) {
+                __MD r0 = MM_LOADU(gc+n);
+                for (l = 0; l < nlanes; l++) {
+                        r0 = MM_FMA(MM_SET1(c[l]), MM_LOADU(gp+l*nf+n), r0);
+                }
+                MM_STOREU(gc+n, r0);
+        }
+        for (; n < nf; n++) {
+                for (l = 0; l < nlanes; l++) {
+                        gc[n] += c[l] * gp[l*nf+n];
+                }
+        }
+        return nlanes;
+}
+
 #define POP_PRIM2CTR \
         for (i = 0; i < np2c; i++) { \
                 it = shltyp[i]; \
                 im = iprim[i]; \
-                (*(fp2c[i]))(gp2c[i], gprim[i], coeff[it]+im, \
-                             ngp[it], x_prim[it], x_ctr[it], \
-                             non0ctr[it][im], non0idx[it]+im*x_ctr[it]); \
+                if (it == SHLTYPi && x_ctr[0] == 1) { \
+                        i += _iprim_to_ctr_lanes(gp2c+i, gprim+i, iprim+i, fp2c+i, \
+                                                 shltyp+i, np2c-i, coeff[0], ngp[0]) - 1; \
+                } else { \
+                        (*(fp2c[i]))(gp2c[i], gprim[i], coeff[it]+im, \
+                                     ngp[it], x_prim[it], x_ctr[it], \
+                                     non0ctr[it][im], non0idx[it]+im*x_ctr[it]); \
+                } \
                 empty_overall = 0; \
         } \
         cum = 0; \
@@ -111,18 +162,32 @@
         cum = 0; \
         np2c = 0;
 
+/*
+ * With envs->c2s_prim, the primitive integrals in gout are transformed to
+ * spherical in gprim0 before they are queued for contraction
+ */
+#define C2S_PRIM(nlanes) \
+        if (gprim0 != gout) { \
+                c2s_sph_2e1_prim(gprim0, gout, nlanes, envs, c2sbuf); \
+        }
+
+// cache of c2s_sph_2e1_prim
+#define C2S_PRIM_BUFLEN(envs) \
+        ((envs)->nfi * (envs)->nfk * (envs)->nfl * ((envs)->j_l*2+1) * 2)
+
 #define TRANSPOSE(a) \
         if (*empty) { \
-                CINTdmat_transpose(out, a, nf*nc, n_comp); \
+                CINTdmat_transpose(out, a, nfc*nc, n_comp); \
                 *empty = 0; \
         } else { \
-                CINTdplus_transpose(out, a, nf*nc, n_comp); \
+                CINTdplus_transpose(out, a, nfc*nc, n_comp); \
         } \
 
 #define PUSH(RIJ, RKL) \
         if (cum == SIMDD) { \
                 if ((*envs->f_g0_2e)(g, cutoff, &bc, envs, cum)) { \
                         (*envs->f_gout)(gout, g, idx, envs); \
+                        C2S_PRIM(cum); \
                         POP_PRIM2CTR; \
                 } else { \
                         POP_PRIM2CTR_AND_SET0; \
@@ -147,7 +212,7 @@
         } else { \
                 fp2c[np2c] = CINTiprim_to_ctr_1; \
         } \
-        gprim[np2c] = gout + cum * ngp[0]; \
+        gprim[np2c] = gprim0 + cum * ngp[0]; \
         gp2c [np2c] = gctr[SHLTYPi]; \
         iprim[np2c] = ip; \
         shltyp[np2c] = SHLTYPi; \
@@ -179,6 +244,7 @@
         if (cum == 1) { \
                 if ((*envs->f_g0_2e_simd1)(g, cutoff, &bc, envs, 0)) { \
                         (*envs->f_gout_simd1)(gout, g, idx, envs); \
+                        C2S_PRIM(1); \
                         POP_PRIM2CTR; \
                 } else { \
                         POP_PRIM2CTR_AND_SET0; \
@@ -186,6 +252,7 @@
         } else if (cum > 1) { \
                 if ((*envs->f_g0_2e)(g, cutoff, &bc, envs, cum)) { \
                         (*envs->f_gout)(gout, g, idx, envs); \
+                        C2S_PRIM(cum); \
                         POP_PRIM2CTR; \
                 } else { \
                         POP_PRIM2CTR_AND_SET0; \
@@ -258,7 +325,7 @@ int CINT2e_loop_nopt(double *out, CINTEnvVars *envs, double *cache, int *empty)
 
         akl = ak[k_prim-1] + al[l_prim-1];
         log_rr_kl = 1.7 - 1.5 * approx_log(akl);
-        double omega = env[PTR_RANGE_OMEGA];
+        double omega = envs->params[PTR_RANGE_OMEGA];
         if (omega < 0) {
                 // Normally the factor
                 //    (aj*d/aij+theta*R)^li * (ai*d/aij+theta*R)^lj * pi^1.5/aij^{(li+lj+3)/2}
@@ -311,14 +378,20 @@ int CINT2e_loop_nopt(double *out, CINTEnvVars *envs, double *cache, int *empty)
         int *non0idx[4] = {non0idxi, non0idxj, non0idxk, non0idxl};
         double common_factor = envs->common_factor;
 
+        // components of a primitive quartet to contract
+        size_t nfc = nf;
+        if (envs->c2s_prim) {
+                nfc = (envs->i_l*2+1) * (envs->j_l*2+1)
+                    * (envs->k_l*2+1) * (envs->l_l*2+1);
+        }
         size_t ngp[4];
-        ngp[0] = nf * n_comp;
+        ngp[0] = nfc * n_comp;
         ngp[1] = ngp[0] * i_ctr;
         ngp[2] = ngp[1] * j_ctr;
         ngp[3] = ngp[2] * k_ctr;
         // (irys,i,j,k,l,coord,0:1); +1 for nabla-r12
         int leng = envs->g_size * 3 * ((1<<envs->gbits)+1) * SIMDD;
-        size_t len0 = ngp[0] * SIMDD;
+        size_t len0 = nf * n_comp * SIMDD;
         size_t leni = ALIGN_UP(ngp[1], SIMDD);
         size_t lenj = ALIGN_UP(ngp[2], SIMDD);
         size_t lenk = ALIGN_UP(ngp[3], SIMDD);
@@ -344,6 +417,12 @@ int CINT2e_loop_nopt(double *out, CINTEnvVars *envs, double *cache, int *empty)
         ALIAS_ADDR_IF_EQUAL(i, j);
         MALLOC_INSTACK(gout, len0+MAX(len0,leng));
         g = gout + len0;  // for gx, gy, gz
+        double *gprim0 = gout;
+        double *c2sbuf = NULL;
+        if (envs->c2s_prim) {
+                MALLOC_INSTACK(gprim0, nfc * SIMDD);
+                MALLOC_INSTACK(c2sbuf, C2S_PRIM_BUFLEN(envs));
+        }
 
         ALIGNMM Rys2eT bc;
         ALIGNMM double cutoff[SIMDD];
@@ -427,19 +506,39 @@ int CINT2e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty)
         int l_prim = bas(NPRIM_OF, l_sh);
         int *x_ctr = envs->x_ctr;
         int x_prim[4] = {i_prim, j_prim, k_prim, l_prim};
-        double *ai = env + bas(PTR_EXP, i_sh);
-        double *aj = env + bas(PTR_EXP, j_sh);
-        double *ak = env + bas(PTR_EXP, k_sh);
-        double *al = env + bas(PTR_EXP, l_sh);
-        double *ci = env + bas(PTR_COEFF, i_sh);
-        double *cj = env + bas(PTR_COEFF, j_sh);
-        double *ck = env + bas(PTR_COEFF, k_sh);
-        double *cl = env + bas(PTR_COEFF, l_sh);
+        double *ai, *aj, *ak, *al, *ci, *cj, *ck, *cl;
+        if (opt->basis != NULL) {
+                // the copies of the basis data, stored in the traversal order
+                CINTBasisData *bd = opt->basis;
+                ai = bd->exps + bd->prim_loc[i_sh];
+                aj = bd->exps + bd->prim_loc[j_sh];
+                ak = bd->exps + bd->prim_loc[k_sh];
+                al = bd->exps + bd->prim_loc[l_sh];
+                ci = bd->coeffs + bd->coeff_loc[i_sh];
+                cj = bd->coeffs + bd->coeff_loc[j_sh];
+                ck = bd->coeffs + bd->coeff_loc[k_sh];
+                cl = bd->coeffs + bd->coeff_loc[l_sh];
+        } else {
+                ai = env + bas(PTR_EXP, i_sh);
+                aj = env + bas(PTR_EXP, j_sh);
+                ak = env + bas(PTR_EXP, k_sh);
+                al = env + bas(PTR_EXP, l_sh);
+                ci = env + bas(PTR_COEFF, i_sh);
+                cj = env + bas(PTR_COEFF, j_sh);
+                ck = env + bas(PTR_COEFF, k_sh);
+                cl = env + bas(PTR_COEFF, l_sh);
+        }
         double expcutoff = envs->expcutoff;
         PairData *_pdata_ij, *_pdata_kl, *pdata_kl, *pdata_ij;
+        // The shared pair data of the optimizer do not include the angular
+        // momentum term of the screening estimation, see CINTOpt_set_basis_data
+        double ij_shift = 0;
+        double kl_shift = 0;
         if (opt->pairdata != NULL) {
                 _pdata_ij = opt->pairdata[i_sh*opt->nbas+j_sh];
                 _pdata_kl = opt->pairdata[k_sh*opt->nbas+l_sh];
+                ij_shift = opt->pair_shift[i_sh*opt->nbas+j_sh];
+                kl_shift = opt->pair_shift[k_sh*opt->nbas+l_sh];
         } else {
                 double *log_maxci = opt->log_max_coeff[i_sh];
                 double *log_maxcj = opt->log_max_coeff[j_sh];
@@ -462,8 +561,12 @@ int CINT2e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty)
 
         int n_comp = envs->ncomp_e1 * envs->ncomp_e2 * envs->ncomp_tensor;
         size_t nf = envs->nf;
-        double fac1i, fac1j, fac1k, fac1l;
-        int ip, jp, kp, lp, i, it, im;
+        double fac1i;
+        // set when the first primitive quartet of the list is queued
+        double fac1j = 0;
+        double fac1k = 0;
+        double fac1l = 0;
+        int ip, jp, kp, lp, i, it, im, n;
         int _empty[4] = {1, 1, 1, 1};
         int *iempty = _empty + 0;
         int *jempty = _empty + 1;
@@ -471,29 +574,32 @@ int CINT2e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty)
         int *lempty = _empty + 3;
         int empty_overall = 1;
 
-        int *idx = opt->index_xyz_array[envs->i_l*LMAX1*LMAX1*LMAX1
-                                       +envs->j_l*LMAX1*LMAX1
-                                       +envs->k_l*LMAX1
-                                       +envs->l_l];
-        if (idx == NULL) {
-                MALLOC_DATA_INSTACK(idx, nf * 3);
-                CINTg4c_index_xyz(idx, envs);
+        int *idx = CINTOpt_index_xyz(opt, envs->i_l*LMAX1*LMAX1*LMAX1
+                                         +envs->j_l*LMAX1*LMAX1
+                                         +envs->k_l*LMAX1
+                                         +envs->l_l,
+                                     &CINTg4c_index_xyz, envs);
+
+        // components of a primitive quartet to contract
+        size_t nfc = nf;
+        if (envs->c2s_prim) {
+                nfc = (envs->i_l*2+1) * (envs->j_l*2+1)
+                    * (envs->k_l*2+1) * (envs->l_l*2+1);
         }
-
         size_t ngp[4];
-        ngp[0] = nf * n_comp;
+        ngp[0] = nfc * n_comp;
         ngp[1] = ngp[0] * i_ctr;
         ngp[2] = ngp[1] * j_ctr;
         ngp[3] = ngp[2] * k_ctr;
         // (irys,i,j,k,l,coord,0:1); +1 for nabla-r12
         int leng = envs->g_size * 3 * ((1<<envs->gbits)+1) * SIMDD;
-        size_t len0 = ngp[0] * SIMDD;
+        size_t len0 = nf * n_comp * SIMDD;
         size_t leni = ALIGN_UP(ngp[1], SIMDD);
         size_t lenj = ALIGN_UP(ngp[2], SIMDD);
         size_t lenk = ALIGN_UP(ngp[3], SIMDD);
         size_t lenl = ALIGN_UP(ngp[3] * l_ctr, SIMDD);
         double *gout, *g, *g1;
-        double *gctr[4];
+        double *gctr[4] = {NULL, NULL, NULL, NULL};
         double *bufctr[4];
         if (n_comp == 1) {
                 // patch SIMDD*2 for leni, lenj, lenk with s functions
@@ -512,11 +618,17 @@ int CINT2e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty)
         ALIAS_ADDR_IF_EQUAL(i, j);
         MALLOC_INSTACK(gout, len0+MAX(len0,leng));
         g = gout + len0;  // for gx, gy, gz
+        double *gprim0 = gout;
+        double *c2sbuf = NULL;
+        if (envs->c2s_prim) {
+                MALLOC_INSTACK(gprim0, nfc * SIMDD);
+                MALLOC_INSTACK(c2sbuf, C2S_PRIM_BUFLEN(envs));
+        }
 
         double *coeff[4] = {ci, cj, ck, cl};
         ALIGNMM Rys2eT bc;
         double common_factor = envs->common_factor;
-        double expijkl, eijcutoff;
+        double expijkl, eijcutoff, ccekl;
 
         int *non0ctri = opt->non0ctr[i_sh];
         int *non0ctrj = opt->non0ctr[j_sh];
@@ -530,42 +642,85 @@ int CINT2e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty)
         int *non0idx[4] = {non0idxi, non0idxj, non0idxk, non0idxl};
         ALIGNMM double cutoff[SIMDD];
 
-        INITSIMD;
-
+        // Phase 1: the compact list of the primitive quartets which survive
+        // the screening, stored as the (ij, kl) offsets of the pair data
+        int *qidx;
+        MALLOC_DATA_INSTACK(qidx, i_prim*j_prim*k_prim*l_prim*2);
+        int nq = 0;
+        int ij, kl;
         pdata_kl = _pdata_kl;
-        for (lp = 0; lp < l_prim; lp++) {
-                INIT_GCTR_ADDR(k, l, common_factor);
-                for (kp = 0; kp < k_prim; kp++, pdata_kl++) {
-                        if (pdata_kl->cceij > expcutoff) {
-                                goto k_contracted;
+        for (kl = 0; kl < k_prim*l_prim; kl++, pdata_kl++) {
+                ccekl = pdata_kl->cceij - kl_shift;
+                if (ccekl > expcutoff) {
+                        continue;
+                }
+                eijcutoff = expcutoff - MAX(ccekl, 0) + ij_shift;
+                for (ij = 0; ij < i_prim*j_prim; ij++) {
+                        if (_pdata_ij[ij].cceij <= eijcutoff) {
+                                qidx[nq*2+0] = ij;
+                                qidx[nq*2+1] = kl;
+                                nq++;
                         }
-                        INIT_GCTR_ADDR(j, k, fac1l);
+                }
+        }
+        if (nq == 0) {
+                return 0;
+        }
 
-                        eijcutoff = expcutoff - MAX(pdata_kl->cceij, 0);
-                        pdata_ij = _pdata_ij;
-                        for (jp = 0; jp < j_prim; jp++) {
-                                INIT_GCTR_ADDR(i, j, fac1k);
-                                for (ip = 0; ip < i_prim; ip++, pdata_ij++) {
-                                        if (pdata_ij->cceij > eijcutoff) {
-                                                goto i_contracted;
-                                        }
-                                        expijkl = pdata_ij->eij * pdata_kl->eij;
-                                        PUSH(pdata_ij->rij, pdata_kl->rij);
-i_contracted: ;
-                                } // end loop i_prim
+        // Phase 2: full SIMD batches over the list.  The contractions of j, k, l
+        // are queued when the primitive index of the shell changes.
+        INITSIMD;
+
+        jp = -1;
+        kp = -1;
+        lp = -1;
+        for (n = 0; n < nq; n++) {
+                ij = qidx[n*2+0];
+                kl = qidx[n*2+1];
+                if (kl != kp + lp * k_prim) {
+                        if (lp >= 0) {
                                 if (!*iempty) {
                                         PRIM2CTR(i, j);
                                 }
-                        } // end loop j_prim
-                        if (!*jempty) {
-                                PRIM2CTR(j, k);
+                                if (!*jempty) {
+                                        PRIM2CTR(j, k);
+                                }
                         }
-k_contracted: ;
-                } // end loop k_prim
-                if (!*kempty) {
-                        PRIM2CTR(k, l);
+                        if (kl / k_prim != lp) {
+                                if (lp >= 0 && !*kempty) {
+                                        PRIM2CTR(k, l);
+                                }
+                                lp = kl / k_prim;
+                                INIT_GCTR_ADDR(k, l, common_factor);
+                        }
+                        kp = kl - lp * k_prim;
+                        INIT_GCTR_ADDR(j, k, fac1l);
+                        jp = ij / i_prim;
+                        INIT_GCTR_ADDR(i, j, fac1k);
+                } else if (ij / i_prim != jp) {
+                        if (!*iempty) {
+                                PRIM2CTR(i, j);
+                        }
+                        jp = ij / i_prim;
+                        INIT_GCTR_ADDR(i, j, fac1k);
                 }
-        } // end loop l_prim
+                ip = ij - jp * i_prim;
+                pdata_ij = _pdata_ij + ij;
+                pdata_kl = _pdata_kl + kl;
+                ccekl = pdata_kl->cceij - kl_shift;
+                eijcutoff = expcutoff - MAX(ccekl, 0) + ij_shift;
+                expijkl = pdata_ij->eij * pdata_kl->eij;
+                PUSH(pdata_ij->rij, pdata_kl->rij);
+        }
+        if (!*iempty) {
+                PRIM2CTR(i, j);
+        }
+        if (!*jempty) {
+                PRIM2CTR(j, k);
+        }
+        if (!*kempty) {
+                PRIM2CTR(k, l);
+        }
         RUN_REST;
 
         if (n_comp > 1 && !empty_overall) {
@@ -590,20 +745,38 @@ int (*CINT2e_1111_loop)(double *, CINTEnvVars *, double *, int *) = &CINT2e_loop
                           + j_prim * x_ctr[1] \
                           + k_prim * x_ctr[2] \
                           + l_prim * x_ctr[3] \
-                          +(i_prim+j_prim+k_prim+l_prim)*2 + nf*3);
+                          +(i_prim+j_prim+k_prim+l_prim)*2 + nf*3 \
+                          + i_prim*j_prim*k_prim*l_prim);
 
 CACHE_SIZE_T CINT2e_drv(double *out, int *dims, CINTEnvVars *envs, CINTOpt *opt,
                         double *cache, void (*f_c2s)())
 {
         int *x_ctr = envs->x_ctr;
         size_t nf = envs->nf;
-        size_t nc = nf * x_ctr[0] * x_ctr[1] * x_ctr[2] * x_ctr[3];
         int n_comp = envs->ncomp_e1 * envs->ncomp_e2 * envs->ncomp_tensor;
+        size_t nfc = nf;
+        void (*f_c2s_ctr)() = f_c2s;
+        size_t len_c2s_prim = 0;
+        // The primitive integrals can be transformed to spherical in the
+        // loop only if they are eventually transformed by c2s_sph_2e1 and
+        // gout produces the Cartesian integrals in the layout of CINTgout2e.
+        // Other gout functions may order the components differently.
+        if (f_c2s != &c2s_sph_2e1 || n_comp != 1 ||
+            (envs->f_gout != &CINTgout2e && envs->f_gout != &CINTgout2e_f32)) {
+                envs->c2s_prim = 0;
+        } else if (envs->c2s_prim) {
+                nfc = (envs->i_l*2+1) * (envs->j_l*2+1)
+                    * (envs->k_l*2+1) * (envs->l_l*2+1);
+                f_c2s_ctr = &c2s_sph_2e1_copy;
+                len_c2s_prim = nfc * SIMDD + C2S_PRIM_BUFLEN(envs);
+        }
+        size_t nc = nfc * x_ctr[0] * x_ctr[1] * x_ctr[2] * x_ctr[3];
         if (out == NULL) {
                 PAIRDATA_NON0IDX_SIZE(pdata_size);
                 size_t leng = envs->g_size*3*((1<<envs->gbits)+1)*SIMDD;
                 size_t len0 = nf*n_comp * SIMDD;
-                size_t cache_size = MAX(leng+len0+nc*n_comp*3 + pdata_size,
+                size_t cache_size = MAX(len0+MAX(len0,leng)+nc*n_comp*3 + pdata_size
+                                        + len_c2s_prim,
                                         nc*n_comp+nf*4) + SIMDD*4;
 #ifndef CACHE_SIZE_I8
                 if (cache_size >= INT32_MAX) {
@@ -620,7 +793,8 @@ CACHE_SIZE_T CINT2e_drv(double *out, int *dims, CINTEnvVars *envs, CINTOpt *opt,
                 PAIRDATA_NON0IDX_SIZE(pdata_size);
                 size_t leng = envs->g_size*3*((1<<envs->gbits)+1)*SIMDD;
                 size_t len0 = nf*n_comp * SIMDD;
-                size_t cache_size = MAX(leng+len0+nc*n_comp*3 + pdata_size,
+                size_t cache_size = MAX(len0+MAX(len0,leng)+nc*n_comp*3 + pdata_size
+                                        + len_c2s_prim,
                                         nc*n_comp+nf*4) + SIMDD*4;
                 stack = _mm_malloc(sizeof(double)*cache_size, sizeof(double)*SIMDD);
                 cache = stack;
@@ -655,7 +829,7 @@ CACHE_SIZE_T CINT2e_drv(double *out, int *dims, CINTEnvVars *envs, CINTOpt *opt,
         int nout = dims[0] * dims[1] * dims[2] * dims[3];
         if (!empty) {
                 for (n = 0; n < n_comp; n++) {
-                        (*f_c2s)(out+nout*n, gctr+nc*n, dims, envs, cache);
+                        (*f_c2s_ctr)(out+nout*n, gctr+nc*n, dims, envs, cache);
                 }
         } else {
                 for (n = 0; n < n_comp; n++) {
@@ -670,6 +844,7 @@ CACHE_SIZE_T CINT2e_drv(double *out, int *dims, CINTEnvVars *envs, CINTOpt *opt,
 CACHE_SIZE_T CINT2e_spinor_drv(double complex *out, int *dims, CINTEnvVars *envs, CINTOpt *opt,
                       double *cache, void (*f_e1_c2s)(), void (*f_e2_c2s)())
 {
+        envs->c2s_prim = 0;
         int *shls = envs->shls;
         int *bas = envs->bas;
         int counts[4];
@@ -687,7 +862,7 @@ CACHE_SIZE_T CINT2e_spinor_drv(double complex *out, int *dims, CINTEnvVars *envs
                 PAIRDATA_NON0IDX_SIZE(pdata_size);
                 size_t leng = envs->g_size*3*((1<<envs->gbits)+1)*SIMDD;
                 size_t len0 = nf*n_comp * SIMDD;
-                size_t cache_size = MAX(leng+len0+nc*n_comp*3 + pdata_size,
+                size_t cache_size = MAX(len0+MAX(len0,leng)+nc*n_comp*3 + pdata_size,
                                      nc*n_comp + n1*envs->ncomp_e2*OF_CMPLX
                                      + nf*32*OF_CMPLX) + SIMDD*4;
 #ifndef CACHE_SIZE_I8
@@ -705,7 +880,7 @@ CACHE_SIZE_T CINT2e_spinor_drv(double complex *out, int *dims, CINTEnvVars *envs
                 PAIRDATA_NON0IDX_SIZE(pdata_size);
                 size_t leng = envs->g_size*3*((1<<envs->gbits)+1)*SIMDD;
                 size_t len0 = nf*n_comp * SIMDD;
-                size_t cache_size = MAX(leng+len0+nc*n_comp*3 + pdata_size,
+                size_t cache_size = MAX(len0+MAX(len0,leng)+nc*n_comp*3 + pdata_size,
                                      nc*n_comp + n1*envs->ncomp_e2*OF_CMPLX
                                      + nf*32*OF_CMPLX) + SIMDD*4;
                 stack = _mm_malloc(sizeof(double)*cache_size, sizeof(double)*SIMDD);
@@ -756,6 +931,7 @@ CACHE_SIZE_T int2e_sph(double *out, int *dims, int *shls, int *atm, int natm,
         CINTinit_int2e_EnvVars(&envs, ng, shls, atm, natm, bas, nbas, env);
         envs.f_gout = &CINTgout2e;
         envs.f_gout_simd1 = &CINTgout2e_simd1;
+        CINTmixed_precision_int2e(&envs);
         return CINT2e_drv(out, dims, &envs, opt, cache, &c2s_sph_2e1);
 }
 void int2e_optimizer(CINTOpt **opt, int *atm, int natm,
@@ -773,6 +949,7 @@ CACHE_SIZE_T int2e_cart(double *out, int *dims, int *shls, int *atm, int natm,
         CINTinit_int2e_EnvVars(&envs, ng, shls, atm, natm, bas, nbas, env);
         envs.f_gout = &CINTgout2e;
         envs.f_gout_simd1 = &CINTgout2e_simd1;
+        CINTmixed_precision_int2e(&envs);
         return CINT2e_drv(out, dims, &envs, opt, cache, &c2s_cart_2e1);
 }
 
@@ -787,6 +964,7 @@ CACHE_SIZE_T int2e_spinor(double complex *out, int *dims, int *shls, int *atm, i
         CINTinit_int2e_EnvVars(&envs, ng, shls, atm, natm, bas, nbas, env);
         envs.f_gout = &CINTgout2e;
         envs.f_gout_simd1 = &CINTgout2e_simd1;
+        CINTmixed_precision_int2e(&envs);
         return CINT2e_spinor_drv(out, dims, &envs, opt, cache,
                                  &c2s_sf_2e1, &c2s_sf_2e2);
 }
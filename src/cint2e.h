@@ -25,6 +25,8 @@ void CINT2e_core(double *gout, double *g, double fac1i,
 
 void CINTgout2e      (double *gout, double *g, int *idx, CINTEnvVars *envs);
 void CINTgout2e_simd1(double *gout, double *g, int *idx, CINTEnvVars *envs);
+void CINTgout2e_f32  (double *gout, double *g, int *idx, CINTEnvVars *envs);
+void CINTmixed_precision_int2e(CINTEnvVars *envs);
 
 int CINT2e_loop_nopt(double *out, CINTEnvVars *envs, double *cache, int *empty);
 int CINT2e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty);
@@ -0,0 +1,827 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Drivers which evaluate the ERIs of a whole shell range.
+ *
+ * The unique shell quartets are distributed over threads by the bra shell
+ * pair.  Each thread owns whole rows ij of the output, evaluates the
+ * quartets of a row with kl running over the ket pairs and consumes the
+ * shell block while it is still in cache: it is
+ * either scattered into symmetry-packed storage (CINTeri_fill_s8/s4),
+ * contracted with MO coefficients (CINTeri_ket_ao2mo) or kept as a block
+ * of columns of the pivoted Cholesky decomposition (CINTcholesky_eri).
+ *
+ * The bra and ket pairs of CINTeri_fill_s8/s4 and CINTeri_ket_ao2mo are
+ * traversed in the shell order of the basis data of the optimizer (by
+ * angular momentum, atom and exponent, see CINTBasisData).  Consecutive
+ * quartets then run the same kernel on adjacent basis and pair data.  The
+ * output positions are given by the shell ids of the caller.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "cint_bas.h"
+#include "simd.h"
+#include "misc.h"
+#include "optimizer.h"
+#include "fblas.h"
+
+#define SHELL_KIND_SIZE         3
+// Pivots of a column block are accepted down to this fraction of the
+// largest diagonal at the time the block is evaluated
+#define CHOLESKY_SPAN           1e-2
+#define CHOLESKY_BLKSIZE        512
+
+static int _in_slice(int sh, int *shls_slice, int nrange)
+{
+        int n;
+        for (n = 0; n < nrange; n++) {
+                if (shls_slice[n*2] <= sh && sh < shls_slice[n*2+1]) {
+                        return 1;
+                }
+        }
+        return 0;
+}
+
+/*
+ * The cache size of a quartet only depends on the angular momentum, the
+ * number of primitive and contracted functions of the four shells.  The
+ * required size is queried for one representative shell of each kind in
+ * the nrange shell ranges of shls_slice.
+ */
+CACHE_SIZE_T CINTmax_cache_size(CACHE_SIZE_T (*intor)(), int *shls_slice,
+                                int nrange, int *atm, int natm,
+                                int *bas, int nbas, double *env)
+{
+        int sh0 = shls_slice[0];
+        int sh1 = shls_slice[1];
+        int sh, n, i, j, k, l;
+        for (n = 1; n < nrange; n++) {
+                sh0 = MIN(sh0, shls_slice[n*2]);
+                sh1 = MAX(sh1, shls_slice[n*2+1]);
+        }
+        int *kinds = malloc(sizeof(int) * (sh1 - sh0) * (SHELL_KIND_SIZE+1));
+        int *rep = kinds + (sh1 - sh0) * SHELL_KIND_SIZE;
+        int nkind = 0;
+        for (sh = sh0; sh < sh1; sh++) {
+                if (!_in_slice(sh, shls_slice, nrange)) {
+                        continue;
+                }
+                for (n = 0; n < nkind; n++) {
+                        if (kinds[n*SHELL_KIND_SIZE+0] == bas(ANG_OF, sh) &&
+                            kinds[n*SHELL_KIND_SIZE+1] == bas(NPRIM_OF, sh) &&
+                            kinds[n*SHELL_KIND_SIZE+2] == bas(NCTR_OF, sh)) {
+                                break;
+                        }
+                }
+                if (n == nkind) {
+                        kinds[n*SHELL_KIND_SIZE+0] = bas(ANG_OF, sh);
+                        kinds[n*SHELL_KIND_SIZE+1] = bas(NPRIM_OF, sh);
+                        kinds[n*SHELL_KIND_SIZE+2] = bas(NCTR_OF, sh);
+                        rep[n] = sh;
+                        nkind++;
+                }
+        }
+
+        int shls[4];
+        CACHE_SIZE_T cache_size = 0;
+        for (i = 0; i < nkind; i++) {
+        for (j = 0; j < nkind; j++) {
+        for (k = 0; k < nkind; k++) {
+        for (l = 0; l < nkind; l++) {
+                shls[0] = rep[i];
+                shls[1] = rep[j];
+                shls[2] = rep[k];
+                shls[3] = rep[l];
+                cache_size = MAX(cache_size, (*intor)(NULL, NULL, shls, atm, natm,
+                                                      bas, nbas, env, NULL, NULL));
+        } } } }
+        free(kinds);
+        return cache_size;
+}
+
+// i of the pair index ij = i*(i+1)/2 + j, j <= i
+static int _pair_row(size_t ij)
+{
+        int i = (int)((sqrt(8.*ij + 1) - 1) * .5);
+        if ((size_t)i * (i + 1) / 2 > ij) {
+                i--;
+        } else if ((size_t)(i + 1) * (i + 2) / 2 <= ij) {
+                i++;
+        }
+        return i;
+}
+
+/*
+ * The shells of [sh0,sh1) in the shell order of the basis data of opt, or in
+ * increasing order without the basis data.
+ */
+static void _ordered_shells(int *order, CINTOpt *opt, int sh0, int sh1)
+{
+        int n, i, sh;
+        if (opt != NULL && opt->basis != NULL) {
+                for (i = 0, n = 0; i < opt->basis->nbas; i++) {
+                        sh = opt->basis->shl_order[i];
+                        if (sh0 <= sh && sh < sh1) {
+                                order[n++] = sh;
+                        }
+                }
+        } else {
+                for (sh = sh0; sh < sh1; sh++) {
+                        order[sh-sh0] = sh;
+                }
+        }
+}
+
+/*
+ * Shell pairs (ish,jsh), ish >= jsh, of [sh0,sh1) in the shell order of
+ * _ordered_shells.  pairs[npair,2]
+ */
+static int *_ordered_pairs(CINTOpt *opt, int sh0, int sh1)
+{
+        int nsh = sh1 - sh0;
+        size_t npair = (size_t)nsh * (nsh + 1) / 2;
+        int *order = malloc(sizeof(int) * MAX(nsh, 1));
+        int *pairs = malloc(sizeof(int) * MAX(npair, 1) * 2);
+        int a, b;
+        size_t n;
+        _ordered_shells(order, opt, sh0, sh1);
+        for (a = 0, n = 0; a < nsh; a++) {
+                for (b = 0; b <= a; b++, n++) {
+                        pairs[n*2+0] = MAX(order[a], order[b]);
+                        pairs[n*2+1] = MIN(order[a], order[b]);
+                }
+        }
+        free(order);
+        return pairs;
+}
+
+static int _max_shell_size(int *ao_loc, int *shls_slice, int nrange)
+{
+        int sh, n;
+        int di = 0;
+        for (n = 0; n < nrange; n++) {
+                for (sh = shls_slice[n*2]; sh < shls_slice[n*2+1]; sh++) {
+                        di = MAX(di, ao_loc[sh+1] - ao_loc[sh]);
+                }
+        }
+        return di;
+}
+
+/*
+ * Scatter the shell block buf[l,k,j,i] of the quartet shls into the packed
+ * storage.  AO indices are relative to the first AO of the bra (i0) and ket
+ * (k0) slices.  For s8, the elements with kl > ij (ksh == ish, lsh > jsh)
+ * are written to the transposed position.  They are not covered by any
+ * other quartet of ijsh >= klsh.
+ */
+static void _pack_block(double *out, double *buf, int *shls, int *ao_loc,
+                        int ao_i0, int ao_k0, size_t nkl, int s8)
+{
+        int i0 = ao_loc[shls[0]] - ao_i0;
+        int j0 = ao_loc[shls[1]] - ao_i0;
+        int k0 = ao_loc[shls[2]] - ao_k0;
+        int l0 = ao_loc[shls[3]] - ao_k0;
+        int di = ao_loc[shls[0]+1] - ao_loc[shls[0]];
+        int dj = ao_loc[shls[1]+1] - ao_loc[shls[1]];
+        int dk = ao_loc[shls[2]+1] - ao_loc[shls[2]];
+        int dl = ao_loc[shls[3]+1] - ao_loc[shls[3]];
+        size_t dij = di * dj;
+        size_t dijk = dij * dk;
+        int i, j, k, j1;
+        size_t ij, kl, kl1, l, l1;
+        double *pout, *pbuf;
+
+        for (i = 0; i < di; i++) {
+                j1 = MIN(dj, i0 + i - j0 + 1);
+                for (j = 0; j < j1; j++) {
+                        ij = (size_t)(i0+i) * (i0+i+1) / 2 + j0 + j;
+                        if (s8) {
+                                pout = out + ij * (ij + 1) / 2;
+                        } else {
+                                pout = out + ij * nkl;
+                        }
+                        pbuf = buf + j * di + i;
+                        for (k = 0; k < dk; k++) {
+                                kl = (size_t)(k0+k) * (k0+k+1) / 2 + l0;
+                                l1 = MIN(dl, k0 + k - l0 + 1);
+                                if (s8) {
+                                        // (kl|ij) with kl > ij is stored in row kl
+                                        kl1 = ij + 1 - MIN(kl, ij + 1);
+                                        for (l = MIN(l1, kl1); l < l1; l++) {
+                                                out[(kl+l)*(kl+l+1)/2+ij] = pbuf[l*dijk+k*dij];
+                                        }
+                                        l1 = MIN(l1, kl1);
+                                }
+                                for (l = 0; l < l1; l++) {
+                                        pout[kl+l] = pbuf[l*dijk+k*dij];
+                                }
+                        }
+                }
+        }
+}
+
+/*
+ * Work-stealing scheduler of the bra shell pairs bra_pairs[nbra,2], balanced
+ * with the estimated cost of the rows (bra|kl) of the ket pairs
+ * ket_pairs[nket,2].  row_frac[n] is the fraction of the ket pairs of row n
+ * (NULL for all).
+ */
+static CINTScheduler *_pair_scheduler(int *bra_pairs, size_t nbra, double *row_frac,
+                                      int *ket_pairs, size_t nklsh, CINTOpt *opt)
+{
+        double *costs = malloc(sizeof(double) * nbra);
+        size_t n;
+        CINTScheduler *sched;
+        if (CINTpair_costs(costs, opt, bra_pairs, nbra, ket_pairs, nklsh) == 0) {
+                if (row_frac != NULL) {
+                        for (n = 0; n < nbra; n++) {
+                                costs[n] *= row_frac[n];
+                        }
+                }
+                sched = CINTsched_create(costs, nbra);
+        } else {
+                // without the basis data of an optimizer
+                sched = CINTsched_create(row_frac, nbra);
+        }
+        free(costs);
+        return sched;
+}
+
+static void _eri_fill(double *out, CACHE_SIZE_T (*intor)(), int *ao_loc,
+                      int *shls_slice, CINTOpt *opt,
+                      int *atm, int natm, int *bas, int nbas, double *env, int s8)
+{
+        int ish0 = shls_slice[0];
+        int ish1 = shls_slice[1];
+        int ksh0 = shls_slice[2];
+        int ksh1 = shls_slice[3];
+        int nish = ish1 - ish0;
+        int nksh = ksh1 - ksh0;
+        if (nish <= 0 || nksh <= 0) {
+                return;
+        }
+        int ao_i0 = ao_loc[ish0];
+        int ao_k0 = ao_loc[ksh0];
+        size_t naok = ao_loc[ksh1] - ao_k0;
+        size_t nkl = naok * (naok + 1) / 2;
+        size_t nijsh = (size_t)nish * (nish + 1) / 2;
+        size_t nklsh = (size_t)nksh * (nksh + 1) / 2;
+        int dmax = _max_shell_size(ao_loc, shls_slice, 2);
+        CACHE_SIZE_T cache_size = CINTmax_cache_size(intor, shls_slice, 2,
+                                                     atm, natm, bas, nbas, env);
+        size_t nbuf = (size_t)dmax * dmax * dmax * dmax;
+        nbuf = (nbuf + SIMDD - 1) / SIMDD * SIMDD;
+
+        // For s8, the ket pairs of a row are limited to kl <= ij
+        int *rows = _ordered_pairs(opt, ish0, ish1);
+        int *kets = s8 ? rows : _ordered_pairs(opt, ksh0, ksh1);
+        double *row_frac = malloc(sizeof(double) * nijsh);
+        size_t n;
+        int ish, jsh;
+        for (n = 0; n < nijsh; n++) {
+                if (s8) {
+                        ish = rows[n*2+0] - ish0;
+                        jsh = rows[n*2+1] - ish0;
+                        row_frac[n] = ((double)ish * (ish + 1) / 2 + jsh + 1) / nklsh;
+                } else {
+                        row_frac[n] = 1;
+                }
+        }
+        CINTScheduler *sched = _pair_scheduler(rows, nijsh, row_frac, kets, nklsh, opt);
+
+#pragma omp parallel
+{
+        int ksh, lsh;
+        size_t n, m, ij0, ij1, ijsh, klsh;
+        int shls[4];
+        double *buf = _mm_malloc(sizeof(double) * (nbuf + cache_size),
+                                 sizeof(double)*SIMDD);
+        double *cache = buf + nbuf;
+        while (CINTsched_next(sched, &ij0, &ij1)) {
+        for (n = ij0; n < ij1; n++) {
+                shls[0] = rows[n*2+0];
+                shls[1] = rows[n*2+1];
+                ijsh = (size_t)(shls[0]-ish0) * (shls[0]-ish0+1) / 2 + shls[1] - ish0;
+                for (m = 0; m < nklsh; m++) {
+                        shls[2] = kets[m*2+0];
+                        shls[3] = kets[m*2+1];
+                        if (s8) {
+                                ksh = shls[2] - ksh0;
+                                lsh = shls[3] - ksh0;
+                                klsh = (size_t)ksh * (ksh + 1) / 2 + lsh;
+                                if (klsh > ijsh) {
+                                        continue;
+                                }
+                        }
+                        (*intor)(buf, NULL, shls, atm, natm, bas, nbas, env,
+                                 opt, cache);
+                        _pack_block(out, buf, shls, ao_loc, ao_i0, ao_k0, nkl, s8);
+                }
+        } }
+        _mm_free(buf);
+}
+        CINTsched_del(sched);
+        if (!s8) {
+                free(kets);
+        }
+        free(rows);
+        free(row_frac);
+}
+
+void CINTeri_fill_s8(double *out, CACHE_SIZE_T (*intor)(), int *ao_loc,
+                     int *shls_slice, CINTOpt *opt,
+                     int *atm, int natm, int *bas, int nbas, double *env)
+{
+        int slice[4] = {shls_slice[0], shls_slice[1], shls_slice[0], shls_slice[1]};
+        _eri_fill(out, intor, ao_loc, slice, opt, atm, natm, bas, nbas, env, 1);
+}
+
+void CINTeri_fill_s4(double *out, CACHE_SIZE_T (*intor)(), int *ao_loc,
+                     int *shls_slice, CINTOpt *opt,
+                     int *atm, int natm, int *bas, int nbas, double *env)
+{
+        _eri_fill(out, intor, ao_loc, shls_slice, opt, atm, natm, bas, nbas, env, 0);
+}
+
+/*
+ * First index transformation of the quartet block buf[l,k,ij]
+ *      t[lambda,p,ij] += sum_kappa C[kappa,p] (ij|kappa lambda)
+ * For ksh != lsh the block also provides (ij|lk) for lambda in ksh.
+ */
+static void _ket_trans1(double *t, double *buf, double *mo, int nmo, size_t naok,
+                        int *shls, int *ao_loc, int ao_k0, double *tmp, double *c)
+{
+        int k0 = ao_loc[shls[2]] - ao_k0;
+        int l0 = ao_loc[shls[3]] - ao_k0;
+        int di = ao_loc[shls[0]+1] - ao_loc[shls[0]];
+        int dj = ao_loc[shls[1]+1] - ao_loc[shls[1]];
+        int dk = ao_loc[shls[2]+1] - ao_loc[shls[2]];
+        int dl = ao_loc[shls[3]+1] - ao_loc[shls[3]];
+        size_t dij = di * dj;
+        size_t dijp = dij * nmo;
+        int k, l, p;
+        size_t n;
+        double *pt, *ptmp;
+
+        for (p = 0; p < nmo; p++) {
+        for (k = 0; k < dk; k++) {
+                c[k+dk*p] = mo[p*naok+k0+k];
+        } }
+        for (l = 0; l < dl; l++) {
+                CINTdgemm_NN(dij, nmo, dk, buf+l*dij*dk, c, tmp);
+                pt = t + (l0+l) * dijp;
+                for (n = 0; n < dijp; n++) {
+                        pt[n] += tmp[n];
+                }
+        }
+
+        if (shls[2] != shls[3]) {
+                for (p = 0; p < nmo; p++) {
+                for (l = 0; l < dl; l++) {
+                        c[l+dl*p] = mo[p*naok+l0+l];
+                } }
+                // tmp[p,k,ij]
+                CINTdgemm_NN(dij*dk, nmo, dl, buf, c, tmp);
+                for (k = 0; k < dk; k++) {
+                for (p = 0; p < nmo; p++) {
+                        pt = t + (k0+k) * dijp + p * dij;
+                        ptmp = tmp + (p * dk + k) * dij;
+                        for (n = 0; n < dij; n++) {
+                                pt[n] += ptmp[n];
+                        }
+                } }
+        }
+}
+
+/*
+ * Scatter the transformed block res[q,p,ij] of the bra pair (ish,jsh) to
+ * out[q,p,j,i].  If (jsh,ish) is in the slice as well, its block is the
+ * transpose in ij.
+ */
+static void _ket_trans_scatter(double *out, double *res, int npq, int *shls,
+                               int *ao_loc, int *shls_slice, int transpose)
+{
+        int ao_i0 = ao_loc[shls_slice[0]];
+        int ao_j0 = ao_loc[shls_slice[2]];
+        size_t naoi = ao_loc[shls_slice[1]] - ao_i0;
+        size_t naoij = naoi * (ao_loc[shls_slice[3]] - ao_j0);
+        int i0 = ao_loc[shls[0]];
+        int j0 = ao_loc[shls[1]];
+        int di = ao_loc[shls[0]+1] - i0;
+        int dj = ao_loc[shls[1]+1] - j0;
+        int i, j, n;
+        double *pout, *pres;
+
+        for (n = 0; n < npq; n++) {
+                pres = res + (size_t)n * di * dj;
+                pout = out + n * naoij + (j0 - ao_j0) * naoi + i0 - ao_i0;
+                for (j = 0; j < dj; j++) {
+                for (i = 0; i < di; i++) {
+                        pout[j*naoi+i] = pres[j*di+i];
+                } }
+                if (transpose) {
+                        pout = out + n * naoij + (i0 - ao_j0) * naoi + j0 - ao_i0;
+                        for (i = 0; i < di; i++) {
+                        for (j = 0; j < dj; j++) {
+                                pout[i*naoi+j] = pres[j*di+i];
+                        } }
+                }
+        }
+}
+
+void CINTeri_ket_ao2mo(double *out, CACHE_SIZE_T (*intor)(), int *ao_loc,
+                       int *shls_slice, double *mo_k, int nmo_k,
+                       double *mo_l, int nmo_l, CINTOpt *opt,
+                       int *atm, int natm, int *bas, int nbas, double *env)
+{
+        int ish0 = shls_slice[0];
+        int ish1 = shls_slice[1];
+        int jsh0 = shls_slice[2];
+        int jsh1 = shls_slice[3];
+        int ksh0 = shls_slice[4];
+        int ksh1 = shls_slice[5];
+        int nish = ish1 - ish0;
+        int njsh = jsh1 - jsh0;
+        int nksh = ksh1 - ksh0;
+        if (nish <= 0 || njsh <= 0 || nksh <= 0 || nmo_k <= 0) {
+                return;
+        }
+        int ao_k0 = ao_loc[ksh0];
+        size_t naok = ao_loc[ksh1] - ao_k0;
+        size_t nijsh = (size_t)nish * njsh;
+        size_t nklsh = (size_t)nksh * (nksh + 1) / 2;
+        int dmax = _max_shell_size(ao_loc, shls_slice, 3);
+        CACHE_SIZE_T cache_size = CINTmax_cache_size(intor, shls_slice, 3,
+                                                     atm, natm, bas, nbas, env);
+        size_t nbuf = (size_t)dmax * dmax * dmax * dmax;
+        size_t ntmp = (size_t)dmax * dmax * dmax * nmo_k;
+        size_t nt = (size_t)dmax * dmax * nmo_k * naok;
+        // Only the first index is transformed without mo_l
+        size_t nres = (mo_l != NULL) ? (size_t)dmax * dmax * nmo_k * nmo_l : 0;
+        nbuf = (nbuf + SIMDD - 1) / SIMDD * SIMDD;
+
+        int *rows = malloc(sizeof(int) * (nijsh * 2 + nish + njsh));
+        int *iorder = rows + nijsh * 2;
+        int *jorder = iorder + nish;
+        int *kets = _ordered_pairs(opt, ksh0, ksh1);
+        double *row_frac = malloc(sizeof(double) * nijsh);
+        size_t ijsh;
+        int ish, jsh;
+        _ordered_shells(iorder, opt, ish0, ish1);
+        _ordered_shells(jorder, opt, jsh0, jsh1);
+        for (ijsh = 0; ijsh < nijsh; ijsh++) {
+                ish = iorder[ijsh / njsh];
+                jsh = jorder[ijsh % njsh];
+                rows[ijsh*2+0] = ish;
+                rows[ijsh*2+1] = jsh;
+                // (jsh,ish) is evaluated with (ish,jsh) if both are in the slice
+                if (ish < jsh && ish0 <= jsh && jsh < ish1 && jsh0 <= ish && ish < jsh1) {
+                        row_frac[ijsh] = 0;
+                } else {
+                        row_frac[ijsh] = 1;
+                }
+        }
+        CINTScheduler *sched = _pair_scheduler(rows, nijsh, row_frac, kets, nklsh, opt);
+
+#pragma omp parallel
+{
+        int ish, jsh, transpose;
+        size_t ijsh, ij0, ij1, klsh, dij;
+        int shls[4];
+        double *buf = _mm_malloc(sizeof(double) * (nbuf + cache_size + ntmp + nt + nres
+                                                   + dmax * nmo_k),
+                                 sizeof(double)*SIMDD);
+        double *cache = buf + nbuf;
+        double *tmp = cache + cache_size;
+        double *t = tmp + ntmp;
+        double *res = t + nt;
+        double *c = res + nres;
+        while (CINTsched_next(sched, &ij0, &ij1)) {
+        for (ijsh = ij0; ijsh < ij1; ijsh++) {
+                ish = rows[ijsh*2+0];
+                jsh = rows[ijsh*2+1];
+                // (jsh,ish) is evaluated with (ish,jsh) if both are in the
+                // slice, assuming (ij|kl) = (ji|kl) for intor
+                transpose = (ish != jsh && ish0 <= jsh && jsh < ish1 &&
+                             jsh0 <= ish && ish < jsh1);
+                if (transpose && ish < jsh) {
+                        continue;
+                }
+                shls[0] = ish;
+                shls[1] = jsh;
+                dij = (ao_loc[ish+1] - ao_loc[ish]) * (ao_loc[jsh+1] - ao_loc[jsh]);
+                CINTdset0(dij * nmo_k * naok, t);
+                for (klsh = 0; klsh < nklsh; klsh++) {
+                        shls[2] = kets[klsh*2+0];
+                        shls[3] = kets[klsh*2+1];
+                        if ((*intor)(buf, NULL, shls, atm, natm, bas, nbas, env,
+                                     opt, cache)) {
+                                _ket_trans1(t, buf, mo_k, nmo_k, naok, shls,
+                                            ao_loc, ao_k0, tmp, c);
+                        }
+                }
+                if (mo_l != NULL) {
+                        CINTdgemm_NN(dij*nmo_k, nmo_l, naok, t, mo_l, res);
+                        _ket_trans_scatter(out, res, nmo_k*nmo_l, shls,
+                                           ao_loc, shls_slice, transpose);
+                } else {
+                        _ket_trans_scatter(out, t, nmo_k*naok, shls,
+                                           ao_loc, shls_slice, transpose);
+                }
+        } }
+        _mm_free(buf);
+}
+        CINTsched_del(sched);
+        free(rows);
+        free(kets);
+        free(row_frac);
+}
+
+/*
+ * AO pairs ij = i*(i+1)/2+j of the shell pair (ish,jsh), ish >= jsh.  The
+ * position of each pair in the shell block buf[l,k,j,i] is returned in
+ * offset, relative to the first AO of the slice ao0.
+ */
+static int _shell_pair_aopairs(size_t *idx, int *offset, int ish, int jsh,
+                               int *ao_loc, int ao0)
+{
+        int i0 = ao_loc[ish] - ao0;
+        int j0 = ao_loc[jsh] - ao0;
+        int di = ao_loc[ish+1] - ao_loc[ish];
+        int dj = ao_loc[jsh+1] - ao_loc[jsh];
+        int i, j;
+        int n = 0;
+        for (j = 0; j < dj; j++) {
+                for (i = MAX(0, j0 + j - i0); i < di; i++) {
+                        idx[n] = (size_t)(i0+i) * (i0+i+1) / 2 + j0 + j;
+                        offset[n] = j * di + i;
+                        n++;
+                }
+        }
+        return n;
+}
+
+/*
+ * Columns (ij|kl) of all AO pairs ij for the AO pairs kl of the shell pair
+ * (ksh,lsh).  cols[c,ij] for the c-th pair of (ksh,lsh).
+ */
+static void _cholesky_columns(double *cols, int ksh, int lsh, CACHE_SIZE_T (*intor)(),
+                              int *ao_loc, int *shls_slice, size_t npair,
+                              size_t nbuf, CACHE_SIZE_T cache_size, CINTOpt *opt,
+                              int *atm, int natm, int *bas, int nbas, double *env)
+{
+        int sh0 = shls_slice[0];
+        int nsh = shls_slice[1] - sh0;
+        int ao0 = ao_loc[sh0];
+        size_t nshpair = (size_t)nsh * (nsh + 1) / 2;
+        int dk = ao_loc[ksh+1] - ao_loc[ksh];
+        int dl = ao_loc[lsh+1] - ao_loc[lsh];
+        int dkl = dk * dl;
+        size_t *klidx = malloc(sizeof(size_t) * dkl);
+        int *kloff = malloc(sizeof(int) * dkl);
+        int nkl = _shell_pair_aopairs(klidx, kloff, ksh, lsh, ao_loc, ao0);
+
+#pragma omp parallel
+{
+        int ish, jsh, nij, dij, n, c;
+        size_t ijsh;
+        int shls[4];
+        size_t *ijidx = malloc(sizeof(size_t) * nbuf);
+        int *ijoff = malloc(sizeof(int) * nbuf);
+        double *buf = _mm_malloc(sizeof(double) * (nbuf + cache_size),
+                                 sizeof(double)*SIMDD);
+        double *cache = buf + nbuf;
+        shls[2] = ksh;
+        shls[3] = lsh;
+#pragma omp for schedule(dynamic, 4)
+        for (ijsh = 0; ijsh < nshpair; ijsh++) {
+                ish = _pair_row(ijsh);
+                jsh = ijsh - (size_t)ish * (ish + 1) / 2;
+                shls[0] = sh0 + ish;
+                shls[1] = sh0 + jsh;
+                nij = _shell_pair_aopairs(ijidx, ijoff, sh0+ish, sh0+jsh, ao_loc, ao0);
+                dij = (ao_loc[sh0+ish+1] - ao_loc[sh0+ish]) *
+                      (ao_loc[sh0+jsh+1] - ao_loc[sh0+jsh]);
+                if ((*intor)(buf, NULL, shls, atm, natm, bas, nbas, env,
+                             opt, cache)) {
+                        for (c = 0; c < nkl; c++) {
+                        for (n = 0; n < nij; n++) {
+                                cols[c*npair+ijidx[n]] = buf[kloff[c]*dij+ijoff[n]];
+                        } }
+                } else {
+                        for (c = 0; c < nkl; c++) {
+                        for (n = 0; n < nij; n++) {
+                                cols[c*npair+ijidx[n]] = 0;
+                        } }
+                }
+        }
+        _mm_free(buf);
+        free(ijoff);
+        free(ijidx);
+}
+        free(kloff);
+        free(klidx);
+}
+
+static double _shell_pair_max(double *diag, int ish, int jsh, int *ao_loc, int ao0)
+{
+        int i0 = ao_loc[ish] - ao0;
+        int i1 = ao_loc[ish+1] - ao0;
+        int j0 = ao_loc[jsh] - ao0;
+        int j1 = ao_loc[jsh+1] - ao0;
+        int i, j;
+        double dmax = 0;
+        for (i = i0; i < i1; i++) {
+                for (j = j0; j < MIN(j1, i+1); j++) {
+                        dmax = MAX(dmax, diag[i*(i+1)/2+j]);
+                }
+        }
+        return dmax;
+}
+
+static void _cholesky_diag(double *diag, double *shpair_max, CACHE_SIZE_T (*intor)(),
+                           int *ao_loc, int *shls_slice, size_t nbuf,
+                           CACHE_SIZE_T cache_size, CINTOpt *opt,
+                           int *atm, int natm, int *bas, int nbas, double *env)
+{
+        int sh0 = shls_slice[0];
+        int nsh = shls_slice[1] - sh0;
+        int ao0 = ao_loc[sh0];
+        size_t nshpair = (size_t)nsh * (nsh + 1) / 2;
+
+#pragma omp parallel
+{
+        int ish, jsh, nij, dij, n;
+        size_t ijsh;
+        int shls[4];
+        double dmax;
+        size_t *ijidx = malloc(sizeof(size_t) * nbuf);
+        int *ijoff = malloc(sizeof(int) * nbuf);
+        double *buf = _mm_malloc(sizeof(double) * (nbuf + cache_size),
+                                 sizeof(double)*SIMDD);
+        double *cache = buf + nbuf;
+#pragma omp for schedule(dynamic, 4)
+        for (ijsh = 0; ijsh < nshpair; ijsh++) {
+                ish = _pair_row(ijsh);
+                jsh = ijsh - (size_t)ish * (ish + 1) / 2;
+                shls[0] = sh0 + ish;
+                shls[1] = sh0 + jsh;
+                shls[2] = sh0 + ish;
+                shls[3] = sh0 + jsh;
+                nij = _shell_pair_aopairs(ijidx, ijoff, sh0+ish, sh0+jsh, ao_loc, ao0);
+                dij = (ao_loc[sh0+ish+1] - ao_loc[sh0+ish]) *
+                      (ao_loc[sh0+jsh+1] - ao_loc[sh0+jsh]);
+                (*intor)(buf, NULL, shls, atm, natm, bas, nbas, env, opt, cache);
+                dmax = 0;
+                for (n = 0; n < nij; n++) {
+                        diag[ijidx[n]] = buf[ijoff[n]*(dij+1)];
+                        dmax = MAX(dmax, diag[ijidx[n]]);
+                }
+                shpair_max[ijsh] = dmax;
+        }
+        _mm_free(buf);
+        free(ijoff);
+        free(ijidx);
+}
+}
+
+/*
+ * Pivoted Cholesky decomposition of the ERI matrix (ij|kl) over the AO pairs
+ * of the shell range.  The diagonal is evaluated in one pass over the shell
+ * pairs.  The columns are then evaluated a shell pair at a time, for the
+ * shell pair which holds the largest residual diagonal, and several pivots
+ * are taken from each column block.
+ */
+int CINTcholesky_eri(double *out, int max_vec, double threshold,
+                     CACHE_SIZE_T (*intor)(), int *ao_loc, int *shls_slice,
+                     CINTOpt *opt, int *atm, int natm, int *bas, int nbas, double *env)
+{
+        int sh0 = shls_slice[0];
+        int sh1 = shls_slice[1];
+        int nsh = sh1 - sh0;
+        if (nsh <= 0 || max_vec <= 0) {
+                return 0;
+        }
+        int ao0 = ao_loc[sh0];
+        size_t nao = ao_loc[sh1] - ao0;
+        size_t npair = nao * (nao + 1) / 2;
+        size_t nshpair = (size_t)nsh * (nsh + 1) / 2;
+        int slice[4] = {sh0, sh1, sh0, sh1};
+        int dmax = _max_shell_size(ao_loc, slice, 1);
+        CACHE_SIZE_T cache_size = CINTmax_cache_size(intor, slice, 1,
+                                                     atm, natm, bas, nbas, env);
+        size_t nbuf = (size_t)dmax * dmax * dmax * dmax;
+        nbuf = (nbuf + SIMDD - 1) / SIMDD * SIMDD;
+
+        double *diag = malloc(sizeof(double) * (npair + nshpair));
+        double *shpair_max = diag + npair;
+        double *cols = malloc(sizeof(double) * npair * dmax * dmax);
+        double *lpivot = malloc(sizeof(double) * max_vec);
+        size_t *klidx = malloc(sizeof(size_t) * dmax * dmax);
+        int *kloff = malloc(sizeof(int) * dmax * dmax);
+        _cholesky_diag(diag, shpair_max, intor, ao_loc, slice, nbuf, cache_size,
+                       opt, atm, natm, bas, nbas, env);
+
+        int nvec = 0;
+        int converged = 0;
+        int ksh, lsh, nkl, c, cmax, m;
+        size_t klsh, ij, ij0, ij1;
+        double dglobal, dpivot, fac;
+        double *col, *vec;
+        while (nvec < max_vec) {
+                klsh = 0;
+                for (ij = 1; ij < nshpair; ij++) {
+                        if (shpair_max[ij] > shpair_max[klsh]) {
+                                klsh = ij;
+                        }
+                }
+                dglobal = shpair_max[klsh];
+                if (dglobal < threshold) {
+                        converged = 1;
+                        break;
+                }
+                ksh = sh0 + _pair_row(klsh);
+                lsh = sh0 + klsh - (size_t)(ksh-sh0) * (ksh-sh0+1) / 2;
+                nkl = _shell_pair_aopairs(klidx, kloff, ksh, lsh, ao_loc, ao0);
+                _cholesky_columns(cols, ksh, lsh, intor, ao_loc, slice, npair,
+                                  nbuf, cache_size, opt, atm, natm, bas, nbas, env);
+
+                while (nvec < max_vec) {
+                        cmax = 0;
+                        for (c = 1; c < nkl; c++) {
+                                if (diag[klidx[c]] > diag[klidx[cmax]]) {
+                                        cmax = c;
+                                }
+                        }
+                        dpivot = diag[klidx[cmax]];
+                        if (dpivot < MAX(threshold, dglobal * CHOLESKY_SPAN)) {
+                                break;
+                        }
+                        col = cols + cmax * npair;
+                        vec = out + nvec * npair;
+                        for (m = 0; m < nvec; m++) {
+                                lpivot[m] = out[m*npair+klidx[cmax]];
+                        }
+                        fac = 1. / sqrt(dpivot);
+#pragma omp parallel private(ij0, ij1, ij, m)
+{
+#pragma omp for schedule(static)
+                        for (ij0 = 0; ij0 < npair; ij0 += CHOLESKY_BLKSIZE) {
+                                ij1 = MIN(ij0 + CHOLESKY_BLKSIZE, npair);
+                                for (ij = ij0; ij < ij1; ij++) {
+                                        vec[ij] = col[ij];
+                                }
+                                for (m = 0; m < nvec; m++) {
+                                        for (ij = ij0; ij < ij1; ij++) {
+                                                vec[ij] -= out[m*npair+ij] * lpivot[m];
+                                        }
+                                }
+                                for (ij = ij0; ij < ij1; ij++) {
+                                        vec[ij] *= fac;
+                                        diag[ij] -= vec[ij] * vec[ij];
+                                }
+                        }
+}
+                        // Remove the pivot from later selections exactly
+                        diag[klidx[cmax]] = 0;
+                        nvec++;
+                }
+                for (ij = 0; ij < nshpair; ij++) {
+                        ksh = _pair_row(ij);
+                        lsh = ij - (size_t)ksh * (ksh + 1) / 2;
+                        shpair_max[ij] = _shell_pair_max(diag, sh0+ksh, sh0+lsh,
+                                                         ao_loc, ao0);
+                }
+        }
+
+        if (!converged) {
+                fprintf(stderr, "CINTcholesky_eri: %d vectors are not enough "
+                        "for threshold %g\n", max_vec, threshold);
+        }
+        free(kloff);
+        free(klidx);
+        free(lpivot);
+        free(cols);
+        free(diag);
+        return nvec;
+}
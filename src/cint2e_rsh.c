@@ -0,0 +1,479 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ERIs of several attenuated Coulomb operators in one pass,
+ *      omega = 0:  1/r
+ *      omega > 0:  erf(omega r)/r
+ *      omega < 0:  erfc(|omega| r)/r = 1/r - erf(|omega| r)/r
+ * Each operator is a set of Rys quadratures ("groups") of the full-range
+ * or the long-range Coulomb kernel.  The g arrays of the groups are
+ * computed in consecutive blocks of the g buffer, with the standard
+ * strides of int2e, and summed in the gout function.  The pair data, the
+ * primitive loops, the contraction and the cart-to-spherical
+ * transformation are shared by all operators.  The omegas and the
+ * coefficients are read from the env slots NRSH_OMEGA, PTR_RSH_OMEGA and
+ * PTR_RSH_COEFF; env[PTR_RANGE_OMEGA] is not used.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "cint_bas.h"
+#include "simd.h"
+#include "rys_roots.h"
+#include "misc.h"
+#include "g2e.h"
+#include "optimizer.h"
+#include "cint2e.h"
+#include "cart2sph.h"
+
+#define RSH_NOMEGA_MAX          4
+#define RSH_NGROUP_MAX          (RSH_NOMEGA_MAX*2)
+
+typedef struct {
+        CINTEnvVars envs;
+        int ngroup;
+        int ncomp;
+        // output component of each group
+        int comp[RSH_NGROUP_MAX];
+        // 0 for the full-range kernel, > 0 for the long-range kernel
+        double omega[RSH_NGROUP_MAX];
+        double coeff[RSH_NGROUP_MAX];
+} CINTRshEnvVars;
+
+static int _add_group(CINTRshEnvVars *renvs, int comp, double omega, double coeff,
+                      int merge)
+{
+        int n;
+        if (merge) {
+                for (n = 0; n < renvs->ngroup; n++) {
+                        if (renvs->omega[n] == omega) {
+                                renvs->coeff[n] += coeff;
+                                return 0;
+                        }
+                }
+        }
+        n = renvs->ngroup;
+        renvs->comp[n] = comp;
+        renvs->omega[n] = omega;
+        renvs->coeff[n] = coeff;
+        renvs->ngroup++;
+        return 0;
+}
+
+/*
+ * g of each group: the quadrature of the kernel (omega, coeff) is applied
+ * to g + n * g_size*3*SIMDD
+ */
+static int _g0_2e_rsh(double *g, double *cutoff, Rys2eT *bc, CINTEnvVars *envs, int count)
+{
+        CINTRshEnvVars *renvs = (CINTRshEnvVars *)envs;
+        ALIGNMM double a0[SIMDD];
+        ALIGNMM double a1[SIMDD];
+        ALIGNMM double fac1[SIMDD];
+        ALIGNMM double x[SIMDD];
+        ALIGNMM double xt[SIMDD];
+        ALIGNMM double rijrkl[SIMDD*3];
+        ALIGNMM double rijrx[SIMDD*3];
+        ALIGNMM double rklrx[SIMDD*3];
+        ALIGNMM double u[MXRYSROOTS*SIMDD];
+        double *rij = envs->rij;
+        double *rkl = envs->rkl;
+        size_t gblk = envs->g_size * 3 * SIMDD;
+        int nroots = envs->nrys_roots;
+        double *gx, *gy, *gz, *w;
+        __MD ra, r0, r1, r2, r3, r4, r5, r6, r7, r8;
+        __MD rtheta, rfac;
+        int i, n;
+
+        __MD aij = MM_ADD(MM_LOAD(envs->ai),  MM_LOAD(envs->aj));
+        __MD akl = MM_ADD(MM_LOAD(envs->ak),  MM_LOAD(envs->al));
+        r1 = MM_MUL(aij, akl);
+        MM_STORE(a1, r1);
+        ra = MM_ADD(aij, akl);
+        r0 = MM_DIV(r1, ra);
+        MM_STORE(a0, r0);
+        r0 = MM_DIV(r0, MM_MUL(r1, MM_MUL(r1, r1)));
+        MM_STORE(fac1, MM_MUL(MM_SQRT(r0), MM_LOAD(envs->fac)));
+
+        r0 = MM_LOAD(rij+0*SIMDD);
+        r1 = MM_LOAD(rij+1*SIMDD);
+        r2 = MM_LOAD(rij+2*SIMDD);
+        r3 = MM_LOAD(rkl+0*SIMDD);
+        r4 = MM_LOAD(rkl+1*SIMDD);
+        r5 = MM_LOAD(rkl+2*SIMDD);
+        r6 = MM_SUB(r0, r3); MM_STORE(rijrkl+0*SIMDD, r6);
+        r7 = MM_SUB(r1, r4); MM_STORE(rijrkl+1*SIMDD, r7);
+        r8 = MM_SUB(r2, r5); MM_STORE(rijrkl+2*SIMDD, r8);
+        ra = MM_FMA(r6, r6, MM_FMA(r7, r7, MM_MUL(r8, r8)));
+        MM_STORE(x, MM_MUL(MM_LOAD(a0), ra));
+        MM_STORE(rijrx+0*SIMDD, MM_SUB(r0, MM_SET1(envs->rx_in_rijrx[0])));
+        MM_STORE(rijrx+1*SIMDD, MM_SUB(r1, MM_SET1(envs->rx_in_rijrx[1])));
+        MM_STORE(rijrx+2*SIMDD, MM_SUB(r2, MM_SET1(envs->rx_in_rijrx[2])));
+        MM_STORE(rklrx+0*SIMDD, MM_SUB(r3, MM_SET1(envs->rx_in_rklrx[0])));
+        MM_STORE(rklrx+1*SIMDD, MM_SUB(r4, MM_SET1(envs->rx_in_rklrx[1])));
+        MM_STORE(rklrx+2*SIMDD, MM_SUB(r5, MM_SET1(envs->rx_in_rklrx[2])));
+
+        for (n = 0; n < renvs->ngroup; n++) {
+                gx = g + gblk * n;
+                gy = gx + envs->g_size * SIMDD;
+                gz = gx + envs->g_size * 2 * SIMDD;
+                w = gz;
+                rfac = MM_MUL(MM_LOAD(fac1), MM_SET1(renvs->coeff[n]));
+                if (renvs->omega[n] == 0) {
+                        _CINTrys_roots_batch(nroots, x, u, w, count);
+                } else {
+                        //:theta = omega * omega / (omega * omega + a0);
+                        r0 = MM_SET1(renvs->omega[n] * renvs->omega[n]);
+                        rtheta = MM_DIV(r0, MM_ADD(r0, MM_LOAD(a0)));
+                        MM_STORE(xt, MM_MUL(rtheta, MM_LOAD(x)));
+                        rfac = MM_MUL(rfac, MM_SQRT(rtheta));
+                        _CINTrys_roots_batch(nroots, xt, u, w, count);
+                        r1 = MM_SET1(1.);
+                        for (i = 0; i < nroots; i++) {
+                                r0 = MM_LOAD(u+i*SIMDD);
+                                r2 = r0 * rtheta;
+                                MM_STORE(u+i*SIMDD, MM_DIV(r2, r0+r1-r2));
+                        }
+                }
+
+                r1 = MM_SET1(1.);
+                for (i = 0; i < nroots; i++) {
+                        MM_STORE(gx+i*SIMDD, r1);
+                        MM_STORE(gy+i*SIMDD, r1);
+                        MM_STORE(gz+i*SIMDD, MM_MUL(MM_LOAD(w+i*SIMDD), rfac));
+                }
+                if (envs->g_size == 1) {
+                        continue;
+                }
+
+                double *b00 = bc->b00;
+                double *b10 = bc->b10;
+                double *b01 = bc->b01;
+                double *c00x = bc->c00x;
+                double *c00y = bc->c00y;
+                double *c00z = bc->c00z;
+                double *c0px = bc->c0px;
+                double *c0py = bc->c0py;
+                double *c0pz = bc->c0pz;
+                ra = MM_ADD(aij, akl);
+                r0 = MM_LOAD(a0);
+                r1 = MM_LOAD(a1);
+                r2 = MM_SET1(.5);
+                r3 = MM_SET1(1.);
+                r4 = MM_LOAD(rijrkl+0*SIMDD);
+                r5 = MM_LOAD(rijrkl+1*SIMDD);
+                r6 = MM_LOAD(rijrkl+2*SIMDD);
+                __MD _rijrx = MM_LOAD(rijrx+0*SIMDD);
+                __MD _rijry = MM_LOAD(rijrx+1*SIMDD);
+                __MD _rijrz = MM_LOAD(rijrx+2*SIMDD);
+                __MD _rklrx = MM_LOAD(rklrx+0*SIMDD);
+                __MD _rklry = MM_LOAD(rklrx+1*SIMDD);
+                __MD _rklrz = MM_LOAD(rklrx+2*SIMDD);
+                __MD tmp1, tmp2, tmp3, tmp4, tmp5;
+                for (i = 0; i < nroots; i++) {
+                        tmp1 = MM_MUL(r0, MM_LOAD(u+i*SIMDD));
+                        tmp5 = MM_DIV(r3, MM_FMA(tmp1, ra, r1));
+                        tmp1 = MM_MUL(tmp1, tmp5);
+                        tmp4 = MM_MUL(r2, tmp5);
+                        tmp2 = MM_MUL(r2, tmp1);
+                        MM_STORE(b00+i*SIMDD, tmp2);
+                        MM_STORE(b10+i*SIMDD, MM_FMA(tmp4, akl, tmp2));
+                        MM_STORE(b01+i*SIMDD, MM_FMA(tmp4, aij, tmp2));
+
+                        tmp2 = MM_MUL(tmp1, akl);
+                        tmp3 = MM_MUL(tmp1, aij);
+                        MM_STORE(c00x+i*SIMDD, MM_FNMA(tmp2, r4, _rijrx));
+                        MM_STORE(c00y+i*SIMDD, MM_FNMA(tmp2, r5, _rijry));
+                        MM_STORE(c00z+i*SIMDD, MM_FNMA(tmp2, r6, _rijrz));
+                        MM_STORE(c0px+i*SIMDD, MM_FMA (tmp3, r4, _rklrx));
+                        MM_STORE(c0py+i*SIMDD, MM_FMA (tmp3, r5, _rklry));
+                        MM_STORE(c0pz+i*SIMDD, MM_FMA (tmp3, r6, _rklrz));
+                }
+                (*envs->f_g0_2d4d)(gx, bc, envs);
+        }
+        return 1;
+}
+
+static int _g0_2e_rsh_simd1(double *g, double *cutoff,
+                            Rys2eT *bc, CINTEnvVars *envs, int idsimd)
+{
+        CINTRshEnvVars *renvs = (CINTRshEnvVars *)envs;
+        ALIGNMM double u[MXRYSROOTS];
+        int nroots = envs->nrys_roots;
+        size_t gblk = envs->g_size * 3;
+        double aij = envs->ai[idsimd] + envs->aj[idsimd];
+        double akl = envs->ak[idsimd] + envs->al[idsimd];
+        double *rij = envs->rij;
+        double *rkl = envs->rkl;
+        double xij_kl = rij[0*SIMDD+idsimd] - rkl[0*SIMDD+idsimd];
+        double yij_kl = rij[1*SIMDD+idsimd] - rkl[1*SIMDD+idsimd];
+        double zij_kl = rij[2*SIMDD+idsimd] - rkl[2*SIMDD+idsimd];
+        double rr = xij_kl * xij_kl + yij_kl * yij_kl + zij_kl * zij_kl;
+        double rijrx = rij[0*SIMDD+idsimd] - envs->rx_in_rijrx[0];
+        double rijry = rij[1*SIMDD+idsimd] - envs->rx_in_rijrx[1];
+        double rijrz = rij[2*SIMDD+idsimd] - envs->rx_in_rijrx[2];
+        double rklrx = rkl[0*SIMDD+idsimd] - envs->rx_in_rklrx[0];
+        double rklry = rkl[1*SIMDD+idsimd] - envs->rx_in_rklrx[1];
+        double rklrz = rkl[2*SIMDD+idsimd] - envs->rx_in_rklrx[2];
+        double a1 = aij * akl;
+        double a0 = a1 / (aij + akl);
+        double fac1 = sqrt(a0 / (a1 * a1 * a1)) * envs->fac[idsimd];
+        double x = a0 * rr;
+        double *gx, *gy, *gz, *w;
+        double theta, fac, ut;
+        double u2, tmp1, tmp2, tmp3, tmp4, tmp5;
+        int irys, n;
+
+        for (n = 0; n < renvs->ngroup; n++) {
+                gx = g + gblk * n;
+                gy = gx + envs->g_size;
+                gz = gx + envs->g_size * 2;
+                w = gz;
+                fac = fac1 * renvs->coeff[n];
+                if (renvs->omega[n] == 0) {
+                        CINTrys_roots(nroots, x, u, w);
+                } else {
+                        theta = renvs->omega[n] * renvs->omega[n];
+                        theta = theta / (theta + a0);
+                        fac *= sqrt(theta);
+                        CINTrys_roots(nroots, x * theta, u, w);
+                        for (irys = 0; irys < nroots; irys++) {
+                                ut = u[irys] * theta;
+                                u[irys] = ut / (u[irys]+1.-ut);
+                        }
+                }
+                for (irys = 0; irys < nroots; irys++) {
+                        gx[irys] = 1;
+                        gy[irys] = 1;
+                }
+                if (envs->g_size == 1) {
+                        gz[0] *= fac;
+                        continue;
+                }
+
+                double *b00 = bc->b00;
+                double *b10 = bc->b10;
+                double *b01 = bc->b01;
+                double *c00x = bc->c00x;
+                double *c00y = bc->c00y;
+                double *c00z = bc->c00z;
+                double *c0px = bc->c0px;
+                double *c0py = bc->c0py;
+                double *c0pz = bc->c0pz;
+                for (irys = 0; irys < nroots; irys++) {
+                        u2 = a0 * u[irys];
+                        tmp4 = .5 / (u2 * (aij + akl) + a1);
+                        tmp5 = u2 * tmp4;
+                        tmp1 = 2. * tmp5;
+                        tmp2 = tmp1 * akl;
+                        tmp3 = tmp1 * aij;
+                        b00[irys] = tmp5;
+                        b10[irys] = tmp5 + tmp4 * akl;
+                        b01[irys] = tmp5 + tmp4 * aij;
+                        c00x[irys] = rijrx - tmp2 * xij_kl;
+                        c00y[irys] = rijry - tmp2 * yij_kl;
+                        c00z[irys] = rijrz - tmp2 * zij_kl;
+                        c0px[irys] = rklrx + tmp3 * xij_kl;
+                        c0py[irys] = rklry + tmp3 * yij_kl;
+                        c0pz[irys] = rklrz + tmp3 * zij_kl;
+                        w[irys] *= fac;
+                }
+                (*envs->f_g0_2d4d_simd1)(gx, bc, envs);
+        }
+        return 1;
+}
+
+static void _gout2e_rsh(double *gout, double *g, int *idx, CINTEnvVars *envs)
+{
+        CINTRshEnvVars *renvs = (CINTRshEnvVars *)envs;
+        int nf = envs->nf;
+        int nrys_roots = envs->nrys_roots;
+        int ngroup = renvs->ngroup;
+        int ncomp = renvs->ncomp;
+        int nfc = nf * ncomp;
+        size_t gblk = envs->g_size * 3 * SIMDD;
+        double *gx, *gy, *gz, *hx, *hy, *hz;
+        __MD rs[RSH_NOMEGA_MAX];
+        __MD ss[RSH_NOMEGA_MAX];
+        __MD r0, r1;
+        int i, n, ig, ic;
+        DECLARE_GOUT;
+
+        // two functions at a time to hide the latency of the FMA chains
+        for (n = 0; n < nf-1; n+=2, idx+=6) {
+                for (ic = 0; ic < ncomp; ic++) {
+                        rs[ic] = MM_SET1(0.);
+                        ss[ic] = MM_SET1(0.);
+                }
+                for (ig = 0; ig < ngroup; ig++) {
+                        gx = g + gblk * ig + idx[0] * SIMDD;
+                        gy = g + gblk * ig + idx[1] * SIMDD;
+                        gz = g + gblk * ig + idx[2] * SIMDD;
+                        hx = g + gblk * ig + idx[3] * SIMDD;
+                        hy = g + gblk * ig + idx[4] * SIMDD;
+                        hz = g + gblk * ig + idx[5] * SIMDD;
+                        r0 = MM_LOAD(gx) * MM_LOAD(gy) * MM_LOAD(gz);
+                        r1 = MM_LOAD(hx) * MM_LOAD(hy) * MM_LOAD(hz);
+                        for (i = 1; i < nrys_roots; i++) {
+                                r0 = MM_FMA(MM_LOAD(gx+i*SIMDD) * MM_LOAD(gy+i*SIMDD), MM_LOAD(gz+i*SIMDD), r0);
+                                r1 = MM_FMA(MM_LOAD(hx+i*SIMDD) * MM_LOAD(hy+i*SIMDD), MM_LOAD(hz+i*SIMDD), r1);
+                        }
+                        rs[renvs->comp[ig]] += r0;
+                        ss[renvs->comp[ig]] += r1;
+                }
+                for (ic = 0; ic < ncomp; ic++) {
+                        GOUT_SCATTER(gout, n*ncomp+ic, rs[ic]);
+                        GOUT_SCATTER(gout, (n+1)*ncomp+ic, ss[ic]);
+                }
+        }
+        if (n < nf) {
+                for (ic = 0; ic < ncomp; ic++) {
+                        rs[ic] = MM_SET1(0.);
+                }
+                for (ig = 0; ig < ngroup; ig++) {
+                        gx = g + gblk * ig + idx[0] * SIMDD;
+                        gy = g + gblk * ig + idx[1] * SIMDD;
+                        gz = g + gblk * ig + idx[2] * SIMDD;
+                        r0 = MM_LOAD(gx) * MM_LOAD(gy) * MM_LOAD(gz);
+                        for (i = 1; i < nrys_roots; i++) {
+                                r0 = MM_FMA(MM_LOAD(gx+i*SIMDD) * MM_LOAD(gy+i*SIMDD), MM_LOAD(gz+i*SIMDD), r0);
+                        }
+                        rs[renvs->comp[ig]] += r0;
+                }
+                for (ic = 0; ic < ncomp; ic++) {
+                        GOUT_SCATTER(gout, n*ncomp+ic, rs[ic]);
+                }
+        }
+}
+
+static void _gout2e_rsh_simd1(double *gout, double *g, int *idx, CINTEnvVars *envs)
+{
+        CINTRshEnvVars *renvs = (CINTRshEnvVars *)envs;
+        int nf = envs->nf;
+        int nrys_roots = envs->nrys_roots;
+        int ncomp = renvs->ncomp;
+        size_t gblk = envs->g_size * 3;
+        double *gx, *gy, *gz;
+        double s;
+        int i, n, ig, ic;
+
+        for (n = 0; n < nf; n++) {
+                for (ic = 0; ic < ncomp; ic++) {
+                        gout[n*ncomp+ic] = 0;
+                }
+                for (ig = 0; ig < renvs->ngroup; ig++) {
+                        gx = g + gblk * ig + idx[0+n*3];
+                        gy = g + gblk * ig + idx[1+n*3];
+                        gz = g + gblk * ig + idx[2+n*3];
+                        s = 0;
+                        for (i = 0; i < nrys_roots; i++) {
+                                s += gx[i] * gy[i] * gz[i];
+                        }
+                        gout[n*ncomp+renvs->comp[ig]] += s;
+                }
+        }
+}
+
+/*
+ * env[PTR_RSH_COEFF] == 0: one component for each omega
+ * env[PTR_RSH_COEFF] != 0: sum_n coeffs[n] * (ij|op(omegas[n])|kl) in one
+ *                          component, the quadratures of the same kernel are
+ *                          merged
+ */
+static int _init_rsh_envs(CINTRshEnvVars *renvs, int *shls,
+                          int *atm, int natm, int *bas, int nbas, double *env)
+{
+        double *params = CINTparams_env(env);
+        int nomega = (int)params[NRSH_OMEGA];
+        if (nomega <= 0 || nomega > RSH_NOMEGA_MAX) {
+                fprintf(stderr, "int2e_rsh: env[NRSH_OMEGA] = %d not in [1, %d]\n",
+                        nomega, RSH_NOMEGA_MAX);
+                return -1;
+        }
+        if (params[PTR_RANGE_OMEGA] != 0) {
+                fprintf(stderr, "int2e_rsh: env[PTR_RANGE_OMEGA] must be 0\n");
+                return -1;
+        }
+        double *omegas = env + (size_t)params[PTR_RSH_OMEGA];
+        double *coeffs = NULL;
+        if (params[PTR_RSH_COEFF] != 0) {
+                coeffs = env + (size_t)params[PTR_RSH_COEFF];
+        }
+        int merge = (coeffs != NULL);
+        int n, comp;
+        double c;
+        renvs->ngroup = 0;
+        renvs->ncomp = merge ? 1 : nomega;
+        for (n = 0; n < nomega; n++) {
+                comp = merge ? 0 : n;
+                c = merge ? coeffs[n] : 1.;
+                if (omegas[n] == 0) {
+                        _add_group(renvs, comp, 0., c, merge);
+                } else if (omegas[n] > 0) {
+                        _add_group(renvs, comp, omegas[n], c, merge);
+                } else {
+                        _add_group(renvs, comp, 0., c, merge);
+                        _add_group(renvs, comp, -omegas[n], -c, merge);
+                }
+        }
+
+        // g buffer of CINT2e_loop is g_size*3*((1<<gbits)+1)
+        int gbits = 0;
+        while ((1 << gbits) + 1 < renvs->ngroup) {
+                gbits++;
+        }
+        int ng[] = {0, 0, 0, 0, gbits, 1, 1, renvs->ncomp};
+        CINTEnvVars *envs = &renvs->envs;
+        CINTinit_int2e_EnvVars(envs, ng, shls, atm, natm, bas, nbas, env);
+        envs->f_g0_2e = &_g0_2e_rsh;
+        envs->f_g0_2e_simd1 = &_g0_2e_rsh_simd1;
+        envs->f_gout = &_gout2e_rsh;
+        envs->f_gout_simd1 = &_gout2e_rsh_simd1;
+        if (renvs->ngroup == 1) {
+                // a single quadrature, g has the layout of int2e
+                envs->f_gout = &CINTgout2e;
+                envs->f_gout_simd1 = &CINTgout2e_simd1;
+        }
+        return 0;
+}
+
+CACHE_SIZE_T int2e_rsh_sph(double *out, int *dims, int *shls,
+                           int *atm, int natm, int *bas, int nbas, double *env,
+                           CINTOpt *opt, double *cache)
+{
+        CINTRshEnvVars renvs;
+        if (_init_rsh_envs(&renvs, shls, atm, natm, bas, nbas, env)) {
+                return 0;
+        }
+        return CINT2e_drv(out, dims, &renvs.envs, opt, cache, &c2s_sph_2e1);
+}
+
+CACHE_SIZE_T int2e_rsh_cart(double *out, int *dims, int *shls,
+                            int *atm, int natm, int *bas, int nbas, double *env,
+                            CINTOpt *opt, double *cache)
+{
+        CINTRshEnvVars renvs;
+        if (_init_rsh_envs(&renvs, shls, atm, natm, bas, nbas, env)) {
+                return 0;
+        }
+        return CINT2e_drv(out, dims, &renvs.envs, opt, cache, &c2s_cart_2e1);
+}
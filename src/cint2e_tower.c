@@ -0,0 +1,225 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Derivative tower of ERIs.  The g arrays are generated once with
+ * li_ceil = i_l + order.  The integrals (ij|kl) and all nabla_i
+ * derivatives up to the given order are then evaluated from the same
+ * g arrays, instead of running the Rys quadrature once for int2e,
+ * int2e_ip1, int2e_ipip1, ...
+ *
+ * The components are stored order by order,
+ *      (ij|kl), (nabla_i ij|kl) [3], (nabla_i nabla_i ij|kl) [9], ...
+ * The components of the n-th order block are ordered as the n-fold
+ * product x,y,z (x,y,z (...)), the first nabla runs slowest.  The
+ * second order block is the same as int2e_ipip1.
+ */
+
+#include <stdlib.h>
+#include "cint_bas.h"
+#include "simd.h"
+#include "g2e.h"
+#include "optimizer.h"
+#include "cint2e.h"
+#include "misc.h"
+#include "cart2sph.h"
+#include "c2f.h"
+
+#define TOWER_ORDER_MAX         3
+// 1 + 3 + 9 + 27
+#define TOWER_NCOMP_MAX         40
+
+static int _tower_order(int ncomp)
+{
+        int order = 0;
+        int n = 1;
+        int nblock = 1;
+        while (n < ncomp) {
+                nblock *= 3;
+                n += nblock;
+                order++;
+        }
+        return order;
+}
+
+/*
+ * For each component of the tower, the number of nabla operators acting on
+ * x, y, z.  They select the g arrays of the corresponding derivative order.
+ */
+static int _tower_components(int *nx, int *ny, int *nz, int order)
+{
+        int ncomp = 0;
+        int m, i, c, d, nblock;
+        for (m = 0, nblock = 1; m <= order; m++, nblock *= 3) {
+                for (c = 0; c < nblock; c++, ncomp++) {
+                        nx[ncomp] = 0;
+                        ny[ncomp] = 0;
+                        nz[ncomp] = 0;
+                        for (i = 0, d = c; i < m; i++, d /= 3) {
+                                switch (d % 3) {
+                                case 0: nx[ncomp]++; break;
+                                case 1: ny[ncomp]++; break;
+                                default: nz[ncomp]++;
+                                }
+                        }
+                }
+        }
+        return ncomp;
+}
+
+void CINTgout2e_int2e_tower(double *RESTRICT gout,
+                            double *RESTRICT g, int *RESTRICT idx, CINTEnvVars *envs)
+{
+        int nf = envs->nf;
+        int ncomp = envs->ncomp_tensor;
+        int nfc = nf * ncomp;
+        int nrys_roots = envs->nrys_roots;
+        int order = _tower_order(ncomp);
+        int ix, iy, iz, i, n, c;
+        int nx[TOWER_NCOMP_MAX];
+        int ny[TOWER_NCOMP_MAX];
+        int nz[TOWER_NCOMP_MAX];
+        double *gd[TOWER_ORDER_MAX+1];
+        double *RESTRICT gx;
+        double *RESTRICT gy;
+        double *RESTRICT gz;
+        DECLARE_GOUT;
+        __MD r1;
+
+        _tower_components(nx, ny, nz, order);
+        gd[0] = g;
+        for (i = 1; i <= order; i++) {
+                gd[i] = gd[i-1] + envs->g_size * 3 * SIMDD;
+                G2E_D_I(gd[i], gd[i-1], envs->i_l+order-i,
+                        envs->j_l, envs->k_l, envs->l_l);
+        }
+
+        for (n = 0; n < nf; n++) {
+                ix = idx[0+n*3];
+                iy = idx[1+n*3];
+                iz = idx[2+n*3];
+                for (c = 0; c < ncomp; c++) {
+                        gx = gd[nx[c]] + ix * SIMDD;
+                        gy = gd[ny[c]] + iy * SIMDD;
+                        gz = gd[nz[c]] + iz * SIMDD;
+                        r1 = MM_LOAD(gx) * MM_LOAD(gy) * MM_LOAD(gz);
+                        for (i = 1; i < nrys_roots; i++) {
+                                r1 += MM_LOAD(gx+i*SIMDD) * MM_LOAD(gy+i*SIMDD)
+                                    * MM_LOAD(gz+i*SIMDD);
+                        }
+                        GOUT_SCATTER(gout, n*ncomp+c, r1);
+                }
+        }
+}
+
+void CINTgout2e_int2e_tower_simd1(double *RESTRICT gout,
+                                  double *RESTRICT g, int *RESTRICT idx, CINTEnvVars *envs)
+{
+        int nf = envs->nf;
+        int ncomp = envs->ncomp_tensor;
+        int nrys_roots = envs->nrys_roots;
+        int order = _tower_order(ncomp);
+        int ix, iy, iz, i, n, c;
+        int nx[TOWER_NCOMP_MAX];
+        int ny[TOWER_NCOMP_MAX];
+        int nz[TOWER_NCOMP_MAX];
+        double *gd[TOWER_ORDER_MAX+1];
+        double *RESTRICT gx;
+        double *RESTRICT gy;
+        double *RESTRICT gz;
+        double s;
+
+        _tower_components(nx, ny, nz, order);
+        gd[0] = g;
+        for (i = 1; i <= order; i++) {
+                gd[i] = gd[i-1] + envs->g_size * 3 * SIMDD;
+                G2E_D_I_SIMD1(gd[i], gd[i-1], envs->i_l+order-i,
+                              envs->j_l, envs->k_l, envs->l_l);
+        }
+
+        for (n = 0; n < nf; n++) {
+                ix = idx[0+n*3];
+                iy = idx[1+n*3];
+                iz = idx[2+n*3];
+                for (c = 0; c < ncomp; c++) {
+                        gx = gd[nx[c]] + ix;
+                        gy = gd[ny[c]] + iy;
+                        gz = gd[nz[c]] + iz;
+                        s = 0;
+                        for (i = 0; i < nrys_roots; i++) {
+                                s += gx[i] * gy[i] * gz[i];
+                        }
+                        gout[n*ncomp+c] = s;
+                }
+        }
+}
+
+#define INT2E_TOWER(ORDER, NCOMP) \
+void int2e_tower##ORDER##_optimizer(CINTOpt **opt, int *atm, int natm, \
+                                    int *bas, int nbas, double *env) \
+{ \
+        int ng[] = {ORDER, 0, 0, 0, ORDER, 1, 1, NCOMP}; \
+        CINTall_2e_optimizer(opt, ng, atm, natm, bas, nbas, env); \
+} \
+CACHE_SIZE_T int2e_tower##ORDER##_cart(double *out, int *dims, int *shls, \
+                int *atm, int natm, int *bas, int nbas, double *env, \
+                CINTOpt *opt, double *cache) \
+{ \
+        int ng[] = {ORDER, 0, 0, 0, ORDER, 1, 1, NCOMP}; \
+        CINTEnvVars envs; \
+        CINTinit_int2e_EnvVars(&envs, ng, shls, atm, natm, bas, nbas, env); \
+        envs.f_gout = &CINTgout2e_int2e_tower; \
+        envs.f_gout_simd1 = &CINTgout2e_int2e_tower_simd1; \
+        return CINT2e_drv(out, dims, &envs, opt, cache, &c2s_cart_2e1); \
+} \
+CACHE_SIZE_T int2e_tower##ORDER##_sph(double *out, int *dims, int *shls, \
+                int *atm, int natm, int *bas, int nbas, double *env, \
+                CINTOpt *opt, double *cache) \
+{ \
+        int ng[] = {ORDER, 0, 0, 0, ORDER, 1, 1, NCOMP}; \
+        CINTEnvVars envs; \
+        CINTinit_int2e_EnvVars(&envs, ng, shls, atm, natm, bas, nbas, env); \
+        envs.f_gout = &CINTgout2e_int2e_tower; \
+        envs.f_gout_simd1 = &CINTgout2e_int2e_tower_simd1; \
+        return CINT2e_drv(out, dims, &envs, opt, cache, &c2s_sph_2e1); \
+} \
+CACHE_SIZE_T int2e_tower##ORDER##_spinor(double complex *out, int *dims, int *shls, \
+                int *atm, int natm, int *bas, int nbas, double *env, \
+                CINTOpt *opt, double *cache) \
+{ \
+        int ng[] = {ORDER, 0, 0, 0, ORDER, 1, 1, NCOMP}; \
+        CINTEnvVars envs; \
+        CINTinit_int2e_EnvVars(&envs, ng, shls, atm, natm, bas, nbas, env); \
+        envs.f_gout = &CINTgout2e_int2e_tower; \
+        envs.f_gout_simd1 = &CINTgout2e_int2e_tower_simd1; \
+        return CINT2e_spinor_drv(out, dims, &envs, opt, cache, \
+                                 &c2s_sf_2e1, &c2s_sf_2e2); \
+}
+
+/* (ij|kl), (nabla i j|kl) */
+INT2E_TOWER(1, 4)
+/* (ij|kl), (nabla i j|kl), (nabla nabla i j|kl) */
+INT2E_TOWER(2, 13)
+/* (ij|kl), (nabla i j|kl), (nabla nabla i j|kl), (nabla nabla nabla i j|kl) */
+INT2E_TOWER(3, 40)
+
+ALL_CINT(int2e_tower1)
+ALL_CINT(int2e_tower2)
+ALL_CINT(int2e_tower3)
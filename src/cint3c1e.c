@@ -308,13 +308,10 @@ int CINT3c1e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty)
         int *jempty = _empty + 1;
         int *kempty = _empty + 2;
 
-        int *idx = opt->index_xyz_array[envs->i_l*LMAX1*LMAX1
-                                       +envs->j_l*LMAX1
-                                       +envs->k_l];
-        if (idx == NULL) {
-                MALLOC_DATA_INSTACK(idx, nf * 3);
-                CINTg4c_index_xyz(idx, envs);
-        }
+        int *idx = CINTOpt_index_xyz(opt, envs->i_l*LMAX1*LMAX1
+                                         +envs->j_l*LMAX1
+                                         +envs->k_l,
+                                     &CINTg4c_index_xyz, envs);
 
         int ngp[4];
         ngp[0] = nf * n_comp;
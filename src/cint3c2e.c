@@ -214,7 +214,7 @@ int CINT3c2e_loop_nopt(double *out, CINTEnvVars *envs, double *cache, int *empty
         int *kempty = _empty + 2;
         int empty_overall = 1;
 
-        double omega = env[PTR_RANGE_OMEGA];
+        double omega = envs->params[PTR_RANGE_OMEGA];
         if (omega < 0 && envs->rys_order > 1) {
                 double r_guess = 8.;
                 double omega2 = omega * omega;
@@ -358,6 +358,8 @@ int CINT3c2e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty)
         PairData *pdata_base, *pdata_ij;
         if (opt->pairdata != NULL) {
                 pdata_base = opt->pairdata[i_sh*opt->nbas+j_sh];
+                // angular momentum term of the shared pair data
+                expcutoff += opt->pair_shift[i_sh*opt->nbas+j_sh];
         } else {
                 double *log_maxci = opt->log_max_coeff[i_sh];
                 double *log_maxcj = opt->log_max_coeff[j_sh];
@@ -379,7 +381,7 @@ int CINT3c2e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty)
         int *kempty = _empty + 2;
         int empty_overall = 1;
 
-        double omega = env[PTR_RANGE_OMEGA];
+        double omega = envs->params[PTR_RANGE_OMEGA];
         if (omega < 0 && envs->rys_order > 1) {
                 double r_guess = 8.;
                 double omega2 = omega * omega;
@@ -397,13 +399,10 @@ int CINT3c2e_loop(double *out, CINTEnvVars *envs, double *cache, int *empty)
                 }
         }
 
-        int *idx = opt->index_xyz_array[envs->i_l*LMAX1*LMAX1
-                                       +envs->j_l*LMAX1
-                                       +envs->k_l];
-        if (idx == NULL) {
-                MALLOC_DATA_INSTACK(idx, nf * 3);
-                CINTg4c_index_xyz(idx, envs);
-        }
+        int *idx = CINTOpt_index_xyz(opt, envs->i_l*LMAX1*LMAX1
+                                         +envs->j_l*LMAX1
+                                         +envs->k_l,
+                                     &CINTg4c_index_xyz, envs);
 
         int *non0ctrk, *non0idxk;
         MALLOC_DATA_INSTACK(non0ctrk, k_prim+k_prim*k_ctr);
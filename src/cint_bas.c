@@ -175,6 +175,19 @@ void CINTshells_spinor_offset(int ao_loc[], const int *bas, const int nbas)
         shells_cgto_offset(&CINTcgto_spinor, ao_loc, bas, nbas);
 }
 
+/*
+ * Same to CINTshells_*_offset, but ao_loc has nbas+1 elements and
+ * ao_loc[nbas] is the total number of functions.
+ */
+void CINTshells_cart_loc(int ao_loc[], const int *bas, const int nbas)
+{
+        shells_cgto_offset(&CINTcgto_cart, ao_loc, bas, nbas+1);
+}
+void CINTshells_spheric_loc(int ao_loc[], const int *bas, const int nbas)
+{
+        shells_cgto_offset(&CINTcgto_spheric, ao_loc, bas, nbas+1);
+}
+
 
 /*
  * GTO = x^{nx}y^{ny}z^{nz}e^{-ar^2}
@@ -40,6 +40,8 @@ int CINTtot_cgto_spinor(const int *bas, const int nbas);
 void CINTshells_cart_offset(int ao_loc[], const int *bas, const int nbas);
 void CINTshells_spheric_offset(int ao_loc[], const int *bas, const int nbas);
 void CINTshells_spinor_offset(int ao_loc[], const int *bas, const int nbas);
+void CINTshells_cart_loc(int ao_loc[], const int *bas, const int nbas);
+void CINTshells_spheric_loc(int ao_loc[], const int *bas, const int nbas);
 
 void CINTcart_comp(int *nx, int *ny, int *nz, const int lmax);
 
@@ -0,0 +1,451 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Memory-bounded cache of ERI shell quartets.  A quartet is stored once in
+ * the canonical order ish >= jsh, ksh >= lsh, ij >= kl and transposed to
+ * the requested order when it is read.
+ *
+ * Only the quartets of a high estimated cost per byte are admitted.  The
+ * threshold is chosen such that all of them fit into the memory budget,
+ * see CINTcost_threshold.  The blocks are appended to an arena.  The exact
+ * zeros of a block are dropped and recorded in a bitmap if that is smaller.
+ *
+ * The hash table is open addressed with linear probing.  A slot is claimed
+ * by a CAS of the key and published by a release store of the location of
+ * the block, hence readers never wait.  Entries are not evicted.  The cache
+ * is cleared when the geometry of the optimizer changes, which must not
+ * happen while other threads evaluate integrals (as for
+ * CINTOpt_update_geometry).
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "cint_bas.h"
+#include "misc.h"
+#include "optimizer.h"
+
+CACHE_SIZE_T int2e_sph(double *out, int *dims, int *shls, int *atm, int natm,
+                       int *bas, int nbas, double *env, CINTOpt *opt, double *cache);
+CACHE_SIZE_T int2e_cart(double *out, int *dims, int *shls, int *atm, int natm,
+                        int *bas, int nbas, double *env, CINTOpt *opt, double *cache);
+
+#define CACHE_LINE              64
+#define MIN_SLOTS               1024
+
+typedef struct {
+        uint64_t key;
+        uint64_t loc;   // offset + 1 of the block in the arena, 0 if not ready
+} CacheSlot;
+
+// followed by the bitmap of the nonzero elements if nnz < n, and the
+// nonzero elements
+typedef struct {
+        uint32_t n;
+        uint32_t nnz;
+} BlockHeader;
+
+struct CINTEriCache {
+        CACHE_SIZE_T (*intor)();
+        CINTOpt *opt;
+        int *ao_loc;
+        size_t max_memory;
+        double threshold;
+        CacheSlot *slots;
+        size_t mask;
+        char *arena;
+        size_t arena_size;
+        char pad0[CACHE_LINE];
+        size_t geom_id;
+        char pad1[CACHE_LINE];
+        size_t arena_used;
+        size_t nentry;
+        char pad2[CACHE_LINE];
+        char lock;
+};
+
+// table slots per entry and the block header, included in the cost per byte
+#define ENTRY_OVERHEAD  (sizeof(BlockHeader) + 2 * sizeof(CacheSlot))
+
+static uint64_t _canonical_quartet(int *cshls, int *perm, int *shls)
+{
+        int n, tmp;
+        for (n = 0; n < 4; n++) {
+                cshls[n] = shls[n];
+                perm[n] = n;
+        }
+        if (cshls[0] < cshls[1]) {
+                tmp = cshls[0]; cshls[0] = cshls[1]; cshls[1] = tmp;
+                tmp = perm[0]; perm[0] = perm[1]; perm[1] = tmp;
+        }
+        if (cshls[2] < cshls[3]) {
+                tmp = cshls[2]; cshls[2] = cshls[3]; cshls[3] = tmp;
+                tmp = perm[2]; perm[2] = perm[3]; perm[3] = tmp;
+        }
+        if (cshls[0] < cshls[2] || (cshls[0] == cshls[2] && cshls[1] < cshls[3])) {
+                for (n = 0; n < 2; n++) {
+                        tmp = cshls[n]; cshls[n] = cshls[n+2]; cshls[n+2] = tmp;
+                        tmp = perm[n]; perm[n] = perm[n+2]; perm[n+2] = tmp;
+                }
+        }
+        // shell ids < 0xffff, key 0 marks an empty slot
+        return ((uint64_t)cshls[0] << 48 | (uint64_t)cshls[1] << 32
+              | (uint64_t)cshls[2] << 16 | (uint64_t)cshls[3]) + 1;
+}
+
+static size_t _hash(uint64_t key)
+{
+        key *= 0x9e3779b97f4a7c15uLL;
+        return key ^ (key >> 29);
+}
+
+static CacheSlot *_lookup(CINTEriCache *ec, uint64_t key)
+{
+        size_t pos = _hash(key) & ec->mask;
+        size_t probe;
+        uint64_t k;
+        for (probe = 0; probe <= ec->mask; probe++) {
+                k = __atomic_load_n(&ec->slots[pos].key, __ATOMIC_ACQUIRE);
+                if (k == key) {
+                        return ec->slots + pos;
+                } else if (k == 0) {
+                        return NULL;
+                }
+                pos = (pos + 1) & ec->mask;
+        }
+        return NULL;
+}
+
+/*
+ * Claims a slot for key.  Returns NULL if the key is already stored.
+ */
+static CacheSlot *_claim(CINTEriCache *ec, uint64_t key)
+{
+        size_t pos = _hash(key) & ec->mask;
+        size_t probe;
+        uint64_t k;
+        for (probe = 0; probe <= ec->mask; probe++) {
+                k = __atomic_load_n(&ec->slots[pos].key, __ATOMIC_ACQUIRE);
+                if (k == 0 && __atomic_compare_exchange_n(&ec->slots[pos].key, &k, key, 0,
+                                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                        return ec->slots + pos;
+                }
+                if (k == key) {
+                        return NULL;
+                }
+                pos = (pos + 1) & ec->mask;
+        }
+        return NULL;
+}
+
+static char *_arena_alloc(CINTEriCache *ec, size_t bytes)
+{
+        size_t used = __atomic_load_n(&ec->arena_used, __ATOMIC_RELAXED);
+        do {
+                if (used + bytes > ec->arena_size) {
+                        return NULL;
+                }
+        } while (!__atomic_compare_exchange_n(&ec->arena_used, &used, used + bytes, 1,
+                                              __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+        return ec->arena + used;
+}
+
+/*
+ * The element (i,j,k,l) of the canonical block is located at
+ * i*strides[0] + j*strides[1] + k*strides[2] + l*strides[3] of the output.
+ */
+static void _block_strides(size_t *strides, int *dims, int *shls, int *perm, int *ao_loc)
+{
+        size_t ostrides[4];
+        int n;
+        if (dims == NULL) {
+                ostrides[0] = 1;
+                for (n = 1; n < 4; n++) {
+                        ostrides[n] = ostrides[n-1] * (ao_loc[shls[n-1]+1] - ao_loc[shls[n-1]]);
+                }
+        } else {
+                ostrides[0] = 1;
+                for (n = 1; n < 4; n++) {
+                        ostrides[n] = ostrides[n-1] * dims[n-1];
+                }
+        }
+        for (n = 0; n < 4; n++) {
+                strides[n] = ostrides[perm[n]];
+        }
+}
+
+static void _decode_block(double *out, char *block, int *d, size_t *strides)
+{
+        BlockHeader *header = (BlockHeader *)block;
+        uint64_t *bits = NULL;
+        double *val = (double *)(header + 1);
+        if (header->nnz < header->n) {
+                bits = (uint64_t *)(header + 1);
+                val = (double *)(bits + (header->n + 63) / 64);
+        }
+        size_t n = 0;
+        size_t off;
+        int i, j, k, l;
+        for (l = 0; l < d[3]; l++) {
+        for (k = 0; k < d[2]; k++) {
+        for (j = 0; j < d[1]; j++) {
+                off = l * strides[3] + k * strides[2] + j * strides[1];
+                if (bits == NULL) {
+                        for (i = 0; i < d[0]; i++) {
+                                out[off+i*strides[0]] = *val++;
+                        }
+                } else {
+                        for (i = 0; i < d[0]; i++, n++) {
+                                if ((bits[n>>6] >> (n & 63)) & 1) {
+                                        out[off+i*strides[0]] = *val++;
+                                } else {
+                                        out[off+i*strides[0]] = 0;
+                                }
+                        }
+                }
+        } } }
+}
+
+static size_t _block_nnz(double *out, int *d, size_t *strides)
+{
+        size_t nnz = 0;
+        size_t off;
+        int i, j, k, l;
+        for (l = 0; l < d[3]; l++) {
+        for (k = 0; k < d[2]; k++) {
+        for (j = 0; j < d[1]; j++) {
+                off = l * strides[3] + k * strides[2] + j * strides[1];
+                for (i = 0; i < d[0]; i++) {
+                        nnz += out[off+i*strides[0]] != 0;
+                }
+        } } }
+        return nnz;
+}
+
+static void _encode_block(char *block, double *out, int *d, size_t *strides,
+                          size_t n, size_t nnz)
+{
+        BlockHeader *header = (BlockHeader *)block;
+        uint64_t *bits = NULL;
+        double *val = (double *)(header + 1);
+        header->n = n;
+        header->nnz = nnz;
+        if (nnz < n) {
+                bits = (uint64_t *)(header + 1);
+                memset(bits, 0, sizeof(uint64_t) * ((n + 63) / 64));
+                val = (double *)(bits + (n + 63) / 64);
+        }
+        size_t m = 0;
+        size_t off;
+        double v;
+        int i, j, k, l;
+        for (l = 0; l < d[3]; l++) {
+        for (k = 0; k < d[2]; k++) {
+        for (j = 0; j < d[1]; j++) {
+                off = l * strides[3] + k * strides[2] + j * strides[1];
+                for (i = 0; i < d[0]; i++, m++) {
+                        v = out[off+i*strides[0]];
+                        if (bits == NULL) {
+                                *val++ = v;
+                        } else if (v != 0) {
+                                bits[m>>6] |= 1uLL << (m & 63);
+                                *val++ = v;
+                        }
+                }
+        } } }
+}
+
+static size_t _block_bytes(size_t n, size_t nnz)
+{
+        if (nnz < n) {
+                return sizeof(BlockHeader) + sizeof(uint64_t) * ((n + 63) / 64)
+                        + sizeof(double) * nnz;
+        }
+        return sizeof(BlockHeader) + sizeof(double) * n;
+}
+
+static void _insert(CINTEriCache *ec, uint64_t key, int *cshls, double *out,
+                    int *d, size_t *strides)
+{
+        if (__atomic_load_n(&ec->nentry, __ATOMIC_RELAXED) > ec->mask / 2) {
+                return;
+        }
+        size_t n = (size_t)d[0] * d[1] * d[2] * d[3];
+        double cost = CINTquartet_cost(ec->opt, cshls);
+        if (cost < ec->threshold * (sizeof(double) * n + ENTRY_OVERHEAD)) {
+                return;
+        }
+
+        size_t nnz = _block_nnz(out, d, strides);
+        size_t bytes = _block_bytes(n, nnz);
+        if (bytes > _block_bytes(n, n)) {
+                nnz = n;
+                bytes = _block_bytes(n, n);
+        }
+        char *block = _arena_alloc(ec, bytes);
+        if (block == NULL) {
+                return;
+        }
+        // the arena space is lost if another thread has stored the quartet
+        CacheSlot *slot = _claim(ec, key);
+        if (slot == NULL) {
+                return;
+        }
+        _encode_block(block, out, d, strides, n, nnz);
+        __atomic_store_n(&slot->loc, (uint64_t)(block - ec->arena) + 1, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&ec->nentry, 1, __ATOMIC_RELAXED);
+}
+
+static void _lock_acquire(CINTEriCache *ec)
+{
+        while (__atomic_test_and_set(&ec->lock, __ATOMIC_ACQUIRE)) {
+        }
+}
+static void _lock_release(CINTEriCache *ec)
+{
+        __atomic_clear(&ec->lock, __ATOMIC_RELEASE);
+}
+
+/*
+ * Clears the cache if the geometry of the optimizer has been updated.  The
+ * new geom_id is published after the table is cleared.
+ */
+static void _check_geometry(CINTEriCache *ec)
+{
+        size_t geom_id = ec->opt->basis->geom_id;
+        if (__atomic_load_n(&ec->geom_id, __ATOMIC_ACQUIRE) == geom_id) {
+                return;
+        }
+        _lock_acquire(ec);
+        if (__atomic_load_n(&ec->geom_id, __ATOMIC_ACQUIRE) != geom_id) {
+                size_t nquartets;
+                memset(ec->slots, 0, sizeof(CacheSlot) * (ec->mask + 1));
+                ec->arena_used = 0;
+                ec->nentry = 0;
+                ec->threshold = CINTcost_threshold(&nquartets, ec->opt, ec->ao_loc,
+                                                   ec->max_memory, ENTRY_OVERHEAD);
+                __atomic_store_n(&ec->geom_id, geom_id, __ATOMIC_RELEASE);
+        }
+        _lock_release(ec);
+}
+
+CINTEriCache *CINTeri_cache_create(CACHE_SIZE_T (*intor)(), int *ao_loc,
+                                   size_t max_memory, CINTOpt *opt)
+{
+        // the quartets are folded by the 8-fold symmetry in _canonical_quartet
+        if (intor != (CACHE_SIZE_T (*)())&int2e_sph &&
+            intor != (CACHE_SIZE_T (*)())&int2e_cart) {
+                fprintf(stderr, "CINTeri_cache_create: intor must be int2e_sph or int2e_cart\n");
+                return NULL;
+        }
+        if (opt == NULL || opt->basis == NULL) {
+                fprintf(stderr, "CINTeri_cache_create: opt without basis data\n");
+                return NULL;
+        }
+        int nbas = opt->basis->nbas;
+        if (nbas >= 0xffff) {
+                fprintf(stderr, "CINTeri_cache_create: nbas %d too large\n", nbas);
+                return NULL;
+        }
+        size_t nquartets;
+        double threshold = CINTcost_threshold(&nquartets, opt, ao_loc,
+                                              max_memory, ENTRY_OVERHEAD);
+        // load factor <= 1/2
+        size_t nslot = MIN_SLOTS;
+        while (nslot < nquartets * 2) {
+                nslot *= 2;
+        }
+        while (nslot > MIN_SLOTS && nslot * sizeof(CacheSlot) > max_memory / 2) {
+                nslot /= 2;
+        }
+
+        CINTEriCache *ec = malloc(sizeof(CINTEriCache));
+        ec->intor = intor;
+        ec->opt = opt;
+        ec->max_memory = max_memory;
+        ec->threshold = threshold;
+        ec->mask = nslot - 1;
+        ec->slots = calloc(nslot, sizeof(CacheSlot));
+        ec->arena_size = max_memory - MIN(max_memory, nslot * sizeof(CacheSlot));
+        // pages of the arena are mapped when the blocks are stored
+        ec->arena = malloc(MAX(ec->arena_size, 1));
+        ec->ao_loc = malloc(sizeof(int) * (nbas + 1));
+        if (ec->slots == NULL || ec->arena == NULL || ec->ao_loc == NULL) {
+                fprintf(stderr, "CINTeri_cache_create: failed to allocate %zu bytes\n",
+                        max_memory);
+                CINTeri_cache_del(ec);
+                return NULL;
+        }
+        memcpy(ec->ao_loc, ao_loc, sizeof(int) * (nbas + 1));
+        ec->geom_id = opt->basis->geom_id;
+        ec->arena_used = 0;
+        ec->nentry = 0;
+        ec->lock = 0;
+        return ec;
+}
+
+void CINTeri_cache_del(CINTEriCache *ec)
+{
+        if (ec != NULL) {
+                free(ec->slots);
+                free(ec->arena);
+                free(ec->ao_loc);
+                free(ec);
+        }
+}
+
+CACHE_SIZE_T CINTeri_cache_eval(CINTEriCache *ec, double *out, int *dims, int *shls,
+                                int *atm, int natm, int *bas, int nbas, double *env,
+                                double *cache)
+{
+        CINTOpt *opt = ec->opt;
+        if (out == NULL) {
+                return (*ec->intor)(out, dims, shls, atm, natm, bas, nbas, env,
+                                    opt, cache);
+        }
+        _check_geometry(ec);
+
+        int cshls[4], perm[4], d[4];
+        size_t strides[4];
+        uint64_t key = _canonical_quartet(cshls, perm, shls);
+        int n;
+        for (n = 0; n < 4; n++) {
+                d[n] = ec->ao_loc[cshls[n]+1] - ec->ao_loc[cshls[n]];
+        }
+        _block_strides(strides, dims, shls, perm, ec->ao_loc);
+
+        CacheSlot *slot = _lookup(ec, key);
+        if (slot != NULL) {
+                uint64_t loc = __atomic_load_n(&slot->loc, __ATOMIC_ACQUIRE);
+                if (loc != 0) {
+                        _decode_block(out, ec->arena + loc - 1, d, strides);
+                        return 1;
+                }
+        }
+
+        CACHE_SIZE_T has_value = (*ec->intor)(out, dims, shls, atm, natm, bas, nbas,
+                                              env, opt, cache);
+        if (has_value && slot == NULL) {
+                _insert(ec, key, cshls, out, d, strides);
+        }
+        return has_value;
+}
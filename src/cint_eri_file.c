@@ -0,0 +1,390 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Out-of-core storage of integral shell blocks.
+ *
+ * The file consists of a header, the blocks and the index of the blocks,
+ * one entry per task.  A block holds the output of intor for one task, in
+ * the layout of intor (the components and the functions of the shells).
+ * The blocks are aligned to 64 bytes, a block of doubles is used in place
+ * from the mapping of the file.
+ *
+ * The blocks are written by the consumer of CINTpipeline_eri while the
+ * producers evaluate the next batches.  With a cutoff > 0 the elements
+ * below the cutoff are dropped and a block is stored in float32 if the
+ * rounding errors are below the cutoff.  The dropped elements (and the
+ * exact zeros) are recorded in a bitmap if that is smaller than storing
+ * them.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <float.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cint_bas.h"
+#include "misc.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define ERI_FILE_MAGIC          "QCINTERI"
+#define ERI_FILE_VERSION        1
+#define BLOCK_ALIGN             64
+
+// formats of the blocks
+#define BLOCK_EMPTY             0
+#define BLOCK_F64               1
+#define BLOCK_F32               2
+#define BLOCK_SPARSE            4
+
+typedef struct {
+        char magic[8];
+        uint32_t version;
+        uint32_t ncomp;
+        uint32_t ncenter;
+        uint32_t pad;
+        uint64_t ntask;
+        uint64_t index_offset;
+        double cutoff;
+        char reserved[16];
+} EriFileHeader;
+
+typedef struct {
+        int32_t shls[4];
+        uint32_t format;
+        uint32_t pad;
+        uint64_t n;     // elements of the block
+        uint64_t nnz;   // stored elements
+        uint64_t offset;
+} EriFileEntry;
+
+struct CINTEriFile {
+        char *map;
+        size_t size;
+        EriFileHeader *header;
+        EriFileEntry *index;
+};
+
+typedef struct {
+        FILE *fp;
+        uint64_t offset;
+        int *shls;
+        int *ao_loc;
+        int ncomp;
+        int ncenter;
+        double cutoff;
+        EriFileEntry *index;
+        uint64_t *bits;
+        char *buf;
+        int error;
+} EriFileWriter;
+
+static size_t _block_size(int *shls, int *ao_loc, int ncomp, int ncenter)
+{
+        size_t n = ncomp;
+        int i;
+        for (i = 0; i < ncenter; i++) {
+                n *= ao_loc[shls[i]+1] - ao_loc[shls[i]];
+        }
+        return n;
+}
+
+// exact zeros are always dropped
+static int _kept(double v, double cutoff)
+{
+        return v != 0 && fabs(v) >= cutoff;
+}
+
+static void _write(EriFileWriter *w, void *data, size_t bytes)
+{
+        if (!w->error && bytes > 0 && fwrite(data, 1, bytes, w->fp) != bytes) {
+                w->error = 1;
+        }
+        w->offset += bytes;
+}
+
+static void _write_padding(EriFileWriter *w)
+{
+        static char zeros[BLOCK_ALIGN];
+        size_t pad = (BLOCK_ALIGN - w->offset % BLOCK_ALIGN) % BLOCK_ALIGN;
+        _write(w, zeros, pad);
+}
+
+/*
+ * Digest callback of the pipeline.  There is only one consumer, the blocks
+ * are written sequentially.
+ */
+static void _write_block(double *eri, int *shls, int consumer_id, void *data)
+{
+        EriFileWriter *w = data;
+        size_t task = (shls - w->shls) / 4;
+        EriFileEntry *entry = w->index + task;
+        size_t n = _block_size(shls, w->ao_loc, w->ncomp, w->ncenter);
+        double cutoff = w->cutoff;
+        double vmax = 0;
+        size_t i, nnz = 0;
+        for (i = 0; i < n; i++) {
+                if (_kept(eri[i], cutoff)) {
+                        vmax = MAX(vmax, fabs(eri[i]));
+                        nnz++;
+                }
+        }
+        if (nnz == 0) {
+                // all elements are zero or below the cutoff
+                entry->format = BLOCK_EMPTY;
+                entry->n = n;
+                return;
+        }
+
+        int format = BLOCK_F64;
+        size_t elem_size = sizeof(double);
+        // float32 if the rounding error is below the cutoff
+        if (cutoff > 0 && vmax < FLT_MAX && vmax * (FLT_EPSILON * .5) <= cutoff) {
+                format = BLOCK_F32;
+                elem_size = sizeof(float);
+        }
+        size_t nbits = (n + 63) / 64;
+        if (nnz < n && nbits * sizeof(uint64_t) + nnz * elem_size < n * elem_size) {
+                format |= BLOCK_SPARSE;
+        } else {
+                nnz = n;
+        }
+
+        _write_padding(w);
+        entry->format = format;
+        entry->n = n;
+        entry->nnz = nnz;
+        entry->offset = w->offset;
+
+        if (format == BLOCK_F64) {
+                _write(w, eri, sizeof(double) * n);
+                return;
+        }
+        if (format & BLOCK_SPARSE) {
+                memset(w->bits, 0, sizeof(uint64_t) * nbits);
+                for (i = 0; i < n; i++) {
+                        if (_kept(eri[i], cutoff)) {
+                                w->bits[i>>6] |= 1uLL << (i & 63);
+                        }
+                }
+                _write(w, w->bits, sizeof(uint64_t) * nbits);
+        }
+        size_t m = 0;
+        float *pf = (float *)w->buf;
+        double *pd = (double *)w->buf;
+        for (i = 0; i < n; i++) {
+                if ((format & BLOCK_SPARSE) && !_kept(eri[i], cutoff)) {
+                        continue;
+                }
+                if (format & BLOCK_F32) {
+                        pf[m] = eri[i];
+                } else {
+                        pd[m] = eri[i];
+                }
+                m++;
+        }
+        _write(w, w->buf, elem_size * nnz);
+}
+
+int CINTeri_file_write(const char *path, CACHE_SIZE_T (*intor)(), int ncomp, int ncenter,
+                       int *shls, size_t ntask, int *ao_loc, double cutoff, CINTOpt *opt,
+                       int *atm, int natm, int *bas, int nbas, double *env)
+{
+        if (ncenter < 2 || ncenter > 4 || cutoff < 0) {
+                fprintf(stderr, "CINTeri_file_write: invalid ncenter %d or cutoff %g\n",
+                        ncenter, cutoff);
+                return -1;
+        }
+        EriFileWriter w;
+        w.fp = fopen(path, "wb");
+        if (w.fp == NULL) {
+                fprintf(stderr, "CINTeri_file_write: cannot open %s\n", path);
+                return -1;
+        }
+        size_t t, n;
+        size_t max_size = 1;
+        for (t = 0; t < ntask; t++) {
+                n = _block_size(shls + t * 4, ao_loc, ncomp, ncenter);
+                max_size = MAX(max_size, n);
+        }
+        w.offset = 0;
+        w.shls = shls;
+        w.ao_loc = ao_loc;
+        w.ncomp = ncomp;
+        w.ncenter = ncenter;
+        w.cutoff = cutoff;
+        w.error = 0;
+        w.index = calloc(MAX(ntask, 1), sizeof(EriFileEntry));
+        w.bits = malloc(sizeof(uint64_t) * ((max_size + 63) / 64));
+        w.buf = malloc(sizeof(double) * max_size);
+        if (w.index == NULL || w.bits == NULL || w.buf == NULL) {
+                fprintf(stderr, "CINTeri_file_write: failed to allocate buffers\n");
+                fclose(w.fp);
+                free(w.index);
+                free(w.bits);
+                free(w.buf);
+                return -1;
+        }
+        // screened tasks are not digested by the pipeline
+        for (t = 0; t < ntask; t++) {
+                memcpy(w.index[t].shls, shls + t * 4, sizeof(int) * 4);
+                w.index[t].format = BLOCK_EMPTY;
+                w.index[t].n = _block_size(shls + t * 4, ao_loc, ncomp, ncenter);
+        }
+
+        EriFileHeader header;
+        memset(&header, 0, sizeof(EriFileHeader));
+        memcpy(header.magic, ERI_FILE_MAGIC, 8);
+        header.version = ERI_FILE_VERSION;
+        header.ncomp = ncomp;
+        header.ncenter = ncenter;
+        header.ntask = ntask;
+        header.cutoff = cutoff;
+        // the index offset is updated when all blocks are written
+        _write(&w, &header, sizeof(EriFileHeader));
+
+        int nthreads = 1;
+#ifdef _OPENMP
+        nthreads = omp_get_max_threads();
+#endif
+        int err = CINTpipeline_eri(intor, ncomp, ncenter, shls, ntask, ao_loc, opt,
+                                   _write_block, &w, MAX(nthreads - 1, 1), 1,
+                                   atm, natm, bas, nbas, env);
+
+        _write_padding(&w);
+        header.index_offset = w.offset;
+        _write(&w, w.index, sizeof(EriFileEntry) * ntask);
+        rewind(w.fp);
+        _write(&w, &header, sizeof(EriFileHeader));
+        if (fclose(w.fp) != 0) {
+                w.error = 1;
+        }
+        free(w.index);
+        free(w.bits);
+        free(w.buf);
+        if (err != 0 || w.error) {
+                fprintf(stderr, "CINTeri_file_write: failed to write %s\n", path);
+                return -1;
+        }
+        return 0;
+}
+
+CINTEriFile *CINTeri_file_open(const char *path)
+{
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+                fprintf(stderr, "CINTeri_file_open: cannot open %s\n", path);
+                return NULL;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(EriFileHeader)) {
+                fprintf(stderr, "CINTeri_file_open: %s is not an integral file\n", path);
+                close(fd);
+                return NULL;
+        }
+        size_t size = st.st_size;
+        char *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        // the mapping stays valid after the file is closed
+        close(fd);
+        if (map == MAP_FAILED) {
+                fprintf(stderr, "CINTeri_file_open: failed to map %s\n", path);
+                return NULL;
+        }
+        EriFileHeader *header = (EriFileHeader *)map;
+        if (memcmp(header->magic, ERI_FILE_MAGIC, 8) != 0 ||
+            header->version != ERI_FILE_VERSION ||
+            header->index_offset < sizeof(EriFileHeader) ||
+            header->index_offset + sizeof(EriFileEntry) * header->ntask > size) {
+                fprintf(stderr, "CINTeri_file_open: %s is not an integral file "
+                        "or incomplete\n", path);
+                munmap(map, size);
+                return NULL;
+        }
+        CINTEriFile *f = malloc(sizeof(CINTEriFile));
+        f->map = map;
+        f->size = size;
+        f->header = header;
+        f->index = (EriFileEntry *)(map + header->index_offset);
+        return f;
+}
+
+void CINTeri_file_close(CINTEriFile *f)
+{
+        if (f != NULL) {
+                munmap(f->map, f->size);
+                free(f);
+        }
+}
+
+size_t CINTeri_file_ntask(CINTEriFile *f)
+{
+        return f->header->ntask;
+}
+
+int *CINTeri_file_shls(CINTEriFile *f, size_t task)
+{
+        return f->index[task].shls;
+}
+
+double *CINTeri_file_block(CINTEriFile *f, size_t task)
+{
+        EriFileEntry *entry = f->index + task;
+        if (entry->format != BLOCK_F64) {
+                return NULL;
+        }
+        return (double *)(f->map + entry->offset);
+}
+
+size_t CINTeri_file_read(double *out, CINTEriFile *f, size_t task)
+{
+        EriFileEntry *entry = f->index + task;
+        size_t n = entry->n;
+        size_t i, m;
+        if (entry->format == BLOCK_EMPTY) {
+                memset(out, 0, sizeof(double) * n);
+                return 0;
+        }
+        char *block = f->map + entry->offset;
+        uint64_t *bits = NULL;
+        if (entry->format & BLOCK_SPARSE) {
+                bits = (uint64_t *)block;
+                block += sizeof(uint64_t) * ((n + 63) / 64);
+        }
+        float *pf = (float *)block;
+        double *pd = (double *)block;
+        int f32 = entry->format & BLOCK_F32;
+        for (i = 0, m = 0; i < n; i++) {
+                if (bits != NULL && !((bits[i>>6] >> (i & 63)) & 1)) {
+                        out[i] = 0;
+                } else if (f32) {
+                        out[i] = pf[m++];
+                } else {
+                        out[i] = pd[m++];
+                }
+        }
+        return n;
+}
@@ -0,0 +1,531 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Multipole (far-field) approximation of ERIs.
+ *
+ * The charge distribution of a shell pair is expanded in Cartesian
+ * multipole moments about the pair center C,
+ *      M^a_ij = <i|(x-Cx)^ax (y-Cy)^ay (z-Cz)^az|j>
+ * For two well separated pairs with R = C_ij - C_kl
+ *      (ij|kl) = sum_{a,b} M^a_ij M^b_kl (-1)^|b| / (a! b!) D^{a+b} 1/R
+ * The derivatives of 1/R are generated with the McMurchie-Davidson
+ * recursion in the point charge limit.  The moments are computed with
+ * the 1e machinery, the x^n operators are applied to the overlap g arrays
+ * with CINTx1j_1e.
+ *
+ * The same expansion with a point charge in place of the ket pair gives
+ * the far-field part of the potential matrix of point charges (QM/MM),
+ * see CINTpoint_charges_fock_sph in cint1e_grids.c.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "cint_bas.h"
+#include "misc.h"
+#include "g1e.h"
+#include "optimizer.h"
+#include "cint1e.h"
+#include "cart2sph.h"
+#include "fblas.h"
+
+#define NMOM_MAX        ((MULTIPOLE_ORDER_MAX+1)*(MULTIPOLE_ORDER_MAX+2)*(MULTIPOLE_ORDER_MAX+3)/6)
+
+typedef struct {
+        CINTEnvVars envs;
+        int order;
+        double center[3];
+} CINTMultipoleEnvVars;
+
+int CINTpair_multipole_ncomp(int order)
+{
+        if (order < 0 || order > MULTIPOLE_ORDER_MAX) {
+                return -1;
+        }
+        return (order+1)*(order+2)*(order+3)/6;
+}
+
+/*
+ * Moments are ordered by the total order, then as the Cartesian components
+ * of CINTcart_comp
+ */
+static int _multipole_components(int *nx, int *ny, int *nz, int order)
+{
+        int n;
+        int nmom = 0;
+        for (n = 0; n <= order; n++) {
+                CINTcart_comp(nx+nmom, ny+nmom, nz+nmom, n);
+                nmom += (n+1)*(n+2)/2;
+        }
+        return nmom;
+}
+
+static void _multipole_ng(int *ng, int order)
+{
+        int gbits = 0;
+        // order+1 g arrays are needed
+        while ((1 << gbits) < order) {
+                gbits++;
+        }
+        ng[IINC] = 0;
+        ng[JINC] = order;
+        ng[KINC] = 0;
+        ng[LINC] = 0;
+        ng[GSHIFT] = gbits;
+        ng[POS_E1] = 1;
+        ng[SLOT_RYS_ROOTS] = 1;
+        ng[TENSOR] = CINTpair_multipole_ncomp(order);
+}
+
+static void gout1e_pair_multipole(double *gout, double *g, int *idx,
+                                  CINTEnvVars *envs, int count)
+{
+        CINTMultipoleEnvVars *menvs = (CINTMultipoleEnvVars *)envs;
+        int order = menvs->order;
+        int nf = envs->nf;
+        int ncomp = envs->ncomp_tensor;
+        int nfc = nf * ncomp;
+        int i_l = envs->i_l;
+        int j_l = envs->j_l;
+        int ix, iy, iz, i, n, c;
+        int nx[NMOM_MAX];
+        int ny[NMOM_MAX];
+        int nz[NMOM_MAX];
+        double *gm[MULTIPOLE_ORDER_MAX+1];
+        double drj[3];
+        DECLARE_GOUT;
+        __MD r1;
+
+        _multipole_components(nx, ny, nz, order);
+        drj[0] = envs->rj[0] - menvs->center[0];
+        drj[1] = envs->rj[1] - menvs->center[1];
+        drj[2] = envs->rj[2] - menvs->center[2];
+        CINTg1e_ovlp(g, envs, count);
+        gm[0] = g;
+        for (i = 1; i <= order; i++) {
+                gm[i] = gm[i-1] + envs->g_size * 3 * SIMDD;
+                G1E_RCJ(gm[i], gm[i-1], i_l, j_l+order-i, 0);
+        }
+
+        for (n = 0; n < nf; n++) {
+                ix = idx[0+n*3] * SIMDD;
+                iy = idx[1+n*3] * SIMDD;
+                iz = idx[2+n*3] * SIMDD;
+                for (c = 0; c < ncomp; c++) {
+                        r1 = MM_LOAD(gm[nx[c]]+ix) * MM_LOAD(gm[ny[c]]+iy)
+                           * MM_LOAD(gm[nz[c]]+iz);
+                        GOUT_SCATTER(gout, n*ncomp+c, r1);
+                }
+        }
+}
+
+static int _init_multipole_envs(CINTMultipoleEnvVars *menvs, int order, double *center,
+                                int *shls, int *atm, int natm,
+                                int *bas, int nbas, double *env)
+{
+        int ng[8];
+        if (order < 0 || order > MULTIPOLE_ORDER_MAX) {
+                return -1;
+        }
+        _multipole_ng(ng, order);
+        CINTinit_int1e_EnvVars(&menvs->envs, ng, shls, atm, natm, bas, nbas, env);
+        menvs->envs.f_gout = &gout1e_pair_multipole;
+        menvs->order = order;
+        if (center != NULL) {
+                menvs->center[0] = center[0];
+                menvs->center[1] = center[1];
+                menvs->center[2] = center[2];
+        }
+        return 0;
+}
+
+void int1e_pair_multipole_optimizer(CINTOpt **opt, int order, int *atm, int natm,
+                                    int *bas, int nbas, double *env)
+{
+        int ng[8];
+        if (order < 0 || order > MULTIPOLE_ORDER_MAX) {
+                *opt = NULL;
+                return;
+        }
+        _multipole_ng(ng, order);
+        CINTall_1e_optimizer(opt, ng, atm, natm, bas, nbas, env);
+}
+
+CACHE_SIZE_T int1e_pair_multipole_cart(double *out, int *dims, int order, double *center,
+                                       int *shls, int *atm, int natm,
+                                       int *bas, int nbas, double *env,
+                                       CINTOpt *opt, double *cache)
+{
+        CINTMultipoleEnvVars menvs;
+        if (_init_multipole_envs(&menvs, order, center, shls,
+                                 atm, natm, bas, nbas, env)) {
+                return 0;
+        }
+        return CINT1e_drv(out, dims, &menvs.envs, opt, cache, &c2s_cart_1e);
+}
+
+CACHE_SIZE_T int1e_pair_multipole_sph(double *out, int *dims, int order, double *center,
+                                      int *shls, int *atm, int natm,
+                                      int *bas, int nbas, double *env,
+                                      CINTOpt *opt, double *cache)
+{
+        CINTMultipoleEnvVars menvs;
+        if (_init_multipole_envs(&menvs, order, center, shls,
+                                 atm, natm, bas, nbas, env)) {
+                return 0;
+        }
+        return CINT1e_drv(out, dims, &menvs.envs, opt, cache, &c2s_sph_1e);
+}
+
+/*
+ * The center of the pair is the Gaussian product center of the most
+ * diffuse primitive pair.  The extent is the radius around the center
+ * beyond which the absolute value of the pair density of every primitive
+ * pair is smaller than eps.  size is an upper bound of the integrated
+ * absolute value of the pair density.  spread is the largest distance
+ * between the center and the product centers of the primitive pairs.
+ */
+double CINTpair_extent_bounds(double *center, double *size, double *spread,
+                              double eps, int *shls,
+                              int *atm, int natm, int *bas, int nbas, double *env)
+{
+        int i_sh = shls[0];
+        int j_sh = shls[1];
+        int li = bas(ANG_OF, i_sh);
+        int lj = bas(ANG_OF, j_sh);
+        int i_prim = bas(NPRIM_OF, i_sh);
+        int j_prim = bas(NPRIM_OF, j_sh);
+        int i_ctr = bas(NCTR_OF, i_sh);
+        int j_ctr = bas(NCTR_OF, j_sh);
+        double *ai = env + bas(PTR_EXP, i_sh);
+        double *aj = env + bas(PTR_EXP, j_sh);
+        double *ci = env + bas(PTR_COEFF, i_sh);
+        double *cj = env + bas(PTR_COEFF, j_sh);
+        double *ri = env + atm(PTR_COORD, bas(ATOM_OF, i_sh));
+        double *rj = env + atm(PTR_COORD, bas(ATOM_OF, j_sh));
+        double rr_ij = CINTsquare_dist(ri, rj);
+        double log_eps = log(eps);
+        double ai_min = ai[0];
+        double aj_min = aj[0];
+        double cimax[i_prim];
+        double cjmax[j_prim];
+        double extent = 0;
+        double aij, eij, logk, r, d, dp, rp[3];
+        int ip, jp, n, iter;
+
+        for (ip = 0; ip < i_prim; ip++) {
+                ai_min = MIN(ai_min, ai[ip]);
+                cimax[ip] = 0;
+                for (n = 0; n < i_ctr; n++) {
+                        cimax[ip] = MAX(cimax[ip], fabs(ci[ip+i_prim*n]));
+                }
+        }
+        for (jp = 0; jp < j_prim; jp++) {
+                aj_min = MIN(aj_min, aj[jp]);
+                cjmax[jp] = 0;
+                for (n = 0; n < j_ctr; n++) {
+                        cjmax[jp] = MAX(cjmax[jp], fabs(cj[jp+j_prim*n]));
+                }
+        }
+        aij = ai_min + aj_min;
+        center[0] = (ai_min * ri[0] + aj_min * rj[0]) / aij;
+        center[1] = (ai_min * ri[1] + aj_min * rj[1]) / aij;
+        center[2] = (ai_min * ri[2] + aj_min * rj[2]) / aij;
+
+        *size = 0;
+        *spread = 0;
+        for (jp = 0; jp < j_prim; jp++) {
+        for (ip = 0; ip < i_prim; ip++) {
+                aij = ai[ip] + aj[jp];
+                eij = ai[ip] * aj[jp] / aij * rr_ij;
+                logk = log(cimax[ip] * cjmax[jp] + 1e-300) - eij;
+                if (logk < log_eps) {
+                        continue;
+                }
+                rp[0] = (ai[ip] * ri[0] + aj[jp] * rj[0]) / aij;
+                rp[1] = (ai[ip] * ri[1] + aj[jp] * rj[1]) / aij;
+                rp[2] = (ai[ip] * ri[2] + aj[jp] * rj[2]) / aij;
+                // distance to the farther nucleus, for the polynomial part
+                d = sqrt(MAX(CINTsquare_dist(rp, ri), CINTsquare_dist(rp, rj)));
+                r = sqrt((logk - log_eps) / aij);
+                for (iter = 0; iter < 3; iter++) {
+                        r = sqrt((logk - log_eps + (li+lj) * log(MAX(r+d, 1.))) / aij);
+                }
+                dp = sqrt(CINTsquare_dist(rp, center));
+                extent = MAX(extent, dp + r);
+                *spread = MAX(*spread, dp);
+                *size += exp(logk) * pow(M_PI/aij, 1.5) * pow(MAX(r+d, 1.), li+lj)
+                        * i_ctr * j_ctr;
+        } }
+        return extent;
+}
+
+double CINTpair_extent(double *center, double eps, int *shls,
+                       int *atm, int natm, int *bas, int nbas, double *env)
+{
+        double size, spread;
+        return CINTpair_extent_bounds(center, &size, &spread, eps, shls,
+                                      atm, natm, bas, nbas, env);
+}
+
+/*
+ * Outside of its extent, the potential of a primitive pair is exactly the
+ * potential of point multipoles up to order li+lj at the product center.
+ * A quartet is far if the two pair densities do not overlap (up to eps)
+ * and the truncation error of the expansion about the pair centers,
+ *      size_ij size_kl / (R - a) * (a / R)^(order+1-li-lj-lk-ll)
+ * is smaller than eps.  a is the sum of the spreads of the two pairs.
+ */
+int CINTquartet_is_far(int order, double eps, int *shls,
+                       int *atm, int natm, int *bas, int nbas, double *env)
+{
+        int lsum = bas(ANG_OF, shls[0]) + bas(ANG_OF, shls[1])
+                 + bas(ANG_OF, shls[2]) + bas(ANG_OF, shls[3]);
+        if (order < lsum || order > MULTIPOLE_ORDER_MAX) {
+                return 0;
+        }
+        double cij[3], ckl[3];
+        double sij, skl, aij, akl;
+        double eij = CINTpair_extent_bounds(cij, &sij, &aij, eps, shls  ,
+                                            atm, natm, bas, nbas, env);
+        double ekl = CINTpair_extent_bounds(ckl, &skl, &akl, eps, shls+2,
+                                            atm, natm, bas, nbas, env);
+        double r = sqrt(CINTsquare_dist(cij, ckl));
+        double a = aij + akl;
+        if (r <= eij + ekl) {
+                return 0;
+        }
+        return sij * skl / (r - a) * pow(a / r, order + 1 - lsum) < eps;
+}
+
+/*
+ * D^{tuv} 1/|R| for t+u+v <= order.  r[n][t][u][v] are the Hermite
+ * Coulomb integrals of McMurchie-Davidson in the point charge limit,
+ *      r[n][0][0][0] = (-1)^n (2n-1)!! / |R|^(2n+1)
+ *      r[n][t+1][u][v] = t r[n+1][t-1][u][v] + X r[n+1][t][u][v]
+ */
+#define L1      (MULTIPOLE_ORDER_MAX+1)
+static void _coulomb_derivatives(double r[L1][L1][L1][L1], double *rpq, int order)
+{
+        double r2 = rpq[0]*rpq[0] + rpq[1]*rpq[1] + rpq[2]*rpq[2];
+        double rinv = 1 / sqrt(r2);
+        double rinv2 = rinv * rinv;
+        double fac = rinv;
+        int n, t, u, v, l;
+
+        for (n = 0; n <= order; n++) {
+                r[n][0][0][0] = fac;
+                fac *= -(2*n+1) * rinv2;
+        }
+        for (n = order-1; n >= 0; n--) {
+                for (l = 1; l <= order-n; l++) {
+                for (t = l; t >= 0; t--) {
+                for (u = l-t; u >= 0; u--) {
+                        v = l - t - u;
+                        if (t > 0) {
+                                r[n][t][u][v] = rpq[0] * r[n+1][t-1][u][v];
+                                if (t > 1) {
+                                        r[n][t][u][v] += (t-1) * r[n+1][t-2][u][v];
+                                }
+                        } else if (u > 0) {
+                                r[n][t][u][v] = rpq[1] * r[n+1][t][u-1][v];
+                                if (u > 1) {
+                                        r[n][t][u][v] += (u-1) * r[n+1][t][u-2][v];
+                                }
+                        } else {
+                                r[n][t][u][v] = rpq[2] * r[n+1][t][u][v-1];
+                                if (v > 1) {
+                                        r[n][t][u][v] += (v-1) * r[n+1][t][u][v-2];
+                                }
+                        }
+                } } }
+        }
+}
+
+/*
+ * Contract the multipole moments of two pairs to the ERIs
+ * out[ij,kl] = sum_{ab} mij[ij,a] T[a,b] mkl[kl,b].  The expansion is
+ * truncated at |a|+|b| <= order.  mij and mkl are the outputs of
+ * int1e_pair_multipole_* (nij and nkl functions, moments run slowest).
+ * buf needs nmom*(nmom+nij) doubles.
+ */
+void CINTmultipole_eri(double *out, int nij, int nkl, int order,
+                       double *mij, double *cij, double *mkl, double *ckl,
+                       double *buf)
+{
+        int nmom = CINTpair_multipole_ncomp(order);
+        if (nmom < 0) {
+                return;
+        }
+        int nx[NMOM_MAX];
+        int ny[NMOM_MAX];
+        int nz[NMOM_MAX];
+        double fact[L1];
+        double r[L1][L1][L1][L1];
+        double rpq[3];
+        double *tab = buf;
+        double *w = tab + nmom * nmom;
+        int a, b, n, la, lb;
+        double s;
+
+        _multipole_components(nx, ny, nz, order);
+        fact[0] = 1;
+        for (n = 1; n <= order; n++) {
+                fact[n] = fact[n-1] * n;
+        }
+        rpq[0] = cij[0] - ckl[0];
+        rpq[1] = cij[1] - ckl[1];
+        rpq[2] = cij[2] - ckl[2];
+        _coulomb_derivatives(r, rpq, order);
+
+        for (b = 0; b < nmom; b++) {
+                lb = nx[b] + ny[b] + nz[b];
+                s = (lb & 1) ? -1 : 1;
+                s /= fact[nx[b]] * fact[ny[b]] * fact[nz[b]];
+                for (a = 0; a < nmom; a++) {
+                        la = nx[a] + ny[a] + nz[a];
+                        if (la + lb > order) {
+                                tab[a+nmom*b] = 0;
+                        } else {
+                                tab[a+nmom*b] = s / (fact[nx[a]] * fact[ny[a]] * fact[nz[a]])
+                                        * r[0][nx[a]+nx[b]][ny[a]+ny[b]][nz[a]+nz[b]];
+                        }
+                }
+        }
+        CINTdgemm_NN(nij, nmom, nmom, mij, tab, w);
+        CINTdgemm_NT(nij, nkl, nmom, w, mkl, out);
+}
+
+static CACHE_SIZE_T _int2e_far(double *out, int *dims, int order, int *shls,
+                               int *atm, int natm, int *bas, int nbas, double *env,
+                               double *cache, int is_cart)
+{
+        CACHE_SIZE_T (*intor)() = is_cart ? &int1e_pair_multipole_cart
+                                          : &int1e_pair_multipole_sph;
+        int (*f_cgto)() = is_cart ? &CINTcgto_cart : &CINTcgto_spheric;
+        int nmom = CINTpair_multipole_ncomp(order);
+        if (nmom < 0) {
+                return 0;
+        }
+        int di = (*f_cgto)(shls[0], bas);
+        int dj = (*f_cgto)(shls[1], bas);
+        int dk = (*f_cgto)(shls[2], bas);
+        int dl = (*f_cgto)(shls[3], bas);
+        int nij = di * dj;
+        int nkl = dk * dl;
+        CACHE_SIZE_T cache_size = MAX((*intor)(NULL, NULL, order, NULL, shls,
+                                               atm, natm, bas, nbas, env, NULL, NULL),
+                                      (*intor)(NULL, NULL, order, NULL, shls+2,
+                                               atm, natm, bas, nbas, env, NULL, NULL));
+        cache_size += (nij + nkl) * nmom + nmom * (nmom + nij) + nij * nkl + SIMDD*4;
+        if (out == NULL) {
+                return cache_size;
+        }
+        double *stack = NULL;
+        if (cache == NULL) {
+                stack = _mm_malloc(sizeof(double)*cache_size, sizeof(double)*SIMDD);
+                cache = stack;
+        }
+        double *mij, *mkl, *buf, *eri;
+        MALLOC_INSTACK(mij, nij * nmom);
+        MALLOC_INSTACK(mkl, nkl * nmom);
+        MALLOC_INSTACK(eri, nij * nkl);
+        MALLOC_INSTACK(buf, nmom * (nmom + nij));
+
+        double cij[3], ckl[3];
+        double eps = exp(-(env[PTR_EXPCUTOFF] == 0 ? EXPCUTOFF : env[PTR_EXPCUTOFF]));
+        CINTpair_extent(cij, eps, shls  , atm, natm, bas, nbas, env);
+        CINTpair_extent(ckl, eps, shls+2, atm, natm, bas, nbas, env);
+        (*intor)(mij, NULL, order, cij, shls  , atm, natm, bas, nbas, env, NULL, cache);
+        (*intor)(mkl, NULL, order, ckl, shls+2, atm, natm, bas, nbas, env, NULL, cache);
+        CINTmultipole_eri(eri, nij, nkl, order, mij, cij, mkl, ckl, buf);
+
+        int counts[4];
+        if (dims == NULL) {
+                dims = counts;
+                counts[0] = di;
+                counts[1] = dj;
+                counts[2] = dk;
+                counts[3] = dl;
+        }
+        size_t d01 = (size_t)dims[0] * dims[1];
+        size_t d012 = d01 * dims[2];
+        int i, j, k, l;
+        for (l = 0; l < dl; l++) {
+        for (k = 0; k < dk; k++) {
+        for (j = 0; j < dj; j++) {
+        for (i = 0; i < di; i++) {
+                out[i + dims[0]*j + d01*k + d012*l] = eri[i + di*j + nij*(k + dk*l)];
+        } } } }
+
+        if (stack != NULL) {
+                free(stack);
+        }
+        return 1;
+}
+
+CACHE_SIZE_T int2e_far_cart(double *out, int *dims, int order, int *shls,
+                            int *atm, int natm, int *bas, int nbas, double *env,
+                            double *cache)
+{
+        return _int2e_far(out, dims, order, shls, atm, natm, bas, nbas, env, cache, 1);
+}
+
+CACHE_SIZE_T int2e_far_sph(double *out, int *dims, int order, int *shls,
+                           int *atm, int natm, int *bas, int nbas, double *env,
+                           double *cache)
+{
+        return _int2e_far(out, dims, order, shls, atm, natm, bas, nbas, env, cache, 0);
+}
+
+/*
+ * phi[a] += sum_g q_g D^a 1/|C-R_g| / a! for |a| <= order.  Contracted with
+ * the moments of a shell pair about C, it gives the potential of the point
+ * charges q_g at R_g in the far field of the pair.
+ */
+void CINTmultipole_potential(double *phi, int order, double *center,
+                             double *coords, double *q, int n)
+{
+        int nx[NMOM_MAX];
+        int ny[NMOM_MAX];
+        int nz[NMOM_MAX];
+        double fact[L1];
+        double r[L1][L1][L1][L1];
+        double rpq[3];
+        int nmom = _multipole_components(nx, ny, nz, order);
+        int a, g;
+        fact[0] = 1;
+        for (a = 1; a <= order; a++) {
+                fact[a] = fact[a-1] * a;
+        }
+        for (g = 0; g < n; g++) {
+                if (q[g] == 0) {
+                        continue;
+                }
+                rpq[0] = center[0] - coords[g*3+0];
+                rpq[1] = center[1] - coords[g*3+1];
+                rpq[2] = center[2] - coords[g*3+2];
+                _coulomb_derivatives(r, rpq, order);
+                for (a = 0; a < nmom; a++) {
+                        phi[a] += q[g] * r[0][nx[a]][ny[a]][nz[a]]
+                                / (fact[nx[a]] * fact[ny[a]] * fact[nz[a]]);
+                }
+        }
+}
@@ -0,0 +1,110 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Per-call operator parameters.  The global parameters env[0:PTR_ENV_START]
+ * are read through envs->params by the integral kernels.  envs->params
+ * points to env unless the integral is evaluated by CINTcall_with_params,
+ * which places a private copy of the header with the overridden operator
+ * parameters in a thread-local slot.  The CINTinit_*_EnvVars functions pick
+ * it up, so env is never modified and different threads can evaluate
+ * different operators on the same env concurrently.
+ */
+
+#include <string.h>
+#include "cint_bas.h"
+#include "misc.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define THREAD_LOCAL    _Thread_local
+#elif defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+#define THREAD_LOCAL    __thread
+#else
+#error "CINTcall_with_params requires thread-local storage"
+#endif
+
+typedef struct {
+        double header[PTR_ENV_START];
+        double *grids;
+} CINTParamsEnv;
+
+static THREAD_LOCAL CINTParamsEnv *_params_env = NULL;
+
+double *CINTparams_env(double *env)
+{
+        if (_params_env == NULL) {
+                return env;
+        }
+        return _params_env->header;
+}
+
+/*
+ * grids of int1e_grids starting from the grid index start
+ */
+double *CINTparams_grids(double *env, int start)
+{
+        if (_params_env == NULL || _params_env->grids == NULL) {
+                return env + (size_t)env[PTR_GRIDS] + start * 3;
+        }
+        return _params_env->grids + start * 3;
+}
+
+void CINTinit_op_params(CINTOpParams *params, double *env)
+{
+        params->common_orig[0] = env[PTR_COMMON_ORIG+0];
+        params->common_orig[1] = env[PTR_COMMON_ORIG+1];
+        params->common_orig[2] = env[PTR_COMMON_ORIG+2];
+        params->rinv_orig[0] = env[PTR_RINV_ORIG+0];
+        params->rinv_orig[1] = env[PTR_RINV_ORIG+1];
+        params->rinv_orig[2] = env[PTR_RINV_ORIG+2];
+        params->rinv_zeta = env[PTR_RINV_ZETA];
+        params->range_omega = env[PTR_RANGE_OMEGA];
+        params->f12_zeta = env[PTR_F12_ZETA];
+        params->gtg_zeta = env[PTR_GTG_ZETA];
+        params->grids = NULL;
+}
+
+CACHE_SIZE_T CINTcall_with_params(CACHE_SIZE_T (*intor)(), CINTOpParams *params,
+                                  double *out, int *dims, int *shls,
+                                  int *atm, int natm, int *bas, int nbas, double *env,
+                                  CINTOpt *opt, double *cache)
+{
+        CINTParamsEnv penv;
+        memcpy(penv.header, CINTparams_env(env), sizeof(double) * PTR_ENV_START);
+        penv.header[PTR_COMMON_ORIG+0] = params->common_orig[0];
+        penv.header[PTR_COMMON_ORIG+1] = params->common_orig[1];
+        penv.header[PTR_COMMON_ORIG+2] = params->common_orig[2];
+        penv.header[PTR_RINV_ORIG+0] = params->rinv_orig[0];
+        penv.header[PTR_RINV_ORIG+1] = params->rinv_orig[1];
+        penv.header[PTR_RINV_ORIG+2] = params->rinv_orig[2];
+        penv.header[PTR_RINV_ZETA] = params->rinv_zeta;
+        penv.header[PTR_RANGE_OMEGA] = params->range_omega;
+        penv.header[PTR_F12_ZETA] = params->f12_zeta;
+        penv.header[PTR_GTG_ZETA] = params->gtg_zeta;
+        penv.grids = params->grids;
+
+        // restored on return, calls can be nested
+        CINTParamsEnv *saved = _params_env;
+        _params_env = &penv;
+        CACHE_SIZE_T val = (*intor)(out, dims, shls, atm, natm, bas, nbas,
+                                    env, opt, cache);
+        _params_env = saved;
+        return val;
+}
@@ -0,0 +1,354 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Producer/consumer pipeline for integral-direct methods.  Producer
+ * threads evaluate the integrals of a list of shell quartets into batches
+ * and consumer threads digest the batches with a callback while the next
+ * batches are computed.  The batches are taken from a fixed pool and
+ * passed through two bounded lock-free MPMC queues (free and ready).  A
+ * producer waits for a free batch when all of them are in flight, which
+ * bounds the memory and throttles the producers to the speed of the
+ * consumers.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sched.h>
+#include "cint_bas.h"
+#include "simd.h"
+#include "misc.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// doubles in one batch, enlarged if a single quartet does not fit
+#define PIPELINE_BATCH_SIZE     32768
+#define PIPELINE_BATCH_TASKS    512
+#define CACHE_LINE              64
+
+typedef struct {
+        double *data;
+        size_t size;
+        int ntask;
+        size_t task[PIPELINE_BATCH_TASKS];
+        size_t loc[PIPELINE_BATCH_TASKS];
+} CINTBatch;
+
+typedef struct {
+        size_t seq;
+        CINTBatch *batch;
+} QueueCell;
+
+// Bounded MPMC queue, see D. Vyukov, "Bounded MPMC queue".  The position
+// counters are kept on separate cache lines.
+typedef struct {
+        QueueCell *cells;
+        size_t mask;
+        char pad0[CACHE_LINE];
+        size_t head;
+        char pad1[CACHE_LINE];
+        size_t tail;
+        char pad2[CACHE_LINE];
+} BatchQueue;
+
+static void _queue_init(BatchQueue *q, int n)
+{
+        size_t size = 1;
+        size_t i;
+        while (size < (size_t)n) {
+                size *= 2;
+        }
+        q->cells = malloc(sizeof(QueueCell) * size);
+        q->mask = size - 1;
+        for (i = 0; i < size; i++) {
+                q->cells[i].seq = i;
+        }
+        q->head = 0;
+        q->tail = 0;
+}
+
+static int _queue_push(BatchQueue *q, CINTBatch *batch)
+{
+        size_t pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+        QueueCell *cell;
+        intptr_t dif;
+        while (1) {
+                cell = q->cells + (pos & q->mask);
+                dif = (intptr_t)__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (intptr_t)pos;
+                if (dif == 0) {
+                        if (__atomic_compare_exchange_n(&q->head, &pos, pos + 1, 1,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                                break;
+                        }
+                } else if (dif < 0) {
+                        return 0;
+                } else {
+                        pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+                }
+        }
+        cell->batch = batch;
+        __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+        return 1;
+}
+
+static CINTBatch *_queue_pop(BatchQueue *q)
+{
+        size_t pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+        QueueCell *cell;
+        intptr_t dif;
+        while (1) {
+                cell = q->cells + (pos & q->mask);
+                dif = (intptr_t)__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (intptr_t)(pos + 1);
+                if (dif == 0) {
+                        if (__atomic_compare_exchange_n(&q->tail, &pos, pos + 1, 1,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                                break;
+                        }
+                } else if (dif < 0) {
+                        return NULL;
+                } else {
+                        pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+                }
+        }
+        CINTBatch *batch = cell->batch;
+        __atomic_store_n(&cell->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+        return batch;
+}
+
+typedef struct {
+        CACHE_SIZE_T (*intor)();
+        int ncomp;
+        int ncenter;
+        int *shls;
+        size_t ntask;
+        int *ao_loc;
+        CINTOpt *opt;
+        int *atm;
+        int natm;
+        int *bas;
+        int nbas;
+        double *env;
+        void (*digest)(double *eri, int *shls, int consumer_id, void *data);
+        void *data;
+        size_t batch_size;
+        CACHE_SIZE_T cache_size;
+        BatchQueue free_batches;
+        BatchQueue ready_batches;
+        char pad0[CACHE_LINE];
+        size_t next_task;
+        char pad1[CACHE_LINE];
+        int producers_done;
+} CINTPipeline;
+
+static size_t _task_size(CINTPipeline *pl, int *shls)
+{
+        int *ao_loc = pl->ao_loc;
+        size_t size = pl->ncomp;
+        int n;
+        for (n = 0; n < pl->ncenter; n++) {
+                size *= ao_loc[shls[n]+1] - ao_loc[shls[n]];
+        }
+        return size;
+}
+
+static void _digest_batch(CINTPipeline *pl, CINTBatch *batch, int consumer_id)
+{
+        int n;
+        for (n = 0; n < batch->ntask; n++) {
+                (*pl->digest)(batch->data + batch->loc[n],
+                              pl->shls + batch->task[n] * 4, consumer_id, pl->data);
+        }
+        batch->ntask = 0;
+        batch->size = 0;
+}
+
+static CINTBatch *_wait_free_batch(CINTPipeline *pl)
+{
+        CINTBatch *batch;
+        while ((batch = _queue_pop(&pl->free_batches)) == NULL) {
+                sched_yield();
+        }
+        return batch;
+}
+
+/*
+ * consumer_id >= 0: the batches are digested in place (no consumer thread)
+ */
+static void _produce(CINTPipeline *pl, double *cache, int consumer_id)
+{
+        CINTBatch *batch = NULL;
+        size_t t, size;
+        int *shls;
+        while ((t = __atomic_fetch_add(&pl->next_task, 1, __ATOMIC_RELAXED)) < pl->ntask) {
+                shls = pl->shls + t * 4;
+                size = _task_size(pl, shls);
+                if (batch != NULL && (batch->ntask == PIPELINE_BATCH_TASKS ||
+                                      batch->size + size > pl->batch_size)) {
+                        if (consumer_id >= 0) {
+                                _digest_batch(pl, batch, consumer_id);
+                        } else {
+                                _queue_push(&pl->ready_batches, batch);
+                                batch = NULL;
+                        }
+                }
+                if (batch == NULL) {
+                        batch = _wait_free_batch(pl);
+                }
+                if ((*pl->intor)(batch->data + batch->size, NULL, shls,
+                                 pl->atm, pl->natm, pl->bas, pl->nbas, pl->env,
+                                 pl->opt, cache)) {
+                        batch->task[batch->ntask] = t;
+                        batch->loc[batch->ntask] = batch->size;
+                        batch->ntask++;
+                        // keep the output of each quartet aligned
+                        batch->size += (size + SIMDD - 1) / SIMDD * SIMDD;
+                }
+        }
+        if (batch != NULL) {
+                if (consumer_id >= 0) {
+                        _digest_batch(pl, batch, consumer_id);
+                        _queue_push(&pl->free_batches, batch);
+                } else {
+                        _queue_push(&pl->ready_batches, batch);
+                }
+        }
+        __atomic_fetch_add(&pl->producers_done, 1, __ATOMIC_RELEASE);
+}
+
+static void _consume(CINTPipeline *pl, int nproducer, int consumer_id)
+{
+        CINTBatch *batch;
+        int finished;
+        while (1) {
+                // all batches were pushed if the producers have finished
+                finished = __atomic_load_n(&pl->producers_done, __ATOMIC_ACQUIRE) == nproducer;
+                batch = _queue_pop(&pl->ready_batches);
+                if (batch != NULL) {
+                        _digest_batch(pl, batch, consumer_id);
+                        _queue_push(&pl->free_batches, batch);
+                } else if (finished) {
+                        break;
+                } else {
+                        sched_yield();
+                }
+        }
+}
+
+int CINTpipeline_eri(CACHE_SIZE_T (*intor)(), int ncomp, int ncenter,
+                     int *shls, size_t ntask, int *ao_loc, CINTOpt *opt,
+                     void (*digest)(double *eri, int *shls, int consumer_id, void *data),
+                     void *data, int nproducer, int nconsumer,
+                     int *atm, int natm, int *bas, int nbas, double *env)
+{
+        if (ncenter < 2 || ncenter > 4 || nproducer < 1 || nconsumer < 1) {
+                fprintf(stderr, "CINTpipeline_eri: invalid ncenter %d or threads %d,%d\n",
+                        ncenter, nproducer, nconsumer);
+                return -1;
+        }
+        if (ntask == 0) {
+                return 0;
+        }
+
+        CINTPipeline pl;
+        pl.intor = intor;
+        pl.ncomp = ncomp;
+        pl.ncenter = ncenter;
+        pl.shls = shls;
+        pl.ntask = ntask;
+        pl.ao_loc = ao_loc;
+        pl.opt = opt;
+        pl.atm = atm;
+        pl.natm = natm;
+        pl.bas = bas;
+        pl.nbas = nbas;
+        pl.env = env;
+        pl.digest = digest;
+        pl.data = data;
+        pl.next_task = 0;
+        pl.producers_done = 0;
+
+        int slice[2] = {nbas, 0};
+        size_t t, size;
+        size_t max_size = 0;
+        int n;
+        for (t = 0; t < ntask; t++) {
+                for (n = 0; n < ncenter; n++) {
+                        slice[0] = MIN(slice[0], shls[t*4+n]);
+                        slice[1] = MAX(slice[1], shls[t*4+n] + 1);
+                }
+                size = _task_size(&pl, shls + t * 4);
+                max_size = MAX(max_size, size);
+        }
+        pl.batch_size = MAX(PIPELINE_BATCH_SIZE, (max_size + SIMDD - 1) / SIMDD * SIMDD);
+        pl.cache_size = CINTmax_cache_size(intor, slice, 1, atm, natm, bas, nbas, env);
+
+        // two batches per thread, one being filled or digested, one queued
+        int nbatch = (nproducer + nconsumer) * 2;
+        CINTBatch *batches = malloc(sizeof(CINTBatch) * nbatch);
+        double *buf = _mm_malloc(sizeof(double) * pl.batch_size * nbatch,
+                                 sizeof(double) * SIMDD);
+        if (batches == NULL || buf == NULL) {
+                fprintf(stderr, "CINTpipeline_eri: failed to allocate %d batches\n", nbatch);
+                free(batches);
+                _mm_free(buf);
+                return -1;
+        }
+        _queue_init(&pl.free_batches, nbatch);
+        _queue_init(&pl.ready_batches, nbatch);
+        for (n = 0; n < nbatch; n++) {
+                batches[n].data = buf + pl.batch_size * n;
+                batches[n].size = 0;
+                batches[n].ntask = 0;
+                _queue_push(&pl.free_batches, batches + n);
+        }
+
+#pragma omp parallel num_threads(nproducer + nconsumer)
+{
+        int nthreads = 1;
+        int thread_id = 0;
+#ifdef _OPENMP
+        nthreads = omp_get_num_threads();
+        thread_id = omp_get_thread_num();
+#endif
+        double *cache = _mm_malloc(sizeof(double) * MAX(pl.cache_size, 1),
+                                   sizeof(double) * SIMDD);
+        if (nthreads == 1) {
+                _produce(&pl, cache, 0);
+        } else {
+                // fewer threads than requested: keep the producer fraction
+                int np = (int)((size_t)nthreads * nproducer / (nproducer + nconsumer));
+                np = MAX(1, MIN(np, nthreads - 1));
+                if (thread_id < np) {
+                        _produce(&pl, cache, -1);
+                } else {
+                        _consume(&pl, np, thread_id - np);
+                }
+        }
+        _mm_free(cache);
+}
+
+        free(pl.free_batches.cells);
+        free(pl.ready_batches.cells);
+        _mm_free(buf);
+        free(batches);
+        return 0;
+}
@@ -0,0 +1,460 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost model of shell quartets and the work-stealing scheduler of the
+ * batched ERI drivers.
+ *
+ * The cost of a quartet is estimated from the primitive pairs which
+ * survive the pair screening of the optimizer, the number of Rys roots, the
+ * size of the 2D integrals and the number of cartesian components.
+ *
+ * The tasks are grouped into consecutive chunks of about equal cost.  Each
+ * thread owns a contiguous range of chunks of 1/nthreads of the total
+ * cost, taken from the front.  A thread which has run out of work steals
+ * the back half of the largest remaining range of the other threads.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include "cint_bas.h"
+#include "misc.h"
+#include "optimizer.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define SCHED_CHUNKS_PER_THREAD 16
+#define COST_BINS               4096
+#define CACHE_LINE              64
+
+typedef struct {
+        double nprim;   // primitive pairs which survive the screening
+        int li;
+        int lj;
+        int ictr;
+        int nctr;       // ictr * jctr
+} PairCost;
+
+typedef struct {
+        // lo | hi << 32, the chunks [lo, hi) of a thread
+        uint64_t range;
+        char pad[CACHE_LINE - sizeof(uint64_t)];
+} ChunkRange;
+
+struct CINTScheduler {
+        int nthreads;
+        size_t nchunk;
+        size_t *chunk_loc;
+        ChunkRange *ranges;
+};
+
+static void _pair_cost(PairCost *pc, CINTOpt *opt, int ish, int jsh)
+{
+        CINTBasisData *bd = opt->basis;
+        int *shells = bd->shells;
+        int iprim = shells[ish*4+2];
+        int jprim = shells[jsh*4+2];
+        pc->li = shells[ish*4+1];
+        pc->lj = shells[jsh*4+1];
+        pc->ictr = shells[ish*4+3];
+        pc->nctr = shells[ish*4+3] * shells[jsh*4+3];
+        pc->nprim = iprim * jprim;
+        if (opt->pairdata != NULL) {
+                PairData *pdata = opt->pairdata[ish*opt->nbas+jsh];
+                if (pdata == NOVALUE) {
+                        pc->nprim = 0;
+                } else {
+                        // same cutoff as the pair screening of _set_opt_pairdata
+                        double cutoff = opt->expcutoff + opt->pair_shift[ish*opt->nbas+jsh];
+                        int n, np = 0;
+                        for (n = 0; n < iprim * jprim; n++) {
+                                np += pdata[n].cceij < cutoff;
+                        }
+                        pc->nprim = np;
+                }
+        }
+}
+
+/*
+ * Rys quadrature and 2D recurrences for each primitive quartet, the
+ * contraction of the first shell and the output of the contracted functions
+ */
+static double _quartet_cost(PairCost *ij, int lk, int ll, double nprim_kl, double nctr_kl)
+{
+        int lij = ij->li + ij->lj;
+        int lkl = lk + ll;
+        double nroots = (lij + lkl) / 2 + 1;
+        double nf = (ij->li+1)*(ij->li+2)/2 * (ij->lj+1)*(ij->lj+2)/2
+                  * (lk+1)*(lk+2)/2 * (ll+1)*(ll+2)/2;
+        double g2d = (lij + 1) * (lkl + 1);
+        double nprim = ij->nprim * nprim_kl;
+        return nprim * (nroots * (3 * g2d + nf) + nf * ij->ictr)
+                + nf * ij->nctr * nctr_kl;
+}
+
+double CINTquartet_cost(CINTOpt *opt, int *shls)
+{
+        if (opt == NULL || opt->basis == NULL) {
+                return -1;
+        }
+        PairCost ij, kl;
+        _pair_cost(&ij, opt, shls[0], shls[1]);
+        _pair_cost(&kl, opt, shls[2], shls[3]);
+        if (ij.nprim == 0 || kl.nprim == 0) {
+                return 0;
+        }
+        return _quartet_cost(&ij, kl.li, kl.lj, kl.nprim, kl.nctr);
+}
+
+/*
+ * costs[n] = sum_kl cost(bra_pairs[n], kl) for the ket shell pairs
+ * ket_pairs[nket,2].  The ket pairs are summed by angular momentum, hence
+ * the cost of nbra*nket quartets is computed in O((nbra+nket)*LMAX1^2).
+ * Returns -1 if opt does not have the basis data.
+ */
+int CINTpair_costs(double *costs, CINTOpt *opt, int *bra_pairs, size_t nbra,
+                   int *ket_pairs, size_t nket)
+{
+        if (opt == NULL || opt->basis == NULL) {
+                return -1;
+        }
+        double *nprim_kl = calloc(LMAX1 * LMAX1 * 2, sizeof(double));
+        double *nctr_kl = nprim_kl + LMAX1 * LMAX1;
+        int *lmask = calloc(LMAX1 * LMAX1, sizeof(int));
+        PairCost pc;
+        size_t n;
+        int lk, ll, lkl;
+        for (n = 0; n < nket; n++) {
+                _pair_cost(&pc, opt, ket_pairs[n*2], ket_pairs[n*2+1]);
+                if (pc.nprim > 0) {
+                        lkl = pc.li * LMAX1 + pc.lj;
+                        nprim_kl[lkl] += pc.nprim;
+                        nctr_kl[lkl] += pc.nctr;
+                        lmask[lkl] = 1;
+                }
+        }
+        for (n = 0; n < nbra; n++) {
+                _pair_cost(&pc, opt, bra_pairs[n*2], bra_pairs[n*2+1]);
+                costs[n] = 0;
+                if (pc.nprim == 0) {
+                        continue;
+                }
+                for (lk = 0; lk < LMAX1; lk++) {
+                for (ll = 0; ll < LMAX1; ll++) {
+                        lkl = lk * LMAX1 + ll;
+                        if (lmask[lkl]) {
+                                costs[n] += _quartet_cost(&pc, lk, ll, nprim_kl[lkl],
+                                                          nctr_kl[lkl]);
+                        }
+                } }
+        }
+        free(nprim_kl);
+        free(lmask);
+        return 0;
+}
+
+static int _uint64_cmp(const void *a, const void *b)
+{
+        uint64_t ka = *(const uint64_t *)a;
+        uint64_t kb = *(const uint64_t *)b;
+        return (ka > kb) - (ka < kb);
+}
+
+/*
+ * Threshold of cost/bytes such that the unique quartets (ij|kl), kl <= ij,
+ * of a higher cost per byte take at most max_bytes.  A quartet takes
+ * sizeof(double) for each function plus overhead bytes.  The number of the
+ * quartets above the threshold is returned in nquartets.
+ *
+ * The shell pairs are grouped by the kind of the two shells and the number
+ * of primitive pairs which survive the screening.  The quartets of each two
+ * groups are counted in a histogram of log(cost/bytes).  Returns 0 if all
+ * quartets fit and -1 if opt does not have the basis data.
+ */
+double CINTcost_threshold(size_t *nquartets, CINTOpt *opt, int *ao_loc,
+                          size_t max_bytes, size_t overhead)
+{
+        *nquartets = 0;
+        if (opt == NULL || opt->basis == NULL) {
+                return -1;
+        }
+        int nbas = opt->basis->nbas;
+        int *shells = opt->basis->shells;
+        int *kind_of = malloc(sizeof(int) * (nbas * 2 + 1));
+        int *kind_rep = kind_of + nbas;
+        int nkind = 0;
+        int i, j, n;
+        for (i = 0; i < nbas; i++) {
+                for (n = 0; n < nkind; n++) {
+                        j = kind_rep[n];
+                        if (shells[i*4+1] == shells[j*4+1] &&
+                            shells[i*4+2] == shells[j*4+2] &&
+                            shells[i*4+3] == shells[j*4+3] &&
+                            ao_loc[i+1] - ao_loc[i] == ao_loc[j+1] - ao_loc[j]) {
+                                break;
+                        }
+                }
+                if (n == nkind) {
+                        kind_rep[nkind++] = i;
+                }
+                kind_of[i] = n;
+        }
+
+        // key = (kind_i * nkind + kind_j) << 32 | nprim
+        size_t npair = (size_t)nbas * (nbas + 1) / 2;
+        uint64_t *keys = malloc(sizeof(uint64_t) * MAX(npair, 1));
+        PairCost pc;
+        size_t ij, nkey = 0;
+        for (i = 0; i < nbas; i++) {
+                for (j = 0; j <= i; j++) {
+                        _pair_cost(&pc, opt, i, j);
+                        if (pc.nprim > 0) {
+                                keys[nkey++] = (uint64_t)(kind_of[i] * nkind + kind_of[j]) << 32
+                                             | (uint64_t)pc.nprim;
+                        }
+                }
+        }
+        qsort(keys, nkey, sizeof(uint64_t), _uint64_cmp);
+
+        // groups of the shell pairs
+        PairCost *groups = malloc(sizeof(PairCost) * MAX(nkey, 1));
+        double *counts = malloc(sizeof(double) * MAX(nkey, 1) * 2);
+        double *sizes = counts + MAX(nkey, 1);
+        size_t ngroup = 0;
+        int ki, kj;
+        for (ij = 0; ij < nkey; ij++) {
+                if (ij > 0 && keys[ij] == keys[ij-1]) {
+                        counts[ngroup-1] += 1;
+                        continue;
+                }
+                ki = kind_rep[(keys[ij] >> 32) / nkind];
+                kj = kind_rep[(keys[ij] >> 32) % nkind];
+                _pair_cost(groups + ngroup, opt, ki, kj);
+                groups[ngroup].nprim = keys[ij] & 0xffffffff;
+                sizes[ngroup] = (double)(ao_loc[ki+1] - ao_loc[ki]) * (ao_loc[kj+1] - ao_loc[kj]);
+                counts[ngroup] = 1;
+                ngroup++;
+        }
+        free(keys);
+        free(kind_of);
+        if (ngroup == 0) {
+                free(groups);
+                free(counts);
+                return 0;
+        }
+
+        size_t a, b;
+        double count, bytes, cost, val;
+        double vmin = 1e300;
+        double vmax = 0;
+        for (a = 0; a < ngroup; a++) {
+                for (b = 0; b <= a; b++) {
+                        bytes = sizeof(double) * sizes[a] * sizes[b] + overhead;
+                        cost = _quartet_cost(groups+a, groups[b].li, groups[b].lj,
+                                             groups[b].nprim, groups[b].nctr);
+                        val = cost / bytes;
+                        vmin = MIN(vmin, val);
+                        vmax = MAX(vmax, val);
+                }
+        }
+
+        double *hist_bytes = calloc(COST_BINS * 2, sizeof(double));
+        double *hist_count = hist_bytes + COST_BINS;
+        double lmin = log(MAX(vmin, 1e-300));
+        double dlog = (log(MAX(vmax, 1e-300)) - lmin) / (COST_BINS - 1) + 1e-12;
+        int bin;
+        for (a = 0; a < ngroup; a++) {
+                for (b = 0; b <= a; b++) {
+                        bytes = sizeof(double) * sizes[a] * sizes[b] + overhead;
+                        cost = _quartet_cost(groups+a, groups[b].li, groups[b].lj,
+                                             groups[b].nprim, groups[b].nctr);
+                        val = cost / bytes;
+                        if (a == b) {
+                                count = counts[a] * (counts[a] + 1) / 2;
+                        } else {
+                                count = counts[a] * counts[b];
+                        }
+                        bin = (int)((log(MAX(val, 1e-300)) - lmin) / dlog);
+                        hist_bytes[bin] += count * bytes;
+                        hist_count[bin] += count;
+                }
+        }
+        free(groups);
+        free(counts);
+
+        double acc_bytes = 0;
+        double acc_count = 0;
+        for (bin = COST_BINS - 1; bin >= 0; bin--) {
+                if (acc_bytes + hist_bytes[bin] > max_bytes) {
+                        break;
+                }
+                acc_bytes += hist_bytes[bin];
+                acc_count += hist_count[bin];
+        }
+        double threshold = 0;
+        if (bin >= 0) {
+                threshold = exp(lmin + (bin + 1) * dlog);
+        }
+        *nquartets = (size_t)acc_count;
+        free(hist_bytes);
+        return threshold;
+}
+
+/*
+ * A scheduler for the threads of the next parallel region.  costs can be
+ * NULL for tasks of equal cost.
+ */
+CINTScheduler *CINTsched_create(double *costs, size_t ntask)
+{
+        CINTScheduler *sched = malloc(sizeof(CINTScheduler));
+        int nthreads = 1;
+#ifdef _OPENMP
+        nthreads = omp_get_max_threads();
+#endif
+        sched->nthreads = nthreads;
+        sched->ranges = _mm_malloc(sizeof(ChunkRange) * nthreads, CACHE_LINE);
+        sched->chunk_loc = malloc(sizeof(size_t) * (ntask + 1));
+        size_t *chunk_loc = sched->chunk_loc;
+
+        double total = 0;
+        size_t t;
+        if (costs != NULL) {
+                for (t = 0; t < ntask; t++) {
+                        total += costs[t];
+                }
+        }
+        if (total <= 0) {
+                costs = NULL;
+                total = ntask;
+        }
+
+        size_t maxchunk = (size_t)nthreads * SCHED_CHUNKS_PER_THREAD;
+        double target = total / maxchunk;
+        double acc = 0;
+        size_t nchunk = 0;
+        chunk_loc[0] = 0;
+        for (t = 0; t < ntask; t++) {
+                acc += (costs != NULL) ? costs[t] : 1;
+                if (acc >= target * (nchunk + 1) || t == ntask - 1) {
+                        nchunk++;
+                        chunk_loc[nchunk] = t + 1;
+                }
+        }
+        sched->nchunk = nchunk;
+
+        // thread i owns the chunks which end in [i, i+1) * total/nthreads
+        int i = 0;
+        size_t c;
+        uint64_t lo = 0;
+        acc = 0;
+        for (c = 0; c < nchunk; c++) {
+                for (t = chunk_loc[c]; t < chunk_loc[c+1]; t++) {
+                        acc += (costs != NULL) ? costs[t] : 1;
+                }
+                while (i < nthreads - 1 && acc > total * (i + 1) / nthreads) {
+                        sched->ranges[i].range = lo | (uint64_t)c << 32;
+                        lo = c;
+                        i++;
+                }
+        }
+        for (; i < nthreads; i++) {
+                sched->ranges[i].range = lo | (uint64_t)nchunk << 32;
+                lo = nchunk;
+        }
+        return sched;
+}
+
+void CINTsched_del(CINTScheduler *sched)
+{
+        if (sched != NULL) {
+                _mm_free(sched->ranges);
+                free(sched->chunk_loc);
+                free(sched);
+        }
+}
+
+static int _steal(CINTScheduler *sched, int thread_id, uint64_t *chunk)
+{
+        uint64_t range, lo, hi, mid;
+        int i, victim;
+        while (1) {
+                victim = -1;
+                hi = 0;
+                lo = 0;
+                for (i = 0; i < sched->nthreads; i++) {
+                        range = __atomic_load_n(&sched->ranges[i].range, __ATOMIC_ACQUIRE);
+                        if ((range >> 32) - (range & 0xffffffff) > hi - lo &&
+                            (range >> 32) > (range & 0xffffffff)) {
+                                lo = range & 0xffffffff;
+                                hi = range >> 32;
+                                victim = i;
+                        }
+                }
+                if (victim < 0) {
+                        return 0;
+                }
+                range = lo | hi << 32;
+                mid = lo + (hi - lo) / 2;
+                if (__atomic_compare_exchange_n(&sched->ranges[victim].range, &range,
+                                                lo | mid << 32, 0,
+                                                __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+                        // The own range is empty, no other thread modifies it
+                        __atomic_store_n(&sched->ranges[thread_id].range,
+                                         (mid + 1) | hi << 32, __ATOMIC_RELEASE);
+                        *chunk = mid;
+                        return 1;
+                }
+        }
+}
+
+/*
+ * The next task range [*task0, *task1) of the calling thread.  Returns 0 if
+ * all tasks were taken.
+ */
+int CINTsched_next(CINTScheduler *sched, size_t *task0, size_t *task1)
+{
+        int thread_id = 0;
+#ifdef _OPENMP
+        thread_id = omp_get_thread_num();
+#endif
+        uint64_t *prange = &sched->ranges[thread_id].range;
+        uint64_t range = __atomic_load_n(prange, __ATOMIC_ACQUIRE);
+        uint64_t lo, hi, chunk;
+        while (1) {
+                lo = range & 0xffffffff;
+                hi = range >> 32;
+                if (lo >= hi) {
+                        if (!_steal(sched, thread_id, &chunk)) {
+                                return 0;
+                        }
+                        break;
+                }
+                if (__atomic_compare_exchange_n(prange, &range, (lo + 1) | hi << 32, 0,
+                                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                        chunk = lo;
+                        break;
+                }
+        }
+        *task0 = sched->chunk_loc[chunk];
+        *task1 = sched->chunk_loc[chunk+1];
+        return 1;
+}
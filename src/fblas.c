@@ -25,6 +25,7 @@
 #include <string.h>
 #include <complex.h>
 #include "fblas.h"
+#include "simd.h"
 
 #define OF_CMPLX        2
 
@@ -50,92 +51,240 @@ void CINTdaxpy2v(int n, double a, double *x, double *y, double *v)
         }
 }
 
+#define STORE_OR_ADD(addr, r) \
+        if (plus) { \
+                MM_STOREU(addr, MM_ADD(MM_LOADU(addr), r)); \
+        } else { \
+                MM_STOREU(addr, r); \
+        }
+
+#ifdef __AVX512F__
 /*
- * a[m,n] -> a_t[n,m]
+ * Transpose the 8x8 tiles of the rows [0, m/8*8) and the columns [j0, j0+8)
+ * in registers
  */
-void CINTdmat_transpose(double *a_t, double *a, int m, int n)
+static void _transpose_tiles8(double *a_t, double *a, int m, int n, int j0, int plus)
 {
-        int i, j, k;
-        double *pa1, *pa2, *pa3;
-
-        for (j = 0; j < n-3; j+=4) {
-                pa1 = a_t + m;
-                pa2 = pa1 + m;
-                pa3 = pa2 + m;
-                for (i = 0, k = j; i < m; i++, k+=n) {
-                        a_t[i] = a[k+0];
-                        pa1[i] = a[k+1];
-                        pa2[i] = a[k+2];
-                        pa3[i] = a[k+3];
-                }
-                a_t += m * 4;
+        const __m512i lo2 = _mm512_set_epi64(13, 12, 5, 4, 9, 8, 1, 0);
+        const __m512i hi2 = _mm512_set_epi64(15, 14, 7, 6, 11, 10, 3, 2);
+        const __m512i lo4 = _mm512_set_epi64(11, 10, 9, 8, 3, 2, 1, 0);
+        const __m512i hi4 = _mm512_set_epi64(15, 14, 13, 12, 7, 6, 5, 4);
+        __m512d r0, r1, r2, r3, r4, r5, r6, r7;
+        __m512d t0, t1, t2, t3, t4, t5, t6, t7;
+        __m512d u0, u1, u2, u3, u4, u5, u6, u7;
+        double *pa, *pt;
+        int i;
+        for (i = 0; i + 8 <= m; i += 8) {
+                pa = a + i * n + j0;
+                r0 = _mm512_loadu_pd(pa      );
+                r1 = _mm512_loadu_pd(pa+n    );
+                r2 = _mm512_loadu_pd(pa+n*2  );
+                r3 = _mm512_loadu_pd(pa+n*3  );
+                r4 = _mm512_loadu_pd(pa+n*4  );
+                r5 = _mm512_loadu_pd(pa+n*5  );
+                r6 = _mm512_loadu_pd(pa+n*6  );
+                r7 = _mm512_loadu_pd(pa+n*7  );
+                t0 = _mm512_unpacklo_pd(r0, r1);
+                t1 = _mm512_unpackhi_pd(r0, r1);
+                t2 = _mm512_unpacklo_pd(r2, r3);
+                t3 = _mm512_unpackhi_pd(r2, r3);
+                t4 = _mm512_unpacklo_pd(r4, r5);
+                t5 = _mm512_unpackhi_pd(r4, r5);
+                t6 = _mm512_unpacklo_pd(r6, r7);
+                t7 = _mm512_unpackhi_pd(r6, r7);
+                u0 = _mm512_permutex2var_pd(t0, lo2, t2);
+                u1 = _mm512_permutex2var_pd(t1, lo2, t3);
+                u2 = _mm512_permutex2var_pd(t0, hi2, t2);
+                u3 = _mm512_permutex2var_pd(t1, hi2, t3);
+                u4 = _mm512_permutex2var_pd(t4, lo2, t6);
+                u5 = _mm512_permutex2var_pd(t5, lo2, t7);
+                u6 = _mm512_permutex2var_pd(t4, hi2, t6);
+                u7 = _mm512_permutex2var_pd(t5, hi2, t7);
+                pt = a_t + j0 * m + i;
+                STORE_OR_ADD(pt    , _mm512_permutex2var_pd(u0, lo4, u4));
+                STORE_OR_ADD(pt+m  , _mm512_permutex2var_pd(u1, lo4, u5));
+                STORE_OR_ADD(pt+m*2, _mm512_permutex2var_pd(u2, lo4, u6));
+                STORE_OR_ADD(pt+m*3, _mm512_permutex2var_pd(u3, lo4, u7));
+                STORE_OR_ADD(pt+m*4, _mm512_permutex2var_pd(u0, hi4, u4));
+                STORE_OR_ADD(pt+m*5, _mm512_permutex2var_pd(u1, hi4, u5));
+                STORE_OR_ADD(pt+m*6, _mm512_permutex2var_pd(u2, hi4, u6));
+                STORE_OR_ADD(pt+m*7, _mm512_permutex2var_pd(u3, hi4, u7));
         }
+}
 
-        switch (n-j) {
-        case 1:
-                for (i = 0, k = j; i < m; i++, k+=n) {
-                        a_t[i] = a[k];
+/*
+ * For n < 8, every 8 rows are n contiguous vectors.  Column j of the 8 rows
+ * is gathered from these vectors with n-1 two-source permutations.  It is
+ * inlined for each n so that v and idx are kept in registers.
+ */
+static inline __attribute__((always_inline))
+void _deinterleave8_n(double *a_t, double *a, int m, const int n, int plus)
+{
+        __m512i idx[8][8];
+        __m512d v[8];
+        __m512d r0;
+        int64_t ik[8];
+        int i, j, k, s, e;
+        for (j = 0; j < n; j++) {
+                for (s = 1; s < n; s++) {
+                        for (k = 0; k < 8; k++) {
+                                e = j + k * n;
+                                if (s == 1) {
+                                        ik[k] = e < 16 ? e : 0;
+                                } else {
+                                        ik[k] = e / 8 == s ? 8 + e % 8 : k;
+                                }
+                        }
+                        idx[j][s] = _mm512_loadu_si512(ik);
                 }
-                break;
-        case 2:
-                pa1 = a_t + m;
-                for (i = 0, k = j; i < m; i++, k+=n) {
-                        a_t[i] = a[k+0];
-                        pa1[i] = a[k+1];
+        }
+        for (i = 0; i + 8 <= m; i += 8) {
+                for (s = 0; s < n; s++) {
+                        v[s] = _mm512_loadu_pd(a + i * n + s * 8);
                 }
-                break;
-        case 3:
-                pa1 = a_t + m;
-                pa2 = pa1 + m;
-                for (i = 0, k = j; i < m; i++, k+=n) {
-                        a_t[i] = a[k+0];
-                        pa1[i] = a[k+1];
-                        pa2[i] = a[k+2];
+                for (j = 0; j < n; j++) {
+                        r0 = _mm512_permutex2var_pd(v[0], idx[j][1], v[1]);
+                        for (s = 2; s < n; s++) {
+                                r0 = _mm512_permutex2var_pd(r0, idx[j][s], v[s]);
+                        }
+                        STORE_OR_ADD(a_t + j * m + i, r0);
                 }
-                break;
         }
 }
 
-/*
- * a_t[n,m] += a[m,n]
- */
-void CINTdplus_transpose(double *a_t, double *a, int m, int n)
+static void _deinterleave8(double *a_t, double *a, int m, int n, int plus)
 {
-        int i, j, k;
+        switch (n) {
+        case 2: _deinterleave8_n(a_t, a, m, 2, plus); break;
+        case 3: _deinterleave8_n(a_t, a, m, 3, plus); break;
+        case 4: _deinterleave8_n(a_t, a, m, 4, plus); break;
+        case 5: _deinterleave8_n(a_t, a, m, 5, plus); break;
+        case 6: _deinterleave8_n(a_t, a, m, 6, plus); break;
+        case 7: _deinterleave8_n(a_t, a, m, 7, plus); break;
+        }
+}
+#endif
 
-        for (j = 0; j < n-3; j+=4) {
-#pragma GCC ivdep
-                for (i = 0; i < m; i++) {
-                        a_t[(j+0)*m+i] += a[i*n+j+0];
-                        a_t[(j+1)*m+i] += a[i*n+j+1];
-                        a_t[(j+2)*m+i] += a[i*n+j+2];
-                        a_t[(j+3)*m+i] += a[i*n+j+3];
+#ifdef __AVX__
+static void _transpose_tiles4(double *a_t, double *a, int m, int n, int j0, int plus,
+                              int mblk)
+{
+        __m256d r0, r1, r2, r3, t0, t1, t2, t3;
+        double *pa, *pt;
+        int i;
+        for (i = 0; i + 4 <= mblk; i += 4) {
+                pa = a + i * n + j0;
+                r0 = _mm256_loadu_pd(pa    );
+                r1 = _mm256_loadu_pd(pa+n  );
+                r2 = _mm256_loadu_pd(pa+n*2);
+                r3 = _mm256_loadu_pd(pa+n*3);
+                t0 = _mm256_unpacklo_pd(r0, r1);
+                t1 = _mm256_unpackhi_pd(r0, r1);
+                t2 = _mm256_unpacklo_pd(r2, r3);
+                t3 = _mm256_unpackhi_pd(r2, r3);
+                pt = a_t + j0 * m + i;
+                if (plus) {
+                        _mm256_storeu_pd(pt    , _mm256_add_pd(_mm256_loadu_pd(pt    ), _mm256_permute2f128_pd(t0, t2, 0x20)));
+                        _mm256_storeu_pd(pt+m  , _mm256_add_pd(_mm256_loadu_pd(pt+m  ), _mm256_permute2f128_pd(t1, t3, 0x20)));
+                        _mm256_storeu_pd(pt+m*2, _mm256_add_pd(_mm256_loadu_pd(pt+m*2), _mm256_permute2f128_pd(t0, t2, 0x31)));
+                        _mm256_storeu_pd(pt+m*3, _mm256_add_pd(_mm256_loadu_pd(pt+m*3), _mm256_permute2f128_pd(t1, t3, 0x31)));
+                } else {
+                        _mm256_storeu_pd(pt    , _mm256_permute2f128_pd(t0, t2, 0x20));
+                        _mm256_storeu_pd(pt+m  , _mm256_permute2f128_pd(t1, t3, 0x20));
+                        _mm256_storeu_pd(pt+m*2, _mm256_permute2f128_pd(t0, t2, 0x31));
+                        _mm256_storeu_pd(pt+m*3, _mm256_permute2f128_pd(t1, t3, 0x31));
+                }
+        }
+}
+#else
+static void _transpose_tiles2(double *a_t, double *a, int m, int n, int j0, int plus)
+{
+        __m128d r0, r1;
+        double *pa, *pt;
+        int i;
+        for (i = 0; i + 2 <= m; i += 2) {
+                pa = a + i * n + j0;
+                r0 = _mm_loadu_pd(pa  );
+                r1 = _mm_loadu_pd(pa+n);
+                pt = a_t + j0 * m + i;
+                if (plus) {
+                        _mm_storeu_pd(pt  , _mm_add_pd(_mm_loadu_pd(pt  ), _mm_unpacklo_pd(r0, r1)));
+                        _mm_storeu_pd(pt+m, _mm_add_pd(_mm_loadu_pd(pt+m), _mm_unpackhi_pd(r0, r1)));
+                } else {
+                        _mm_storeu_pd(pt  , _mm_unpacklo_pd(r0, r1));
+                        _mm_storeu_pd(pt+m, _mm_unpackhi_pd(r0, r1));
                 }
         }
+}
+#endif
 
-        switch (n-j) {
-        case 1:
-#pragma GCC ivdep
-                for (i = 0; i < m; i++) {
-                        a_t[j*m+i] += a[i*n+j];
+/*
+ * a_t[n,m] = a[m,n] or a_t[n,m] += a[m,n].  The rows of a are processed in
+ * blocks of SIMDD which are transposed in registers.  The remaining rows
+ * and columns are copied element-wise.
+ */
+static void _dmat_transpose(double *a_t, double *a, int m, int n, int plus)
+{
+        int mblk = m;  // rows [0, mblk) of columns [0, j) are done in registers
+        int i, j = 0;
+#ifdef __AVX512F__
+        if (n < 8) {
+                if (n > 1) {
+                        _deinterleave8(a_t, a, m, n, plus);
+                        j = n;
+                        mblk = m / 8 * 8;
                 }
-                break;
-        case 2:
-#pragma GCC ivdep
-                for (i = 0; i < m; i++) {
-                        a_t[(j+0)*m+i] += a[i*n+j+0];
-                        a_t[(j+1)*m+i] += a[i*n+j+1];
+        } else {
+                for (; j + 8 <= n; j += 8) {
+                        _transpose_tiles8(a_t, a, m, n, j, plus);
                 }
-                break;
-        case 3:
-#pragma GCC ivdep
-                for (i = 0; i < m; i++) {
-                        a_t[(j+0)*m+i] += a[i*n+j+0];
-                        a_t[(j+1)*m+i] += a[i*n+j+1];
-                        a_t[(j+2)*m+i] += a[i*n+j+2];
+                mblk = m / 8 * 8;
+                if (j + 4 <= n) {
+                        _transpose_tiles4(a_t, a, m, n, j, plus, mblk);
+                        j += 4;
                 }
-                break;
         }
+#elif defined __AVX__
+        for (; j + 4 <= n; j += 4) {
+                _transpose_tiles4(a_t, a, m, n, j, plus, m);
+        }
+        mblk = m / 4 * 4;
+#else
+        for (; j + 2 <= n; j += 2) {
+                _transpose_tiles2(a_t, a, m, n, j, plus);
+        }
+        mblk = m / 2 * 2;
+#endif
+        int j1 = j;
+        if (plus) {
+                for (j = 0; j < n; j++) {
+                        for (i = (j < j1 ? mblk : 0); i < m; i++) {
+                                a_t[j*m+i] += a[i*n+j];
+                        }
+                }
+        } else {
+                for (j = 0; j < n; j++) {
+                        for (i = (j < j1 ? mblk : 0); i < m; i++) {
+                                a_t[j*m+i] = a[i*n+j];
+                        }
+                }
+        }
+}
+
+/*
+ * a[m,n] -> a_t[n,m]
+ */
+void CINTdmat_transpose(double *a_t, double *a, int m, int n)
+{
+        _dmat_transpose(a_t, a, m, n, 0);
+}
+
+/*
+ * a_t[n,m] += a[m,n]
+ */
+void CINTdplus_transpose(double *a_t, double *a, int m, int n)
+{
+        _dmat_transpose(a_t, a, m, n, 1);
 }
 
 /*
@@ -40,6 +40,7 @@ void CINTinit_int1e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->atm = atm;
         envs->bas = bas;
         envs->env = env;
+        envs->params = CINTparams_env(env);
         envs->shls = shls;
 
         const int i_sh = shls[0];
@@ -52,10 +53,10 @@ void CINTinit_int1e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->nfj = (envs->j_l+1)*(envs->j_l+2)/2;
         envs->nf = envs->nfi * envs->nfj;
         envs->common_factor = 1;
-        if (env[PTR_EXPCUTOFF] == 0) {
+        if (envs->params[PTR_EXPCUTOFF] == 0) {
                 envs->expcutoff = EXPCUTOFF;
         } else {
-                envs->expcutoff = MAX(MIN_EXPCUTOFF, env[PTR_EXPCUTOFF]);
+                envs->expcutoff = MAX(MIN_EXPCUTOFF, envs->params[PTR_EXPCUTOFF]);
         }
 
         envs->li_ceil = envs->i_l + ng[IINC];
@@ -299,12 +300,12 @@ void CINTg1e_nuc(double *g, CINTEnvVars *envs, int count, int nuc_id)
         aij = MM_LOAD(envs->ai) + MM_LOAD(envs->aj);
         MM_STORE(tau, aij);
         for (k = 0; k < count; k++) {
-                tau[k] = CINTnuc_mod(tau[k], nuc_id, atm, env);
+                tau[k] = CINTnuc_mod(tau[k], nuc_id, atm, nuc_id < 0 ? envs->params : env);
         }
 
         if (nuc_id < 0) {
                 fac1 = MM_SET1(2*M_PI) * MM_LOAD(envs->fac) * MM_LOAD(tau) / aij;
-                cr = env + PTR_RINV_ORIG;
+                cr = envs->params + PTR_RINV_ORIG;
         } else if (atm(NUC_MOD_OF,nuc_id) == FRAC_CHARGE_NUC) {
                 fac1 = MM_SET1(2*M_PI) * MM_SET1(-env[atm[PTR_FRAC_CHARGE+nuc_id*ATM_SLOTS]]);
                 fac1 = fac1 * MM_LOAD(envs->fac) * MM_LOAD(tau) / aij;
@@ -20,7 +20,7 @@ void CINTinit_int1e_grids_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
 {
         CINTinit_int1e_EnvVars(envs, ng, shls, atm, natm, bas, nbas, env);
         int ngrids = shls[3] - shls[2];
-        double *grids = env + (size_t)env[PTR_GRIDS] + shls[2] * 3;
+        double *grids = CINTparams_grids(env, shls[2]);
 
         envs->ngrids = ngrids;
         envs->grids = grids;
@@ -29,7 +29,7 @@ void CINTinit_int1e_grids_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
 
         int rys_order = envs->nrys_roots;
         int nroots = rys_order;
-        double omega = env[PTR_RANGE_OMEGA];
+        double omega = envs->params[PTR_RANGE_OMEGA];
         if (omega < 0 && rys_order <= 3) {
                 nroots *= 2;
         }
@@ -79,6 +79,8 @@ int CINTg0_1e_grids(double *RESTRICT g, double cutoff, CINTEnvVars *envs,
         MALLOC_ALIGNED_DOUBLE_INSTACK(u, GRID_BLKSIZE*nroots);
         double *RESTRICT rijrg;
         MALLOC_ALIGNED_DOUBLE_INSTACK(rijrg, GRID_BLKSIZE*3);
+        double *RESTRICT xs;
+        MALLOC_ALIGNED_DOUBLE_INSTACK(xs, GRID_BLKSIZE);
         double aij = envs->ai[0] + envs->aj[0];
         int n, i, j, ig;
         double x, fac1;
@@ -101,20 +103,26 @@ int CINTg0_1e_grids(double *RESTRICT g, double cutoff, CINTEnvVars *envs,
                 MM_STORE(rijrg+ig+GRID_BLKSIZE*2, MM_LOAD(gridsT+ig+GRID_BLKSIZE*2) - r2);
         }
 
-        double omega = envs->env[PTR_RANGE_OMEGA];
-        double zeta = envs->env[PTR_RINV_ZETA];
+        double omega = envs->params[PTR_RANGE_OMEGA];
+        double zeta = envs->params[PTR_RINV_ZETA];
         double omega2, theta, sqrt_theta, a0, tau2;
+        __MD ra;
 
         assert(zeta >= 0);
         if (omega == 0. && zeta == 0.) {
                 fac1 = envs->fac[0] / aij;
-                for (ig = 0; ig < bgrids; ig++) {
-                        x = aij * RGSQUARE(rijrg, ig);
-                        CINTrys_roots(nroots, x, ubuf, wbuf);
-                        for (i = 0; i < nroots; i++) {
-                                // transform to t^2
-                                u[ig+GRID_BLKSIZE*i] = ubuf[i] / (ubuf[i] + 1);
-                                w[ig+GRID_BLKSIZE*i] = wbuf[i] * fac1;
+                ra = MM_SET1(aij);
+                for (ig = 0; ig < bgrids; ig += SIMDD) {
+                        r0 = MM_LOAD(rijrg+ig+GRID_BLKSIZE*0);
+                        r1 = MM_LOAD(rijrg+ig+GRID_BLKSIZE*1);
+                        r2 = MM_LOAD(rijrg+ig+GRID_BLKSIZE*2);
+                        MM_STORE(xs+ig, ra * (r0 * r0 + r1 * r1 + r2 * r2));
+                }
+                _CINTrys_roots_grids(nroots, xs, u, w, bgrids, GRID_BLKSIZE);
+                r0 = MM_SET1(fac1);
+                for (i = 0; i < nroots; i++) {
+                        for (ig = 0; ig < bgrids; ig += SIMDD) {
+                                MM_STORE(w+ig+GRID_BLKSIZE*i, MM_LOAD(w+ig+GRID_BLKSIZE*i) * r0);
                         }
                 }
         } else if (omega < 0.) { // short-range part of range-separated Coulomb
@@ -185,13 +193,21 @@ int CINTg0_1e_grids(double *RESTRICT g, double cutoff, CINTEnvVars *envs,
                         a0 *= theta;
                         fac1 *= sqrt(theta);
                 }
-                for (ig = 0; ig < bgrids; ig++) {
-                        x = a0 * RGSQUARE(rijrg, ig);
-                        CINTrys_roots(nroots, x, ubuf, wbuf);
-                        for (i = 0; i < nroots; i++) {
-                                // u stores t^2 = tau^2 * theta
-                                u[ig+GRID_BLKSIZE*i] = ubuf[i] / (ubuf[i] + 1) * theta;
-                                w[ig+GRID_BLKSIZE*i] = wbuf[i] * fac1;
+                ra = MM_SET1(a0);
+                for (ig = 0; ig < bgrids; ig += SIMDD) {
+                        r0 = MM_LOAD(rijrg+ig+GRID_BLKSIZE*0);
+                        r1 = MM_LOAD(rijrg+ig+GRID_BLKSIZE*1);
+                        r2 = MM_LOAD(rijrg+ig+GRID_BLKSIZE*2);
+                        MM_STORE(xs+ig, ra * (r0 * r0 + r1 * r1 + r2 * r2));
+                }
+                _CINTrys_roots_grids(nroots, xs, u, w, bgrids, GRID_BLKSIZE);
+                // u stores t^2 = tau^2 * theta
+                r0 = MM_SET1(theta);
+                r1 = MM_SET1(fac1);
+                for (i = 0; i < nroots; i++) {
+                        for (ig = 0; ig < bgrids; ig += SIMDD) {
+                                MM_STORE(u+ig+GRID_BLKSIZE*i, MM_LOAD(u+ig+GRID_BLKSIZE*i) * r0);
+                                MM_STORE(w+ig+GRID_BLKSIZE*i, MM_LOAD(w+ig+GRID_BLKSIZE*i) * r1);
                         }
                 }
         }
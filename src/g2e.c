@@ -34,6 +34,92 @@
         type *RESTRICT GY = G + envs->g_size     * SIMDD; \
         type *RESTRICT GZ = G + envs->g_size * 2 * SIMDD
 
+// Relative cost of an FMA in the cart2sph kernels to an FMA in the
+// contraction, which streams through much larger buffers
+#define C2S_FMA_WEIGHT          0.8
+
+/*
+ * Cost of the cart2sph transformation of one index, in FMAs per transformed
+ * element.  It is the number of nonzero coefficients of the cart2sph table.
+ * s and p functions are not transformed.
+ */
+static int _c2s_nnz[] = {
+        0, 0, 8, 16, 28, 46, 70, 102, 141, 187, 246, 318, 400, 498, 608, 736
+};
+
+/*
+ * FMAs to transform the integrals of one quartet, in the order of
+ * c2s_sph_2e1 (j, l, k, i).
+ */
+static double _c2s_cost(CINTEnvVars *envs)
+{
+        int dj = envs->j_l * 2 + 1;
+        int dk = envs->k_l * 2 + 1;
+        int dl = envs->l_l * 2 + 1;
+        int nfi = envs->nfi;
+        int nfk = envs->nfk;
+        int nfl = envs->nfl;
+        return (double)_c2s_nnz[envs->j_l] * nfi * nfk * nfl
+                + (double)_c2s_nnz[envs->l_l] * nfi * nfk * dj
+                + (double)_c2s_nnz[envs->k_l] * nfi * dl * dj
+                + (double)_c2s_nnz[envs->i_l] * dk * dl * dj;
+}
+
+/*
+ * FMAs to contract nf elements of every primitive quartet, see the
+ * INIT_GCTR_ADDR and PRIM2CTR of CINT2e_loop.
+ */
+static double _contraction_cost(double nf, int *x_prim, int *x_ctr)
+{
+        double ci = x_ctr[0];
+        double cij = ci * x_ctr[1];
+        double cijk = cij * x_ctr[2];
+        double jkl = (double)x_prim[1] * x_prim[2] * x_prim[3];
+        double cost = nf * x_prim[0] * jkl * ci;
+        if (x_ctr[1] > 1) {
+                cost += nf * jkl * cij;
+        }
+        if (x_ctr[2] > 1) {
+                cost += nf * x_prim[2] * x_prim[3] * cijk;
+        }
+        if (x_ctr[3] > 1) {
+                cost += nf * x_prim[3] * cijk * x_ctr[3];
+        }
+        return cost;
+}
+
+/*
+ * Choose between contracting Cartesian integrals then transforming the
+ * contracted quartets (the default), and transforming every primitive
+ * quartet to spherical then contracting the (2l+1) components.  The latter
+ * pays off for high angular momentum and general contractions.  CINT2e_drv
+ * keeps the choice only for gout functions of the CINTgout2e layout.
+ */
+static int _c2s_prim_preferred(CINTEnvVars *envs)
+{
+        int *bas = envs->bas;
+        int *shls = envs->shls;
+        if (MAX(MAX(envs->i_l, envs->j_l), MAX(envs->k_l, envs->l_l)) < 2) {
+                return 0;
+        }
+        int x_prim[4];
+        x_prim[0] = bas(NPRIM_OF, shls[0]);
+        x_prim[1] = bas(NPRIM_OF, shls[1]);
+        x_prim[2] = bas(NPRIM_OF, shls[2]);
+        x_prim[3] = bas(NPRIM_OF, shls[3]);
+        int *x_ctr = envs->x_ctr;
+        double nprim = (double)x_prim[0] * x_prim[1] * x_prim[2] * x_prim[3];
+        double nctr = (double)x_ctr[0] * x_ctr[1] * x_ctr[2] * x_ctr[3];
+        if (nprim <= nctr) {
+                return 0;
+        }
+        double nd = (envs->i_l*2+1) * (envs->j_l*2+1)
+                  * (envs->k_l*2+1) * (envs->l_l*2+1);
+        double c2s = _c2s_cost(envs) * C2S_FMA_WEIGHT;
+        double cost_cart = _contraction_cost(envs->nf, x_prim, x_ctr) + nctr * c2s;
+        double cost_prim = _contraction_cost(nd, x_prim, x_ctr) + nprim * c2s;
+        return cost_prim < cost_cart;
+}
 
 void CINTinit_int2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
                             int *atm, int natm, int *bas, int nbas, double *env)
@@ -43,6 +129,7 @@ void CINTinit_int2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->atm = atm;
         envs->bas = bas;
         envs->env = env;
+        envs->params = CINTparams_env(env);
         envs->shls = shls;
 
         int i_sh = shls[0];
@@ -71,11 +158,11 @@ void CINTinit_int2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->common_factor = (M_PI*M_PI*M_PI)*2/SQRTPI
                 * CINTcommon_fac_sp(envs->i_l) * CINTcommon_fac_sp(envs->j_l)
                 * CINTcommon_fac_sp(envs->k_l) * CINTcommon_fac_sp(envs->l_l);
-        if (env[PTR_EXPCUTOFF] == 0) {
+        if (envs->params[PTR_EXPCUTOFF] == 0) {
                 envs->expcutoff = EXPCUTOFF;
         } else {
                 // +1 to ensure accuracy. See comments in libcint/cint2e.c
-                envs->expcutoff = MAX(MIN_EXPCUTOFF, env[PTR_EXPCUTOFF]) + 1;
+                envs->expcutoff = MAX(MIN_EXPCUTOFF, envs->params[PTR_EXPCUTOFF]) + 1;
         }
 
         envs->gbits = ng[GSHIFT];
@@ -90,7 +177,7 @@ void CINTinit_int2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         int rys_order =(envs->li_ceil + envs->lj_ceil
                         + envs->lk_ceil + envs->ll_ceil)/2 + 1;
         int nrys_roots = rys_order;
-        double omega = env[PTR_RANGE_OMEGA];
+        double omega = envs->params[PTR_RANGE_OMEGA];
         if (omega < 0 && rys_order <= 3) {
                 nrys_roots *= 2;
         }
@@ -176,6 +263,7 @@ void CINTinit_int2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         }
         envs->f_g0_2e = &CINTg0_2e;
         envs->f_g0_2e_simd1 = &CINTg0_2e_simd1;
+        envs->c2s_prim = _c2s_prim_preferred(envs);
 }
 
 void CINTg4c_index_xyz(int *idx, CINTEnvVars *envs)
@@ -5475,7 +5563,7 @@ int CINTg0_2e(double *g, double *cutoff, Rys2eT *bc, CINTEnvVars *envs, int coun
 
 // Not recommended to mix range-separated Coulomb with regular Coulomb operator.
 // Keep this for backward compatibility to cint2
-        const double omega = envs->env[PTR_RANGE_OMEGA];
+        const double omega = envs->params[PTR_RANGE_OMEGA];
         ALIGNMM double theta[SIMDD];
         if (omega == 0) {
                 _CINTrys_roots_batch(nroots, x, u, w, count);
@@ -50,6 +50,7 @@ void CINTinit_int2e_yp_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->atm = atm;
         envs->bas = bas;
         envs->env = env;
+        envs->params = CINTparams_env(env);
         envs->shls = shls;
 
         int i_sh = shls[0];
@@ -70,10 +71,10 @@ void CINTinit_int2e_yp_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->nfl = (envs->l_l+1)*(envs->l_l+2)/2;
         envs->nf = envs->nfi * envs->nfk * envs->nfl * envs->nfj;
         envs->common_factor = 1;
-        if (env[PTR_EXPCUTOFF] == 0) {
+        if (envs->params[PTR_EXPCUTOFF] == 0) {
                 envs->expcutoff = EXPCUTOFF;
         } else {
-                envs->expcutoff = MAX(MIN_EXPCUTOFF, env[PTR_EXPCUTOFF]);
+                envs->expcutoff = MAX(MIN_EXPCUTOFF, envs->params[PTR_EXPCUTOFF]);
         }
 
         envs->gbits = ng[GSHIFT];
@@ -208,7 +209,7 @@ int CINTg0_2e_yp(double *g, double *cutoff,
         double *rkl = envs->rkl;
         double *w = g + envs->g_size * 2; // ~ gz
         __MD ra, r0, r1, r2, r3, r4, r5, r6, r7, r8;
-        double zeta = envs->env[PTR_F12_ZETA];
+        double zeta = envs->params[PTR_F12_ZETA];
         int nroots = envs->nrys_roots;
         int i;
 
@@ -347,7 +348,7 @@ int CINTg0_2e_yp_simd1(double *g, double *cutoff,
 {
         double aij = envs->ai[idsimd] + envs->aj[idsimd];
         double akl = envs->ak[idsimd] + envs->al[idsimd];
-        double zeta = envs->env[PTR_F12_ZETA];
+        double zeta = envs->params[PTR_F12_ZETA];
         int nroots = envs->nrys_roots;
         double a0, a1, fac1, x, ua;
         double *rij = envs->rij;
@@ -458,7 +459,7 @@ int CINTg0_2e_stg(double *g, double *cutoff,
         double *rkl = envs->rkl;
         double *w = g + envs->g_size * 2; // ~ gz
         __MD ra, r0, r1, r2, r3, r4, r5, r6, r7, r8;
-        double zeta = envs->env[PTR_F12_ZETA];
+        double zeta = envs->params[PTR_F12_ZETA];
         int nroots = envs->nrys_roots;
         int i;
 
@@ -596,7 +597,7 @@ int CINTg0_2e_stg_simd1(double *g, double *cutoff,
 {
         double aij = envs->ai[idsimd] + envs->aj[idsimd];
         double akl = envs->ak[idsimd] + envs->al[idsimd];
-        double zeta = envs->env[PTR_F12_ZETA];
+        double zeta = envs->params[PTR_F12_ZETA];
         int nroots = envs->nrys_roots;
         double a0, a1, fac1, x, ua;
         double *rij = envs->rij;
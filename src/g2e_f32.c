@@ -0,0 +1,370 @@
+/*
+ * Qcint is a general GTO integral library for computational chemistry
+ * Copyright (C) 2014- Qiming Sun <osirpt.sun@gmail.com>
+ *
+ * This file is part of Qcint.
+ *
+ * Qcint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Mixed precision ERIs, enabled by env[PTR_MIXED_PRECISION] != 0.
+ *
+ * The Rys roots, weights and the recurrence coefficients are computed in
+ * double precision by CINTg0_2e.  The 2D (VRR) and 4D (HRR) recurrences
+ * and the summation over roots in gout are evaluated in single precision.
+ * The float g arrays are stored behind the double precision gx, gy, gz in
+ * the g buffer (which holds g_size*3*2*SIMDD doubles for int2e), so that
+ * the initial values of gx, gy set by the integral loop are preserved for
+ * the double precision simd1 kernels.  The recurrences run over the
+ * flattened (root, lane) index with SIMDD*2 floats per register.  The
+ * contraction over primitives and the cart-to-sph transformation remain in
+ * double precision.
+ *
+ * The round-off of the single precision recurrences grows with the angular
+ * momentum.  Shell quartets with li+lj+lk+ll <= MIXED_PRECISION_LMAX have
+ * absolute errors below ~1e-7 of the largest integral of the basis, i.e.
+ * ~1e-6 for integrals up to ~10.  Quartets of higher angular momentum are
+ * evaluated in double precision.
+ */
+
+#include "simd.h"
+#include "g2e.h"
+#include "cint2e.h"
+
+#define G_F32(g, envs)  ((float *)((g) + (envs)->g_size * 3 * SIMDD))
+
+#define DEF_GXYZ_F32(G, GX, GY, GZ) \
+        float *RESTRICT GX = G; \
+        float *RESTRICT GY = G + envs->g_size     * SIMDD; \
+        float *RESTRICT GZ = G + envs->g_size * 2 * SIMDD
+
+/*
+ * Two (root, lane) blocks per register, i.e. a __m512 for SIMDD=8, and a
+ * single block for the tail.  g is stored in blocks of SIMDD floats which
+ * are aligned to SIMDD*sizeof(float) bytes.
+ */
+typedef float __MF2 __attribute__((vector_size(SIMDD*2*sizeof(float)),
+                                   aligned(SIMDD*sizeof(float)), may_alias));
+typedef float __MF1 __attribute__((vector_size(SIMDD*sizeof(float)), may_alias));
+#define MF2(p)  (*(__MF2 *)(p))
+#define MF1(p)  (*(__MF1 *)(p))
+
+/* p0 = c * p1 + f2 * b2 * p2 + f3 * b3 * p3 */
+static inline void _vrr_f32(float *p0, float *p1, float *c,
+                            float *p2, float *b2, float f2,
+                            float *p3, float *b3, float f3, int nrs)
+{
+        int i = 0;
+        for (; i + SIMDD*2 <= nrs; i += SIMDD*2) {
+                MF2(p0+i) = MF2(c+i) * MF2(p1+i) + f2 * MF2(b2+i) * MF2(p2+i)
+                          + f3 * MF2(b3+i) * MF2(p3+i);
+        }
+        if (i < nrs) {
+                MF1(p0+i) = MF1(c+i) * MF1(p1+i) + f2 * MF1(b2+i) * MF1(p2+i)
+                          + f3 * MF1(b3+i) * MF1(p3+i);
+        }
+}
+
+static void _g0_2d_f32(float *g, double *w, Rys2eT *bc, CINTEnvVars *envs)
+{
+        int nroots = envs->nrys_roots;
+        int nmax = envs->li_ceil + envs->lj_ceil;
+        int mmax = envs->lk_ceil + envs->ll_ceil;
+        size_t dm = envs->g2d_klmax * SIMDD;
+        size_t dn = envs->g2d_ijmax * SIMDD;
+        int nrs = nroots * SIMDD;
+        int i, m, n;
+        DEF_GXYZ_F32(g, gx, gy, gz);
+        ALIGNMM float c00x[MXRYSROOTS*SIMDD];
+        ALIGNMM float c00y[MXRYSROOTS*SIMDD];
+        ALIGNMM float c00z[MXRYSROOTS*SIMDD];
+        ALIGNMM float c0px[MXRYSROOTS*SIMDD];
+        ALIGNMM float c0py[MXRYSROOTS*SIMDD];
+        ALIGNMM float c0pz[MXRYSROOTS*SIMDD];
+        ALIGNMM float b00[MXRYSROOTS*SIMDD];
+        ALIGNMM float b10[MXRYSROOTS*SIMDD];
+        ALIGNMM float b01[MXRYSROOTS*SIMDD];
+        size_t p0, p1, p2, p3;
+        float fn, fm;
+
+        for (i = 0; i < nrs; i++) {
+                c00x[i] = bc->c00x[i];
+                c00y[i] = bc->c00y[i];
+                c00z[i] = bc->c00z[i];
+                c0px[i] = bc->c0px[i];
+                c0py[i] = bc->c0py[i];
+                c0pz[i] = bc->c0pz[i];
+                b00[i] = bc->b00[i];
+                b10[i] = bc->b10[i];
+                b01[i] = bc->b01[i];
+                gx[i] = 1;
+                gy[i] = 1;
+                gz[i] = w[i];
+        }
+
+        // g(n+1,0) = c00 g(n,0) + n b10 g(n-1,0)
+        for (n = 0; n < nmax; n++) {
+                fn = n;
+                p0 = (n+1) * dn;
+                p1 = n * dn;
+                p2 = n > 0 ? p1 - dn : p1;
+                _vrr_f32(gx+p0, gx+p1, c00x, gx+p2, b10, fn, gx+p1, b00, 0, nrs);
+                _vrr_f32(gy+p0, gy+p1, c00y, gy+p2, b10, fn, gy+p1, b00, 0, nrs);
+                _vrr_f32(gz+p0, gz+p1, c00z, gz+p2, b10, fn, gz+p1, b00, 0, nrs);
+        }
+
+        // g(0,m+1) = c0p g(0,m) + m b01 g(0,m-1)
+        for (m = 0; m < mmax; m++) {
+                fm = m;
+                p0 = (m+1) * dm;
+                p1 = m * dm;
+                p2 = m > 0 ? p1 - dm : p1;
+                _vrr_f32(gx+p0, gx+p1, c0px, gx+p2, b01, fm, gx+p1, b00, 0, nrs);
+                _vrr_f32(gy+p0, gy+p1, c0py, gy+p2, b01, fm, gy+p1, b00, 0, nrs);
+                _vrr_f32(gz+p0, gz+p1, c0pz, gz+p2, b01, fm, gz+p1, b00, 0, nrs);
+        }
+
+        // g(n+1,m) = c00 g(n,m) + n b10 g(n-1,m) + m b00 g(n,m-1)
+        for (m = 1; m <= mmax; m++) {
+                fm = m;
+                for (n = 0; n < nmax; n++) {
+                        fn = n;
+                        p0 = (n+1) * dn + m * dm;
+                        p1 = p0 - dn;
+                        p2 = n > 0 ? p1 - dn : p1;
+                        p3 = p1 - dm;
+                        _vrr_f32(gx+p0, gx+p1, c00x, gx+p2, b10, fn, gx+p3, b00, fm, nrs);
+                        _vrr_f32(gy+p0, gy+p1, c00y, gy+p2, b10, fn, gy+p3, b00, fm, nrs);
+                        _vrr_f32(gz+p0, gz+p1, c00z, gz+p2, b10, fn, gz+p3, b00, fm, nrs);
+                }
+        }
+}
+
+/*
+ * g[n] = r * g[n-d1] + g[n-d1+d2] for n in [ptr, ptr+len), in units of
+ * (root, lane) blocks
+ */
+static inline void _hrr_f32(float *g, double *r, int ptr, int len, int d1, int d2,
+                            CINTEnvVars *envs)
+{
+        DEF_GXYZ_F32(g, gx, gy, gz);
+        float rx = r[0];
+        float ry = r[1];
+        float rz = r[2];
+        long n = (long)ptr * SIMDD;
+        long n1 = (long)(ptr + len) * SIMDD;
+        long o1 = (long)d1 * SIMDD;
+        long o2 = (long)(d1 - d2) * SIMDD;
+        for (; n + SIMDD*2 <= n1; n += SIMDD*2) {
+                MF2(gx+n) = rx * MF2(gx+n-o1) + MF2(gx+n-o2);
+                MF2(gy+n) = ry * MF2(gy+n-o1) + MF2(gy+n-o2);
+                MF2(gz+n) = rz * MF2(gz+n-o1) + MF2(gz+n-o2);
+        }
+        if (n < n1) {
+                MF1(gx+n) = rx * MF1(gx+n-o1) + MF1(gx+n-o2);
+                MF1(gy+n) = ry * MF1(gy+n-o1) + MF1(gy+n-o2);
+                MF1(gz+n) = rz * MF1(gz+n-o1) + MF1(gz+n-o2);
+        }
+}
+
+/* 2d is based on l,j */
+static void _g0_lj_4d_f32(float *g, CINTEnvVars *envs)
+{
+        int li = envs->li_ceil;
+        int lk = envs->lk_ceil;
+        int lj = envs->lj_ceil;
+        int nmax = envs->li_ceil + envs->lj_ceil;
+        int mmax = envs->lk_ceil + envs->ll_ceil;
+        int nroots = envs->nrys_roots;
+        int di = envs->g_stride_i;
+        int dk = envs->g_stride_k;
+        int dl = envs->g_stride_l;
+        int dj = envs->g_stride_j;
+        int i, j, k, l;
+        // g(i,...,j) = rirj * g(i-1,...,j) +  g(i-1,...,j+1)
+        for (i = 1; i <= li; i++) {
+        for (j = 0; j <= nmax-i; j++) {
+        for (l = 0; l <= mmax; l++) {
+                _hrr_f32(g, envs->rirj, j*dj+l*dl+i*di, nroots, di, dj, envs);
+        } } }
+        // g(...,k,l,..) = rkrl * g(...,k-1,l,..) + g(...,k-1,l+1,..)
+        for (j = 0; j <= lj; j++) {
+        for (k = 1; k <= lk; k++) {
+        for (l = 0; l <= mmax-k; l++) {
+                _hrr_f32(g, envs->rkrl, j*dj+l*dl+k*dk, dk, dk, dl, envs);
+        } } }
+}
+
+/* 2d is based on k,j */
+static void _g0_kj_4d_f32(float *g, CINTEnvVars *envs)
+{
+        int li = envs->li_ceil;
+        int ll = envs->ll_ceil;
+        int lj = envs->lj_ceil;
+        int nmax = envs->li_ceil + envs->lj_ceil;
+        int mmax = envs->lk_ceil + envs->ll_ceil;
+        int nroots = envs->nrys_roots;
+        int di = envs->g_stride_i;
+        int dk = envs->g_stride_k;
+        int dl = envs->g_stride_l;
+        int dj = envs->g_stride_j;
+        int i, j, k, l;
+        // g(i,...,j) = rirj * g(i-1,...,j) +  g(i-1,...,j+1)
+        for (i = 1; i <= li; i++) {
+        for (j = 0; j <= nmax-i; j++) {
+        for (k = 0; k <= mmax; k++) {
+                _hrr_f32(g, envs->rirj, j*dj+k*dk+i*di, nroots, di, dj, envs);
+        } } }
+        // g(...,k,l,..) = rkrl * g(...,k,l-1,..) + g(...,k+1,l-1,..)
+        for (j = 0; j <= lj; j++) {
+        for (l = 1; l <= ll; l++) {
+        for (k = 0; k <= mmax-l; k++) {
+                _hrr_f32(g, envs->rkrl, j*dj+l*dl+k*dk, dk, dl, dk, envs);
+        } } }
+}
+
+/* 2d is based on i,l */
+static void _g0_il_4d_f32(float *g, CINTEnvVars *envs)
+{
+        int lj = envs->lj_ceil;
+        int lk = envs->lk_ceil;
+        int ll = envs->ll_ceil;
+        int nmax = envs->li_ceil + envs->lj_ceil;
+        int mmax = envs->lk_ceil + envs->ll_ceil;
+        int nroots = envs->nrys_roots;
+        int di = envs->g_stride_i;
+        int dk = envs->g_stride_k;
+        int dl = envs->g_stride_l;
+        int dj = envs->g_stride_j;
+        int i, j, k, l;
+        // g(...,k,l,..) = rkrl * g(...,k-1,l,..) + g(...,k-1,l+1,..)
+        for (k = 1; k <= lk; k++) {
+        for (l = 0; l <= mmax-k; l++) {
+        for (i = 0; i <= nmax; i++) {
+                _hrr_f32(g, envs->rkrl, l*dl+k*dk+i*di, nroots, dk, dl, envs);
+        } } }
+        // g(i,...,j) = rirj * g(i,...,j-1) +  g(i+1,...,j-1)
+        for (j = 1; j <= lj; j++) {
+        for (l = 0; l <= ll; l++) {
+        for (k = 0; k <= lk; k++) {
+                _hrr_f32(g, envs->rirj, j*dj+l*dl+k*dk, dk-di*j, dj, di, envs);
+        } } }
+}
+
+/* 2d is based on i,k */
+static void _g0_ik_4d_f32(float *g, CINTEnvVars *envs)
+{
+        int lj = envs->lj_ceil;
+        int ll = envs->ll_ceil;
+        int lk = envs->lk_ceil;
+        int nmax = envs->li_ceil + envs->lj_ceil;
+        int mmax = envs->lk_ceil + envs->ll_ceil;
+        int nroots = envs->nrys_roots;
+        int di = envs->g_stride_i;
+        int dk = envs->g_stride_k;
+        int dl = envs->g_stride_l;
+        int dj = envs->g_stride_j;
+        int i, j, k, l;
+        // g(...,k,l,..) = rkrl * g(...,k,l-1,..) + g(...,k+1,l-1,..)
+        for (l = 1; l <= ll; l++) {
+        for (k = 0; k <= mmax-l; k++) {
+        for (i = 0; i <= nmax; i++) {
+                _hrr_f32(g, envs->rkrl, l*dl+k*dk+i*di, nroots, dl, dk, envs);
+        } } }
+        // g(i,...,j) = rirj * g(i,...,j-1) +  g(i+1,...,j-1)
+        for (j = 1; j <= lj; j++) {
+        for (l = 0; l <= ll; l++) {
+        for (k = 0; k <= lk; k++) {
+                _hrr_f32(g, envs->rirj, j*dj+l*dl+k*dk, dk-di*j, dj, di, envs);
+        } } }
+}
+
+/*
+ * Replaces f_g0_2d4d.  On entry, gz holds the double precision initial
+ * values set by CINTg0_2e.  On exit, G_F32(g) holds the float g arrays.
+ */
+void CINTg0_2e_2d4d_f32(double *g, Rys2eT *bc, CINTEnvVars *envs)
+{
+        double *gz = g + envs->g_size * 2 * SIMDD;
+        float *gf = G_F32(g, envs);
+        _g0_2d_f32(gf, gz, bc, envs);
+
+        int ibase = envs->li_ceil > envs->lj_ceil;
+        int kbase = envs->lk_ceil > envs->ll_ceil;
+        if (kbase) {
+                if (ibase) {
+                        _g0_ik_4d_f32(gf, envs);
+                } else {
+                        _g0_kj_4d_f32(gf, envs);
+                }
+        } else {
+                if (ibase) {
+                        _g0_il_4d_f32(gf, envs);
+                } else {
+                        _g0_lj_4d_f32(gf, envs);
+                }
+        }
+}
+
+void CINTgout2e_f32(double *gout, double *g, int *idx, CINTEnvVars *envs)
+{
+        int nrys_roots = envs->nrys_roots;
+        int nf = envs->nf;
+        int nfc = nf;
+        float *gf = G_F32(g, envs);
+        DECLARE_GOUT;
+        float *RESTRICT px, *RESTRICT py, *RESTRICT pz;
+        ALIGNMM float s2buf[SIMDD*2];
+        __MF2 s2;
+        __MF1 s;
+        int i, n;
+
+        for (n = 0; n < nf; n++) {
+                px = gf + idx[0+n*3] * SIMDD;
+                py = gf + idx[1+n*3] * SIMDD;
+                pz = gf + idx[2+n*3] * SIMDD;
+                s = MF1(px) * MF1(py) * MF1(pz);
+                i = 1;
+                if (nrys_roots >= 3) {
+                        s2 = MF2(px+SIMDD) * MF2(py+SIMDD) * MF2(pz+SIMDD);
+                        for (i = 3; i + 1 < nrys_roots; i += 2) {
+                                s2 += MF2(px+i*SIMDD) * MF2(py+i*SIMDD) * MF2(pz+i*SIMDD);
+                        }
+                        MF2(s2buf) = s2;
+                        s += MF1(s2buf) + MF1(s2buf+SIMDD);
+                }
+                for (; i < nrys_roots; i++) {
+                        s += MF1(px+i*SIMDD) * MF1(py+i*SIMDD) * MF1(pz+i*SIMDD);
+                }
+                GOUT_SCATTER(gout, n, __builtin_convertvector(s, __MD));
+        }
+}
+
+#define MIXED_PRECISION_LMAX    8
+
+/*
+ * Switch int2e to the mixed precision kernels if requested in env.  Shell
+ * quartets handled by the unrolled double precision kernels or above
+ * MIXED_PRECISION_LMAX are not affected.
+ */
+void CINTmixed_precision_int2e(CINTEnvVars *envs)
+{
+        int l_tot = envs->li_ceil + envs->lj_ceil + envs->lk_ceil + envs->ll_ceil;
+        if (envs->params[PTR_MIXED_PRECISION] != 0 && envs->rys_order > 2 &&
+            l_tot <= MIXED_PRECISION_LMAX && envs->f_gout == &CINTgout2e) {
+                envs->f_g0_2d4d = &CINTg0_2e_2d4d_f32;
+                envs->f_gout = &CINTgout2e_f32;
+        }
+}
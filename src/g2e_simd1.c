@@ -4250,7 +4250,7 @@ int CINTg0_2e_simd1(double *g, double *cutoff,
         a0 = a1 / (aij + akl);
         fac1 = sqrt(a0 / (a1 * a1 * a1)) * envs->fac[idsimd];
         x = a0 * rr;
-        const double omega = envs->env[PTR_RANGE_OMEGA];
+        const double omega = envs->params[PTR_RANGE_OMEGA];
         double theta = 0;
         if (omega == 0.) {
                 CINTrys_roots(nroots, x, u, w);
@@ -36,6 +36,7 @@ void CINTinit_int3c1e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->atm = atm;
         envs->bas = bas;
         envs->env = env;
+        envs->params = CINTparams_env(env);
         envs->shls = shls;
 
         int i_sh = shls[0];
@@ -55,10 +56,10 @@ void CINTinit_int3c1e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->nfl = 1;
         envs->nf = envs->nfi * envs->nfk * envs->nfj;
         envs->common_factor = 1;
-        if (env[PTR_EXPCUTOFF] == 0) {
+        if (envs->params[PTR_EXPCUTOFF] == 0) {
                 envs->expcutoff = EXPCUTOFF;
         } else {
-                envs->expcutoff = MAX(MIN_EXPCUTOFF, env[PTR_EXPCUTOFF]);
+                envs->expcutoff = MAX(MIN_EXPCUTOFF, envs->params[PTR_EXPCUTOFF]);
         }
 
         envs->gbits = ng[GSHIFT];
@@ -231,12 +232,12 @@ void CINTg3c1e_nuc(double *g, CINTEnvVars *envs, int count, int nuc_id)
         aijk = MM_LOAD(envs->ai) + MM_LOAD(envs->aj) + MM_LOAD(envs->ak);
         MM_STORE(tau, aijk);
         for (k = 0; k < count; k++) {
-                tau[k] = CINTnuc_mod(tau[k], nuc_id, atm, env);
+                tau[k] = CINTnuc_mod(tau[k], nuc_id, atm, nuc_id < 0 ? envs->params : env);
         }
 
         if (nuc_id < 0) {
                 fac1 = scale * MM_LOAD(envs->fac) * MM_LOAD(tau) / aijk;
-                cr = env + PTR_RINV_ORIG;
+                cr = envs->params + PTR_RINV_ORIG;
         } else if (atm(NUC_MOD_OF,nuc_id) == FRAC_CHARGE_NUC) {
                 fac1 = scale * MM_SET1(-env[atm[PTR_FRAC_CHARGE+nuc_id*ATM_SLOTS]]);
                 fac1 = fac1 * MM_LOAD(envs->fac) * MM_LOAD(tau) / aijk;
@@ -36,6 +36,7 @@ void CINTinit_int3c2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->atm = atm;
         envs->bas = bas;
         envs->env = env;
+        envs->params = CINTparams_env(env);
         envs->shls = shls;
 
         int i_sh = shls[0];
@@ -62,10 +63,10 @@ void CINTinit_int3c2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->common_factor = (M_PI*M_PI*M_PI)*2/SQRTPI
                 * CINTcommon_fac_sp(envs->i_l) * CINTcommon_fac_sp(envs->j_l)
                 * CINTcommon_fac_sp(envs->k_l);
-        if (env[PTR_EXPCUTOFF] == 0) {
+        if (envs->params[PTR_EXPCUTOFF] == 0) {
                 envs->expcutoff = EXPCUTOFF;
         } else {
-                envs->expcutoff = MAX(MIN_EXPCUTOFF, env[PTR_EXPCUTOFF]);
+                envs->expcutoff = MAX(MIN_EXPCUTOFF, envs->params[PTR_EXPCUTOFF]);
         }
 
         envs->gbits = ng[GSHIFT];
@@ -79,7 +80,7 @@ void CINTinit_int3c2e_EnvVars(CINTEnvVars *envs, int *ng, int *shls,
         envs->ll_ceil = envs->k_l + ng[KINC];
         int rys_order =(envs->li_ceil + envs->lj_ceil + envs->ll_ceil)/2 + 1;
         int nrys_roots = rys_order;
-        double omega = env[PTR_RANGE_OMEGA];
+        double omega = envs->params[PTR_RANGE_OMEGA];
         if (omega < 0 && rys_order <= 3) {
                 nrys_roots *= 2;
         }
@@ -36,6 +36,22 @@ double CINTsquare_dist(const double *r1, const double *r2);
 
 double CINTgto_norm(int n, double a);
 
+double *CINTparams_env(double *env);
+double *CINTparams_grids(double *env, int start);
+
+CACHE_SIZE_T CINTmax_cache_size(CACHE_SIZE_T (*intor)(), int *shls_slice,
+                                int nrange, int *atm, int natm,
+                                int *bas, int nbas, double *env);
+
+typedef struct CINTScheduler CINTScheduler;
+int CINTpair_costs(double *costs, CINTOpt *opt, int *bra_pairs, size_t nbra,
+                   int *ket_pairs, size_t nket);
+double CINTcost_threshold(size_t *nquartets, CINTOpt *opt, int *ao_loc,
+                          size_t max_bytes, size_t overhead);
+CINTScheduler *CINTsched_create(double *costs, size_t ntask);
+int CINTsched_next(CINTScheduler *sched, size_t *task0, size_t *task1);
+void CINTsched_del(CINTScheduler *sched);
+
 
 #ifdef WITH_CINT2_INTERFACE
 #define ALL_CINT(NAME) \
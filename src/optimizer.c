@@ -36,6 +36,8 @@
 #include "rys_roots.h"
 #include "misc.h"
 
+static void _basis_data_release(CINTBasisData *bd);
+
 // generate caller to CINTinit_2e_optimizer for each type of function
 void CINTinit_2e_optimizer(CINTOpt **opt, int *atm, int natm,
                            int *bas, int nbas, double *env)
@@ -47,6 +49,10 @@ void CINTinit_2e_optimizer(CINTOpt **opt, int *atm, int natm,
         opt0->nbas = nbas;
         opt0->log_max_coeff = NULL;
         opt0->pairdata = NULL;
+        opt0->ijkl_inc = 0;
+        opt0->pair_shift = NULL;
+        opt0->basis = NULL;
+        opt0->expcutoff = EXPCUTOFF;
         *opt = opt0;
 }
 void CINTinit_optimizer(CINTOpt **opt, int *atm, int natm,
@@ -63,23 +69,29 @@ void CINTdel_2e_optimizer(CINTOpt **opt)
         }
 
         if (opt0->index_xyz_array != NULL) {
-                free(opt0->index_xyz_array[0]);
+                // the index_xyz tables are owned by the shared cache
                 free(opt0->index_xyz_array);
         }
 
-        if (opt0->non0ctr != NULL) {
+        CINTBasisData *bd = opt0->basis;
+        if (opt0->non0ctr != NULL &&
+            (bd == NULL || opt0->non0ctr != bd->non0ctr)) {
                 free(opt0->sortedidx[0]);
                 free(opt0->sortedidx);
                 free(opt0->non0ctr[0]);
                 free(opt0->non0ctr);
         }
 
-        if (opt0->log_max_coeff != NULL) {
+        if (opt0->log_max_coeff != NULL &&
+            (bd == NULL || opt0->log_max_coeff != bd->log_max_coeff)) {
                 free(opt0->log_max_coeff[0]);
                 free(opt0->log_max_coeff);
         }
 
         CINTdel_pairdata_optimizer(opt0);
+        if (bd != NULL) {
+                _basis_data_release(bd);
+        }
 
         free(opt0);
         *opt = NULL;
@@ -95,157 +107,182 @@ void CINTno_optimizer(CINTOpt **opt, int *atm, int natm,
         *opt = NULL;
 }
 
-static int _make_fakebas(int *fakebas, int *bas, int nbas, double *env)
+/*
+ * The index_xyz tables only depend on the angular momenta and the strides
+ * of the g arrays.  They are generated on first use and shared by all
+ * optimizers of the process.  An entry is never modified after it is
+ * published, so lookups do not need a lock.  New entries are pushed to the
+ * bucket lists with compare-and-swap.
+ */
+#define INDEX_XYZ_BUCKETS       1024
+static IndexXYZ *_index_xyz_cache[INDEX_XYZ_BUCKETS];
+
+static unsigned int _index_xyz_key(int *key, void (*findex_xyz)(), CINTEnvVars *envs)
 {
+        key[0] = envs->i_l;
+        key[1] = envs->j_l;
+        key[4] = envs->g_stride_i;
+        key[5] = envs->g_stride_j;
+        key[8] = envs->g_size;
+        if (findex_xyz == &CINTg2c_index_xyz) {
+                // k, l are not initialized for two-center integrals
+                key[2] = 0;
+                key[3] = 0;
+                key[6] = 0;
+                key[7] = 0;
+        } else {
+                key[2] = envs->k_l;
+                key[3] = envs->l_l;
+                key[6] = envs->g_stride_k;
+                key[7] = envs->g_stride_l;
+        }
+        unsigned int h = (unsigned int)(size_t)findex_xyz;
         int i;
-        int max_l = 0;
-        for (i = 0; i < nbas; i++) {
-                max_l = MAX(max_l, bas(ANG_OF,i));
+        for (i = 0; i < INDEX_XYZ_KEYLEN; i++) {
+                h = h * 31 + (unsigned int)key[i];
+        }
+        return h % INDEX_XYZ_BUCKETS;
+}
+
+static IndexXYZ *_index_xyz_search(IndexXYZ *node, IndexXYZ *end,
+                                   void (*findex_xyz)(), int *key)
+{
+        for (; node != end; node = node->next) {
+                if (node->findex_xyz == findex_xyz &&
+                    memcmp(node->key, key, sizeof(int) * INDEX_XYZ_KEYLEN) == 0) {
+                        return node;
+                }
         }
+        return NULL;
+}
 
-        int fakenbas = max_l + 1;
-        for (i = 0; i < BAS_SLOTS*fakenbas; i++) {
-                fakebas[i] = 0;
+/*
+ * Slow path of CINTOpt_index_xyz. Looks up (or generates) the shared
+ * index_xyz table for envs and caches the pointer in opt.
+ */
+int *CINTOpt_load_index_xyz(CINTOpt *opt, int ptr, void (*findex_xyz)(),
+                            CINTEnvVars *envs)
+{
+        int key[INDEX_XYZ_KEYLEN];
+        unsigned int bucket = _index_xyz_key(key, findex_xyz, envs);
+        IndexXYZ **phead = _index_xyz_cache + bucket;
+        IndexXYZ *head = __atomic_load_n(phead, __ATOMIC_ACQUIRE);
+        IndexXYZ *node = _index_xyz_search(head, NULL, findex_xyz, key);
+
+        if (node == NULL) {
+                node = malloc(sizeof(IndexXYZ) + sizeof(int) * envs->nf * 3);
+                node->findex_xyz = findex_xyz;
+                memcpy(node->key, key, sizeof(int) * INDEX_XYZ_KEYLEN);
+                (*findex_xyz)(node->idx, envs);
+
+                IndexXYZ *scanned = NULL;
+                IndexXYZ *found;
+                node->next = head;
+                while (!__atomic_compare_exchange_n(phead, &node->next, node, 0,
+                                                    __ATOMIC_ACQ_REL,
+                                                    __ATOMIC_ACQUIRE)) {
+                        // Another thread inserted entries. Only the new
+                        // entries need to be checked.
+                        found = _index_xyz_search(node->next, scanned,
+                                                  findex_xyz, key);
+                        if (found != NULL) {
+                                free(node);
+                                node = found;
+                                break;
+                        }
+                        scanned = node->next;
+                }
         }
-        // fakebas only initializes ANG_OF, since the others does not
-        // affect index_xyz
-        for (i = 0; i <= max_l; i++) {
-                fakebas[BAS_SLOTS*i+ANG_OF] = i;
+        if (opt != NULL && opt->index_xyz_array != NULL) {
+                __atomic_store_n(opt->index_xyz_array + ptr, node->idx,
+                                 __ATOMIC_RELEASE);
         }
-        return max_l;
+        return node->idx;
 }
-static int *_allocate_index_xyz(CINTOpt *opt, int max_l, int l_allow, int order)
+
+/*
+ * Release the shared index_xyz tables. It can only be called when no
+ * optimizer is in use.
+ */
+void CINTdel_index_xyz_cache(void)
 {
+        IndexXYZ *node, *next;
         int i;
-        int cumcart = (l_allow+1) * (l_allow+2) * (l_allow+3) / 6;
+        for (i = 0; i < INDEX_XYZ_BUCKETS; i++) {
+                node = __atomic_exchange_n(_index_xyz_cache + i, NULL,
+                                           __ATOMIC_ACQ_REL);
+                for (; node != NULL; node = next) {
+                        next = node->next;
+                        free(node);
+                }
+        }
+}
+
+/*
+ * Allocates the lookup table of index_xyz pointers. The tables are attached
+ * on first use by CINTOpt_index_xyz.
+ */
+static void gen_idx(CINTOpt *opt, int order, int *bas, int nbas)
+{
+        int i;
+        int max_l = 0;
+        for (i = 0; i < nbas; i++) {
+                max_l = MAX(max_l, bas(ANG_OF,i));
+        }
+
         size_t ll = max_l + 1;
-        size_t cc = cumcart;
         for (i = 1; i < order; i++) {
                 ll *= LMAX1;
-                cc *= cumcart;
-        }
-        int *buf = malloc(sizeof(int) * cc * 3);
-        int **ppbuf = malloc(sizeof(int*) * ll);
-        ppbuf[0] = buf;
-        for (i = 1; i < ll; i++) {
-                ppbuf[i] = NULL;
-        }
-        opt->index_xyz_array = ppbuf;
-        return buf;
-}
-static void gen_idx(CINTOpt *opt, void (*finit)(), void (*findex_xyz)(),
-                    int order, int l_allow, int *ng,
-                    int *atm, int natm, int *bas, int nbas, double *env)
-{
-        int i, j, k, l, ptr;
-        int fakebas[BAS_SLOTS*LMAX1];
-        int max_l = _make_fakebas(fakebas, bas, nbas, env);
-        int fakenbas = max_l+1;
-        // index_xyz bufsize may blow up for large max_l
-        l_allow = MIN(max_l, l_allow);
-        int *buf = _allocate_index_xyz(opt, max_l, l_allow, order);
-
-        CINTEnvVars envs;
-        int shls[4] = {0,};
-        if (order == 2) {
-                for (i = 0; i <= l_allow; i++) {
-                for (j = 0; j <= l_allow; j++) {
-                        shls[0] = i; shls[1] = j;
-                        (*finit)(&envs, ng, shls, atm, natm, fakebas, fakenbas, env);
-                        ptr = i*LMAX1 + j;
-                        opt->index_xyz_array[ptr] = buf;
-                        (*findex_xyz)(buf, &envs);
-                        buf += envs.nf * 3;
-                } }
-
-        } else if (order == 3) {
-                for (i = 0; i <= l_allow; i++) {
-                for (j = 0; j <= l_allow; j++) {
-                for (k = 0; k <= l_allow; k++) {
-                        shls[0] = i; shls[1] = j; shls[2] = k;
-                        (*finit)(&envs, ng, shls, atm, natm, fakebas, fakenbas, env);
-                        ptr = i*LMAX1*LMAX1 + j*LMAX1 + k;
-                        opt->index_xyz_array[ptr] = buf;
-                        (*findex_xyz)(buf, &envs);
-                        buf += envs.nf * 3;
-                } } }
-
-        } else {
-                for (i = 0; i <= l_allow; i++) {
-                for (j = 0; j <= l_allow; j++) {
-                for (k = 0; k <= l_allow; k++) {
-                for (l = 0; l <= l_allow; l++) {
-                        shls[0] = i; shls[1] = j; shls[2] = k; shls[3] = l;
-                        (*finit)(&envs, ng, shls, atm, natm, fakebas, fakenbas, env);
-                        ptr = i*LMAX1*LMAX1*LMAX1
-                            + j*LMAX1*LMAX1
-                            + k*LMAX1
-                            + l;
-                        opt->index_xyz_array[ptr] = buf;
-                        (*findex_xyz)(buf, &envs);
-                        buf += envs.nf * 3;
-                } } } }
         }
+        opt->index_xyz_array = calloc(ll, sizeof(int*));
 }
 
 void CINTall_1e_optimizer(CINTOpt **opt, int *ng,
                           int *atm, int natm, int *bas, int nbas, double *env)
 {
         CINTinit_2e_optimizer(opt, atm, natm, bas, nbas, env);
-        CINTOpt_set_log_maxc(*opt, atm, natm, bas, nbas, env);
-        CINTOpt_set_non0coeff(*opt, atm, natm, bas, nbas, env);
-        gen_idx(*opt, &CINTinit_int1e_EnvVars, &CINTg2c_index_xyz,
-                2, ANG_MAX, ng, atm, natm, bas, nbas, env);
+        CINTOpt_set_basis_data(*opt, NULL, atm, natm, bas, nbas, env);
+        gen_idx(*opt, 2, bas, nbas);
 }
 
 void CINTall_2e_optimizer(CINTOpt **opt, int *ng,
                           int *atm, int natm, int *bas, int nbas, double *env)
 {
         CINTinit_2e_optimizer(opt, atm, natm, bas, nbas, env);
-        CINTOpt_setij(*opt, ng, atm, natm, bas, nbas, env);
-        CINTOpt_set_non0coeff(*opt, atm, natm, bas, nbas, env);
-        gen_idx(*opt, &CINTinit_int2e_EnvVars, &CINTg4c_index_xyz,
-                4, 6, ng, atm, natm, bas, nbas, env);
+        CINTOpt_set_basis_data(*opt, ng, atm, natm, bas, nbas, env);
+        gen_idx(*opt, 4, bas, nbas);
 }
 
 void CINTall_3c2e_optimizer(CINTOpt **opt, int *ng,
                             int *atm, int natm, int *bas, int nbas, double *env)
 {
         CINTinit_2e_optimizer(opt, atm, natm, bas, nbas, env);
-        CINTOpt_setij(*opt, ng, atm, natm, bas, nbas, env);
-        CINTOpt_set_non0coeff(*opt, atm, natm, bas, nbas, env);
-        gen_idx(*opt, &CINTinit_int3c2e_EnvVars, &CINTg4c_index_xyz,
-                3, 12, ng, atm, natm, bas, nbas, env);
+        CINTOpt_set_basis_data(*opt, ng, atm, natm, bas, nbas, env);
+        gen_idx(*opt, 3, bas, nbas);
 }
 
 void CINTall_2c2e_optimizer(CINTOpt **opt, int *ng,
                             int *atm, int natm, int *bas, int nbas, double *env)
 {
         CINTinit_2e_optimizer(opt, atm, natm, bas, nbas, env);
-        CINTOpt_set_log_maxc(*opt, atm, natm, bas, nbas, env);
-        CINTOpt_set_non0coeff(*opt, atm, natm, bas, nbas, env);
-        gen_idx(*opt, &CINTinit_int2c2e_EnvVars, &CINTg2c_index_xyz,
-                2, ANG_MAX, ng, atm, natm, bas, nbas, env);
+        CINTOpt_set_basis_data(*opt, NULL, atm, natm, bas, nbas, env);
+        gen_idx(*opt, 2, bas, nbas);
 }
 
 void CINTall_3c1e_optimizer(CINTOpt **opt, int *ng,
                             int *atm, int natm, int *bas, int nbas, double *env)
 {
         CINTinit_2e_optimizer(opt, atm, natm, bas, nbas, env);
-        CINTOpt_setij(*opt, ng, atm, natm, bas, nbas, env);
-        CINTOpt_set_non0coeff(*opt, atm, natm, bas, nbas, env);
-        gen_idx(*opt, &CINTinit_int3c1e_EnvVars, &CINTg4c_index_xyz,
-                3, 12, ng, atm, natm, bas, nbas, env);
+        CINTOpt_set_basis_data(*opt, ng, atm, natm, bas, nbas, env);
+        gen_idx(*opt, 3, bas, nbas);
 }
 
 void CINTall_1e_grids_optimizer(CINTOpt **opt, int *ng,
                                 int *atm, int natm, int *bas, int nbas, double *env)
 {
         CINTinit_2e_optimizer(opt, atm, natm, bas, nbas, env);
-        CINTOpt_set_log_maxc(*opt, atm, natm, bas, nbas, env);
-        CINTOpt_set_non0coeff(*opt, atm, natm, bas, nbas, env);
-        gen_idx(*opt, &CINTinit_int1e_grids_EnvVars, &CINTg2c_index_xyz,
-                2, ANG_MAX, ng, atm, natm, bas, nbas, env);
+        CINTOpt_set_basis_data(*opt, NULL, atm, natm, bas, nbas, env);
+        gen_idx(*opt, 2, bas, nbas);
 }
 
 #ifdef WITH_F12
@@ -253,10 +290,8 @@ void CINTall_2e_stg_optimizer(CINTOpt **opt, int *ng,
                               int *atm, int natm, int *bas, int nbas, double *env)
 {
         CINTinit_2e_optimizer(opt, atm, natm, bas, nbas, env);
-        CINTOpt_setij(*opt, ng, atm, natm, bas, nbas, env);
-        CINTOpt_set_non0coeff(*opt, atm, natm, bas, nbas, env);
-        gen_idx(*opt, &CINTinit_int2e_stg_EnvVars, &CINTg4c_index_xyz,
-                4, 6, ng, atm, natm, bas, nbas, env);
+        CINTOpt_set_basis_data(*opt, ng, atm, natm, bas, nbas, env);
+        gen_idx(*opt, 4, bas, nbas);
 }
 #endif
 
@@ -356,95 +391,533 @@ int CINTset_pairdata(PairData *pairdata, double *ai, double *aj, double *ri, dou
         return empty;
 }
 
-void CINTOpt_setij(CINTOpt *opt, int *ng,
-                   int *atm, int natm, int *bas, int nbas, double *env)
+/*
+ * Basis data shared by the optimizers of the same basis set.
+ *
+ * log_max_coeff, non0ctr, sortedidx only depend on the basis.  The pair data
+ * are stored once for all operators.  The cceij of the shared pair data do
+ * not include the angular momentum term of CINTset_pairdata
+ *      (li_ceil+lj_ceil) * log(dist_ij + 1)
+ * and the primitives are not screened.  Each optimizer keeps this term in
+ * pair_shift and its own NOVALUE table for the screening of shell pairs.
+ *
+ * The live basis data are kept in a registry.  A new optimizer looks up the
+ * basis data with the same shells, exponents, coefficients and coordinates.
+ * The lock only guards the registry and the reference counts.  The pair
+ * data are computed outside of the lock and published with a single
+ * compare-and-swap.
+ */
+static CINTBasisData *_basis_registry = NULL;
+static char _basis_lock = 0;
+// the last geom_id, updated under the lock
+static size_t _basis_geom_id = 0;
+
+static void _basis_lock_acquire()
 {
-        int i, j, ip, jp;
-        int iprim, jprim, li, lj;
-        double *ai, *aj, *ri, *rj;
-        double expcutoff;
-        if (env[PTR_EXPCUTOFF] == 0) {
-                expcutoff = EXPCUTOFF;
-        } else {
-                expcutoff = MAX(MIN_EXPCUTOFF, env[PTR_EXPCUTOFF]);
+        while (__atomic_test_and_set(&_basis_lock, __ATOMIC_ACQUIRE)) {
         }
+}
+static void _basis_lock_release()
+{
+        __atomic_clear(&_basis_lock, __ATOMIC_RELEASE);
+}
 
-        if (opt->log_max_coeff == NULL) {
-                CINTOpt_set_log_maxc(opt, atm, natm, bas, nbas, env);
+static int _basis_data_same_basis(CINTBasisData *bd, int *bas, int nbas, double *env)
+{
+        if (bd->nbas != nbas) {
+                return 0;
         }
-        double **log_max_coeff = opt->log_max_coeff;
-        double *log_maxci, *log_maxcj;
+        int i, iprim, ictr;
+        int *shell = bd->shells;
+        for (i = 0; i < nbas; i++, shell += 4) {
+                iprim = bas(NPRIM_OF, i);
+                ictr = bas(NCTR_OF, i);
+                if (shell[0] != bas(ATOM_OF, i) || shell[1] != bas(ANG_OF, i) ||
+                    shell[2] != iprim || shell[3] != ictr ||
+                    memcmp(bd->exps+bd->prim_loc[i], env+bas(PTR_EXP,i),
+                           sizeof(double)*iprim) != 0 ||
+                    memcmp(bd->coeffs+bd->coeff_loc[i], env+bas(PTR_COEFF,i),
+                           sizeof(double)*iprim*ictr) != 0) {
+                        return 0;
+                }
+        }
+        return 1;
+}
 
-        size_t tot_prim = 0;
+static int _basis_data_same_geom(CINTBasisData *bd, int *atm, int natm, double *env)
+{
+        if (bd->natm != natm) {
+                return 0;
+        }
+        int i;
+        for (i = 0; i < natm; i++) {
+                if (memcmp(bd->coords+i*3, env+atm(PTR_COORD,i), sizeof(double)*3) != 0) {
+                        return 0;
+                }
+        }
+        return 1;
+}
+
+static void _basis_data_set_geom(CINTBasisData *bd, int *atm, int natm, double *env)
+{
+        int i;
+        for (i = 0; i < natm; i++) {
+                memcpy(bd->coords+i*3, env+atm(PTR_COORD,i), sizeof(double)*3);
+        }
+}
+
+typedef struct {
+        int l;
+        int atom;
+        double amin;
+        int sh;
+} ShellKey;
+
+static int _shell_key_cmp(const void *a, const void *b)
+{
+        const ShellKey *ka = a;
+        const ShellKey *kb = b;
+        if (ka->l != kb->l) {
+                return ka->l - kb->l;
+        }
+        if (ka->atom != kb->atom) {
+                return ka->atom - kb->atom;
+        }
+        if (ka->amin != kb->amin) {
+                return (ka->amin < kb->amin) ? -1 : 1;
+        }
+        return ka->sh - kb->sh;
+}
+
+/*
+ * Shells sorted by angular momentum, atom and the most diffuse exponent.
+ * The quartets of the same angular momentum use the same kernel and index
+ * tables, shells on the same atom share the geometry.
+ */
+static void _basis_data_sort_shells(int *order, int *bas, int nbas, double *env)
+{
+        ShellKey *keys = malloc(sizeof(ShellKey) * MAX(nbas, 1));
+        double *ai;
+        int i, ip, iprim;
         for (i = 0; i < nbas; i++) {
-                tot_prim += bas(NPRIM_OF, i);
+                iprim = bas(NPRIM_OF, i);
+                ai = env + bas(PTR_EXP, i);
+                keys[i].l = bas(ANG_OF, i);
+                keys[i].atom = bas(ATOM_OF, i);
+                keys[i].amin = ai[0];
+                for (ip = 1; ip < iprim; ip++) {
+                        keys[i].amin = MIN(keys[i].amin, ai[ip]);
+                }
+                keys[i].sh = i;
         }
-        if (tot_prim == 0 || tot_prim > MAX_PGTO_FOR_PAIRDATA) {
-                return;
+        qsort(keys, nbas, sizeof(ShellKey), _shell_key_cmp);
+        for (i = 0; i < nbas; i++) {
+                order[i] = keys[i].sh;
         }
-        opt->pairdata = malloc(sizeof(PairData *) * MAX(nbas * nbas, 1));
-        PairData *pdata = malloc(sizeof(PairData) * tot_prim * tot_prim);
-        opt->pairdata[0] = pdata;
+        free(keys);
+}
 
-        int ijkl_inc;
-        if ((ng[IINC]+ng[JINC]) > (ng[KINC]+ng[LINC])) {
-                ijkl_inc = ng[IINC] + ng[JINC];
-        } else {
-                ijkl_inc = ng[KINC] + ng[LINC];
+static CINTBasisData *_basis_data_new(int *atm, int natm, int *bas, int nbas, double *env)
+{
+        CINTBasisData *bd = malloc(sizeof(CINTBasisData));
+        int i, n, iprim, ictr;
+        size_t nprims = 0;
+        size_t ncoeff = 0;
+        for (i = 0; i < nbas; i++) {
+                nprims += bas(NPRIM_OF, i);
+                ncoeff += bas(NPRIM_OF, i) * bas(NCTR_OF, i);
+        }
+        bd->ref_count = 1;
+        bd->natm = natm;
+        bd->nbas = nbas;
+        bd->geom_id = ++_basis_geom_id;
+        bd->shells = malloc(sizeof(int) * nbas * 4);
+        bd->shl_order = malloc(sizeof(int) * MAX(nbas, 1));
+        bd->exps = malloc(sizeof(double) * MAX(nprims, 1));
+        bd->coeffs = malloc(sizeof(double) * MAX(ncoeff, 1));
+        bd->coords = malloc(sizeof(double) * natm * 3);
+        bd->prim_loc = malloc(sizeof(size_t) * (nbas + 1));
+        bd->coeff_loc = malloc(sizeof(size_t) * (nbas + 1));
+        bd->pairdata = NULL;
+
+        _basis_data_sort_shells(bd->shl_order, bas, nbas, env);
+        size_t ploc = 0;
+        size_t cloc = 0;
+        for (n = 0; n < nbas; n++) {
+                i = bd->shl_order[n];
+                iprim = bas(NPRIM_OF, i);
+                ictr = bas(NCTR_OF, i);
+                bd->shells[i*4+0] = bas(ATOM_OF, i);
+                bd->shells[i*4+1] = bas(ANG_OF, i);
+                bd->shells[i*4+2] = iprim;
+                bd->shells[i*4+3] = ictr;
+                bd->prim_loc[i] = ploc;
+                bd->coeff_loc[i] = cloc;
+                memcpy(bd->exps+ploc, env+bas(PTR_EXP,i), sizeof(double)*iprim);
+                memcpy(bd->coeffs+cloc, env+bas(PTR_COEFF,i), sizeof(double)*iprim*ictr);
+                ploc += iprim;
+                cloc += iprim * ictr;
+        }
+        bd->prim_loc[nbas] = ploc;
+        bd->coeff_loc[nbas] = cloc;
+        _basis_data_set_geom(bd, atm, natm, env);
+
+        CINTOpt tmp;
+        tmp.log_max_coeff = NULL;
+        tmp.non0ctr = NULL;
+        tmp.sortedidx = NULL;
+        CINTOpt_set_log_maxc(&tmp, atm, natm, bas, nbas, env);
+        CINTOpt_set_non0coeff(&tmp, atm, natm, bas, nbas, env);
+        bd->log_max_coeff = tmp.log_max_coeff;
+        bd->non0ctr = tmp.non0ctr;
+        bd->sortedidx = tmp.sortedidx;
+
+        bd->next = _basis_registry;
+        _basis_registry = bd;
+        return bd;
+}
+
+static void _basis_registry_unlink(CINTBasisData *bd)
+{
+        CINTBasisData **pbd;
+        for (pbd = &_basis_registry; *pbd != NULL; pbd = &(*pbd)->next) {
+                if (*pbd == bd) {
+                        *pbd = bd->next;
+                        break;
+                }
         }
+}
+
+static void _basis_data_del(CINTBasisData *bd)
+{
+        _basis_registry_unlink(bd);
+        if (bd->log_max_coeff != NULL) {
+                free(bd->log_max_coeff[0]);
+                free(bd->log_max_coeff);
+        }
+        if (bd->non0ctr != NULL) {
+                free(bd->sortedidx[0]);
+                free(bd->sortedidx);
+                free(bd->non0ctr[0]);
+                free(bd->non0ctr);
+        }
+        free(bd->pairdata);
+        free(bd->prim_loc);
+        free(bd->coeff_loc);
+        free(bd->coords);
+        free(bd->exps);
+        free(bd->coeffs);
+        free(bd->shl_order);
+        free(bd->shells);
+        free(bd);
+}
+
+/*
+ * Pair data of shell pair (i,j) are stored at a fixed position of the
+ * pairdata buffer, so that they can be updated in place for a new geometry.
+ * The block of shell i starts at prim_loc[i]*tot_prim, and (i,j) is located
+ * at prim_loc[j]*iprim of the block.  pdata_base is filled for the
+ * geometry of atm and env, bd is only read.
+ */
+static void _basis_data_fill_pairdata(CINTBasisData *bd, PairData *pdata_base,
+                                      int *atm, int natm, int *bas, int nbas,
+                                      double *env)
+{
+        double **log_max_coeff = bd->log_max_coeff;
+        size_t *prim_loc = bd->prim_loc;
+        size_t tot_prim = prim_loc[nbas];
+        double *cceij_min = (double *)(pdata_base + tot_prim * tot_prim);
+        int i;
 
-        int empty;
-        double rr;
-        PairData *pdata0;
+#pragma omp parallel
+{
+        int j, n, ip, jp, iprim, jprim;
+        double *ai, *aj, *ri, *rj;
+        double *log_maxci, *log_maxcj;
+        double rr, aij, eij, wj, log_rr_ij, cmin;
+        PairData *pdata_ij, *pdata_ji;
+#pragma omp for schedule(dynamic, 4)
         for (i = 0; i < nbas; i++) {
                 ri = env + atm(PTR_COORD,bas(ATOM_OF,i));
                 ai = env + bas(PTR_EXP,i);
                 iprim = bas(NPRIM_OF,i);
-                li = bas(ANG_OF,i);
                 log_maxci = log_max_coeff[i];
 
                 for (j = 0; j <= i; j++) {
                         rj = env + atm(PTR_COORD,bas(ATOM_OF,j));
                         aj = env + bas(PTR_EXP,j);
                         jprim = bas(NPRIM_OF,j);
-                        lj = bas(ANG_OF,j);
                         log_maxcj = log_max_coeff[j];
                         rr = (ri[0]-rj[0])*(ri[0]-rj[0])
                            + (ri[1]-rj[1])*(ri[1]-rj[1])
                            + (ri[2]-rj[2])*(ri[2]-rj[2]);
+                        // see CINTset_pairdata
+                        log_rr_ij = 1.7 - 1.5 * approx_log(ai[iprim-1] + aj[jprim-1]);
+
+                        pdata_ij = pdata_base + prim_loc[i] * tot_prim + prim_loc[j] * iprim;
+                        pdata_ji = pdata_base + prim_loc[j] * tot_prim + prim_loc[i] * jprim;
+                        cmin = 1e99;
+                        for (n = 0, jp = 0; jp < jprim; jp++) {
+                        for (ip = 0; ip < iprim; ip++, n++) {
+                                aij = 1/(ai[ip] + aj[jp]);
+                                eij = rr * ai[ip] * aj[jp] * aij;
+                                wj = aj[jp] * aij;
+                                pdata_ij[n].cceij = eij - log_rr_ij - log_maxci[ip] - log_maxcj[jp];
+                                pdata_ij[n].rij[0] = ri[0] + wj * (rj[0]-ri[0]);
+                                pdata_ij[n].rij[1] = ri[1] + wj * (rj[1]-ri[1]);
+                                pdata_ij[n].rij[2] = ri[2] + wj * (rj[2]-ri[2]);
+                                pdata_ij[n].eij = exp(-eij);
+                                cmin = MIN(cmin, pdata_ij[n].cceij);
+                        } }
+                        cceij_min[i*nbas+j] = cmin;
+                        cceij_min[j*nbas+i] = cmin;
+                        if (i != j) {
+                                // transpose pairdata
+                                for (ip = 0; ip < iprim; ip++) {
+                                for (jp = 0; jp < jprim; jp++, pdata_ji++) {
+                                        memcpy(pdata_ji, pdata_ij+jp*iprim+ip,
+                                               sizeof(PairData));
+                                } }
+                        }
+                }
+        }
+}
+}
 
-                        empty = CINTset_pairdata(pdata, ai, aj, ri, rj, log_maxci, log_maxcj,
-                                                 li+ijkl_inc, lj, iprim, jprim, rr, expcutoff, env);
-                        if (i == 0 && j == 0) {
-                                opt->pairdata[0] = pdata;
-                                pdata += iprim * jprim;
-                        } else if (!empty) {
-                                opt->pairdata[i*nbas+j] = pdata;
-                                pdata += iprim * jprim;
-                                if (i != j) {
-                                        opt->pairdata[j*nbas+i] = pdata;
-                                        pdata0 = opt->pairdata[i*nbas+j];
-                                        // transpose pairdata
-                                        for (ip = 0; ip < iprim; ip++) {
-                                        for (jp = 0; jp < jprim; jp++, pdata++) {
-                                                memcpy(pdata, pdata0+jp*iprim+ip,
-                                                       sizeof(PairData));
-                                        } }
+/*
+ * Find or create the basis data for the basis and geometry.  The pair data
+ * are created if with_pairdata is set.  Returns NULL if the basis is empty.
+ */
+static CINTBasisData *_basis_data_acquire(int with_pairdata, int *atm, int natm,
+                                          int *bas, int nbas, double *env)
+{
+        size_t tot_prim = 0;
+        int i;
+        for (i = 0; i < nbas; i++) {
+                tot_prim += bas(NPRIM_OF, i);
+        }
+        if (tot_prim == 0) {
+                return NULL;
+        }
+
+        _basis_lock_acquire();
+        CINTBasisData *bd;
+        for (bd = _basis_registry; bd != NULL; bd = bd->next) {
+                if (_basis_data_same_basis(bd, bas, nbas, env) &&
+                    _basis_data_same_geom(bd, atm, natm, env)) {
+                        bd->ref_count++;
+                        break;
+                }
+        }
+        if (bd == NULL) {
+                bd = _basis_data_new(atm, natm, bas, nbas, env);
+        }
+        _basis_lock_release();
+
+        if (with_pairdata && tot_prim <= MAX_PGTO_FOR_PAIRDATA &&
+            __atomic_load_n(&bd->pairdata, __ATOMIC_ACQUIRE) == NULL) {
+                PairData *pdata = malloc(sizeof(PairData) * tot_prim * tot_prim
+                                         + sizeof(double) * nbas * nbas);
+                _basis_data_fill_pairdata(bd, pdata, atm, natm, bas, nbas, env);
+                PairData *expected = NULL;
+                // another thread may have published the same pair data
+                if (!__atomic_compare_exchange_n(&bd->pairdata, &expected, pdata, 0,
+                                                 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                        free(pdata);
+                }
+        }
+        return bd;
+}
+
+static void _basis_data_release(CINTBasisData *bd)
+{
+        _basis_lock_acquire();
+        bd->ref_count--;
+        if (bd->ref_count == 0) {
+                _basis_data_del(bd);
+        }
+        _basis_lock_release();
+}
+
+/*
+ * The pair screening of the operator: pair_shift and the NOVALUE table of
+ * pairdata, see CINTset_pairdata.
+ */
+static void _set_opt_pairdata(CINTOpt *opt, int *atm, int natm,
+                              int *bas, int nbas, double *env)
+{
+        CINTBasisData *bd = opt->basis;
+        double *cceij_min = CINTBasisData_cceij_min(bd);
+        double expcutoff;
+        if (env[PTR_EXPCUTOFF] == 0) {
+                expcutoff = EXPCUTOFF;
+        } else {
+                expcutoff = MAX(MIN_EXPCUTOFF, env[PTR_EXPCUTOFF]);
+        }
+        opt->expcutoff = expcutoff;
+        size_t *prim_loc = bd->prim_loc;
+        size_t tot_prim = prim_loc[nbas];
+        double omega = env[PTR_RANGE_OMEGA];
+        double omega2 = omega * omega;
+        double r_guess = 8.;
+        int ijkl_inc = opt->ijkl_inc;
+        int i, j, iprim, jprim, lij;
+        double *ri, *rj, dist_ij, aij, theta, shift;
+
+        for (i = 0; i < nbas; i++) {
+                ri = env + atm(PTR_COORD,bas(ATOM_OF,i));
+                iprim = bas(NPRIM_OF,i);
+                for (j = 0; j < nbas; j++) {
+                        rj = env + atm(PTR_COORD,bas(ATOM_OF,j));
+                        jprim = bas(NPRIM_OF,j);
+                        lij = bas(ANG_OF,i) + bas(ANG_OF,j) + ijkl_inc;
+                        shift = 0;
+                        if (lij > 0) {
+                                dist_ij = sqrt((ri[0]-rj[0])*(ri[0]-rj[0])
+                                             + (ri[1]-rj[1])*(ri[1]-rj[1])
+                                             + (ri[2]-rj[2])*(ri[2]-rj[2]));
+                                if (omega < 0) {
+                                        aij = env[bas(PTR_EXP,i)+iprim-1]
+                                            + env[bas(PTR_EXP,j)+jprim-1];
+                                        theta = omega2 / (omega2 + aij);
+                                        shift = lij * approx_log(dist_ij + theta*r_guess + 1.);
+                                } else {
+                                        shift = lij * approx_log(dist_ij + 1.);
                                 }
+                        }
+                        opt->pair_shift[i*nbas+j] = shift;
+                        if (cceij_min[i*nbas+j] - shift < expcutoff) {
+                                opt->pairdata[i*nbas+j] = bd->pairdata
+                                        + prim_loc[i] * tot_prim + prim_loc[j] * iprim;
                         } else {
                                 opt->pairdata[i*nbas+j] = NOVALUE;
-                                opt->pairdata[j*nbas+i] = NOVALUE;
                         }
                 }
         }
 }
 
+/*
+ * Attaches the shared basis data to opt.  The pair data are set up if ng is
+ * given.
+ */
+void CINTOpt_set_basis_data(CINTOpt *opt, int *ng,
+                            int *atm, int natm, int *bas, int nbas, double *env)
+{
+        CINTBasisData *bd = _basis_data_acquire(ng != NULL, atm, natm, bas, nbas, env);
+        if (bd == NULL) {
+                return;
+        }
+        opt->basis = bd;
+        opt->log_max_coeff = bd->log_max_coeff;
+        opt->non0ctr = bd->non0ctr;
+        opt->sortedidx = bd->sortedidx;
+
+        if (ng != NULL && bd->pairdata != NULL) {
+                if ((ng[IINC]+ng[JINC]) > (ng[KINC]+ng[LINC])) {
+                        opt->ijkl_inc = ng[IINC] + ng[JINC];
+                } else {
+                        opt->ijkl_inc = ng[KINC] + ng[LINC];
+                }
+                opt->pairdata = malloc(sizeof(PairData *) * MAX(nbas * nbas, 1));
+                opt->pair_shift = malloc(sizeof(double) * MAX(nbas * nbas, 1));
+                _set_opt_pairdata(opt, atm, natm, bas, nbas, env);
+        }
+}
+
+void CINTOpt_setij(CINTOpt *opt, int *ng,
+                   int *atm, int natm, int *bas, int nbas, double *env)
+{
+        if (opt->log_max_coeff == NULL) {
+                CINTOpt_set_log_maxc(opt, atm, natm, bas, nbas, env);
+        }
+        if (opt->basis != NULL) {
+                CINTdel_pairdata_optimizer(opt);
+                _basis_data_release(opt->basis);
+                opt->basis = NULL;
+        }
+        CINTBasisData *bd = _basis_data_acquire(1, atm, natm, bas, nbas, env);
+        if (bd == NULL) {
+                return;
+        }
+        // Only the pair data are taken from the basis data. log_max_coeff
+        // etc. are owned by opt.
+        opt->basis = bd;
+        if (bd->pairdata != NULL) {
+                if ((ng[IINC]+ng[JINC]) > (ng[KINC]+ng[LINC])) {
+                        opt->ijkl_inc = ng[IINC] + ng[JINC];
+                } else {
+                        opt->ijkl_inc = ng[KINC] + ng[LINC];
+                }
+                opt->pairdata = malloc(sizeof(PairData *) * MAX(nbas * nbas, 1));
+                opt->pair_shift = malloc(sizeof(double) * MAX(nbas * nbas, 1));
+                _set_opt_pairdata(opt, atm, natm, bas, nbas, env);
+        }
+}
+
+/*
+ * Update the optimizer for new coordinates in env.  Only the pair data
+ * depend on the geometry.  The basis dependent tables (log_max_coeff,
+ * non0ctr, sortedidx, index_xyz_array) are reused.  The shared pair data
+ * are recomputed in place if no other optimizer uses them.  The basis (bas
+ * and the exponents, coefficients in env) must be the same as the one used
+ * to create opt.
+ */
+void CINTOpt_update_geometry(CINTOpt *opt, int *atm, int natm,
+                             int *bas, int nbas, double *env)
+{
+        if (opt == NULL || opt->basis == NULL) {
+                return;
+        }
+        assert(opt->nbas == nbas);
+        CINTBasisData *bd = opt->basis;
+        int with_pairdata = opt->pairdata != NULL;
+
+        _basis_lock_acquire();
+        int same_geom = _basis_data_same_geom(bd, atm, natm, env);
+        // Taken out of the registry to be updated in place outside of the
+        // lock.  No other optimizer can find it in the meantime.
+        int in_place = !same_geom && bd->ref_count == 1 && bd->natm == natm;
+        if (in_place) {
+                _basis_registry_unlink(bd);
+        }
+        _basis_lock_release();
+
+        if (in_place) {
+                _basis_data_set_geom(bd, atm, natm, env);
+                if (bd->pairdata != NULL) {
+                        _basis_data_fill_pairdata(bd, bd->pairdata, atm, natm,
+                                                  bas, nbas, env);
+                }
+                _basis_lock_acquire();
+                bd->geom_id = ++_basis_geom_id;
+                bd->next = _basis_registry;
+                _basis_registry = bd;
+                _basis_lock_release();
+        } else if (!same_geom) {
+                CINTBasisData *bd1 = _basis_data_acquire(with_pairdata, atm, natm,
+                                                         bas, nbas, env);
+                if (opt->log_max_coeff == bd->log_max_coeff) {
+                        opt->log_max_coeff = bd1->log_max_coeff;
+                        opt->non0ctr = bd1->non0ctr;
+                        opt->sortedidx = bd1->sortedidx;
+                }
+                opt->basis = bd1;
+                _basis_data_release(bd);
+        }
+
+        if (with_pairdata) {
+                _set_opt_pairdata(opt, atm, natm, bas, nbas, env);
+        }
+}
+
 void CINTdel_pairdata_optimizer(CINTOpt *cintopt)
 {
         if (cintopt != NULL && cintopt->pairdata != NULL) {
-                free(cintopt->pairdata[0]);
+                // the pair data are owned by the basis data
                 free(cintopt->pairdata);
+                free(cintopt->pair_shift);
                 cintopt->pairdata = NULL;
+                cintopt->pair_shift = NULL;
         }
 }
 
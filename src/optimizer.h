@@ -18,11 +18,51 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stddef.h>
 #include "cint.h"
 
 #define NOVALUE                 ((void *)0xffffffffffffffffuL)
 #define MAX_PGTO_FOR_PAIRDATA   2048
 
+/*
+ * Reference counted basis dependent data.  Optimizers created for the same
+ * basis and geometry share one CINTBasisData.
+ *
+ * The exponents and coefficients are stored shell by shell in shl_order,
+ * the shells sorted by angular momentum, atom and the most diffuse
+ * exponent.  Shells which are visited one after another by the batched
+ * drivers are then adjacent in exps, coeffs and pairdata.  Everything is
+ * still indexed by the shell id of the caller.
+ */
+typedef struct CINTBasisData {
+        int ref_count;
+        int natm;
+        int nbas;
+        // changes with the geometry, unique over all basis data
+        size_t geom_id;
+        int *shells;            // ATOM_OF, ANG_OF, NPRIM_OF, NCTR_OF of each shell
+        int *shl_order;         // shell ids in the order of the storage
+        double *exps;           // exponents of shell i at exps[prim_loc[i]]
+        double *coeffs;         // coefficients of shell i at coeffs[coeff_loc[i]]
+        double *coords;
+        double **log_max_coeff;
+        int **non0ctr;
+        int **sortedidx;
+        size_t *prim_loc;       // prim_loc[nbas] is the total number of primitives
+        size_t *coeff_loc;
+        // tot_prim**2 pair data without the angular momentum term in cceij,
+        // followed by min(cceij) of the nbas**2 shell pairs, see
+        // CINTBasisData_cceij_min.  Published with a compare-and-swap
+        PairData *pairdata;
+        struct CINTBasisData *next;
+} CINTBasisData;
+
+static inline double *CINTBasisData_cceij_min(CINTBasisData *bd)
+{
+        size_t tot_prim = bd->prim_loc[bd->nbas];
+        return (double *)(bd->pairdata + tot_prim * tot_prim);
+}
+
 void CINTinit_2e_optimizer(CINTOpt **opt, int *atm, int natm,
                            int *bas, int nbas, double *env);
 void CINTinit_optimizer(CINTOpt **opt, int *atm, int natm,
@@ -33,12 +73,56 @@ void CINTdel_pairdata_optimizer(CINTOpt *cintopt);
 void CINTOpt_log_max_pgto_coeff(double *log_maxc, double *coeff, int nprim, int nctr);
 void CINTOpt_set_log_maxc(CINTOpt *opt, int *atm, int natm,
                           int *bas, int nbas, double *env);
+void CINTOpt_set_basis_data(CINTOpt *opt, int *ng,
+                            int *atm, int natm, int *bas, int nbas, double *env);
 void CINTOpt_setij(CINTOpt *opt, int *ng,
                    int *atm, int natm, int *bas, int nbas, double *env);
+void CINTOpt_update_geometry(CINTOpt *opt, int *atm, int natm,
+                             int *bas, int nbas, double *env);
 void CINTOpt_non0coeff_byshell(int *sortedidx, int *non0ctr, double *ci,
                                int iprim, int ictr);
 void CINTOpt_set_non0coeff(CINTOpt *opt, int *atm, int natm,
                            int *bas, int nbas, double *env);
+int *CINTOpt_load_index_xyz(CINTOpt *opt, int ptr, void (*findex_xyz)(),
+                            CINTEnvVars *envs);
+void CINTdel_index_xyz_cache(void);
+void CINTg2c_index_xyz(int *idx, CINTEnvVars *envs);
+
+/*
+ * Entry of the shared index_xyz cache.  key holds i_l, j_l, k_l, l_l,
+ * g_stride_i, g_stride_j, g_stride_k, g_stride_l and g_size.
+ */
+#define INDEX_XYZ_KEYLEN        9
+typedef struct _IndexXYZ {
+        struct _IndexXYZ *next;
+        void (*findex_xyz)();
+        int key[INDEX_XYZ_KEYLEN];
+        int idx[];
+} IndexXYZ;
+
+/*
+ * index_xyz table of the shell combination ptr. It is generated on the first
+ * call and shared between optimizers.  ptr only encodes the angular momenta.
+ * The g strides also depend on the number of Rys roots, which can change
+ * between calls with the same optimizer (CINTcall_with_params), so the
+ * table in opt is checked against the strides of envs.
+ */
+static inline int *CINTOpt_index_xyz(CINTOpt *opt, int ptr, void (*findex_xyz)(),
+                                     CINTEnvVars *envs)
+{
+        int *idx = __atomic_load_n(opt->index_xyz_array + ptr, __ATOMIC_ACQUIRE);
+        if (idx != NULL) {
+                int *key = ((IndexXYZ *)((char *)idx - offsetof(IndexXYZ, idx)))->key;
+                if (key[4] == envs->g_stride_i && key[5] == envs->g_stride_j &&
+                    key[8] == envs->g_size &&
+                    (findex_xyz == &CINTg2c_index_xyz ||
+                     (key[6] == envs->g_stride_k && key[7] == envs->g_stride_l))) {
+                        return idx;
+                }
+        }
+        return CINTOpt_load_index_xyz(opt, ptr, findex_xyz, envs);
+}
+
 int CINTset_pairdata(PairData *pairdata, double *ai, double *aj, double *ri, double *rj,
                      double *log_maxci, double *log_maxcj,
                      int li_ceil, int lj_ceil, int iprim, int jprim,
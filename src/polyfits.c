@@ -461,3 +461,62 @@ void _CINT_matmul_14_14(double *imc, double *im, int nroots)
 #endif
 }
 #endif
+
+/*
+ * Chebyshev coefficients of n functions tabulated on the 14 Chebyshev nodes
+ * cos(pi*(2k+1)/28).  fx[k*n+i] is the value of function i on node k.  The
+ * coefficients are saved in cs[j*n+i] so that the functions can be evaluated
+ * together with _CINT_clenshaw_roots.
+ */
+void _CINT_chebyshev_fit14(double *cs, const double *fx, int n)
+{
+        int i, j, k;
+        double c;
+        for (j = 0; j < 14; j++) {
+                for (i = 0; i < n; i++) {
+                        cs[j*n+i] = 0;
+                }
+                for (k = 0; k < 14; k++) {
+                        c = COS_14_14[k*14+j] * (2./14);
+                        for (i = 0; i < n; i++) {
+                                cs[j*n+i] += c * fx[k*n+i];
+                        }
+                }
+        }
+}
+
+/*
+ * Clenshaw recurrence for the Chebyshev series generated by
+ * _CINT_chebyshev_fit14.  The n series are evaluated in SIMD registers.
+ */
+void _CINT_clenshaw_roots(double *rr, const double *cs, double u, int n)
+{
+        int i, k;
+        __MD d, g, tmp;
+        __MD u1 = MM_SET1(u);
+        __MD u2 = MM_SET1(u * 2.);
+        __MD half = MM_SET1(0.5);
+        for (i = 0; i + SIMDD <= n; i += SIMDD) {
+                d = MM_SET1(0.);
+                g = MM_LOADU(cs+13*n+i);
+                for (k = 12; k >= 1; k--) {
+                        tmp = g;
+                        g = u2 * g - d + MM_LOADU(cs+k*n+i);
+                        d = tmp;
+                }
+                MM_STOREU(rr+i, u1 * g - d + MM_LOADU(cs+i) * half);
+        }
+
+        double d0, g0, t0;
+        double v2 = u * 2.;
+        for (; i < n; i++) {
+                d0 = 0;
+                g0 = cs[13*n+i];
+                for (k = 12; k >= 1; k--) {
+                        t0 = g0;
+                        g0 = v2 * g0 - d0 + cs[k*n+i];
+                        d0 = t0;
+                }
+                rr[i] = u * g0 - d0 + cs[i] * 0.5;
+        }
+}
@@ -56,6 +56,7 @@ typedef int QuadratureFunction(int n, double x, double lower, double *roots, dou
 
 int _CINT_polynomial_roots(double *roots, double *cs, int nroots);
 static int polyfit_roots(int nroots, double x, double* rr, double* ww);
+static int polyfit_roots_lazy(int nroots, double x, double* rr, double* ww);
 
 static int segment_solve(int n, double x, double lower, double *u, double *w,
                          double breakpoint, QuadratureFunction fn1, QuadratureFunction fn2)
@@ -93,6 +94,55 @@ void _CINTrys_roots_batch(int nroots, double *x, double *u, double *w, int count
         }
 }
 
+/*
+ * Roots in t^2 = u/(u+1) and weights for count values of x, stored as
+ * t2[i*stride+n] and w[i*stride+n].  SIMDD points are processed at once and
+ * the large-x limit is evaluated for all lanes together, x must be readable
+ * up to the SIMDD boundary.  The lanes beyond count get zero roots and
+ * weights.
+ */
+void _CINTrys_roots_grids(int nroots, double *x, double *t2, double *w,
+                          int count, int stride)
+{
+        double roots[MXRYSROOTS * 2];
+        double *weights = roots + nroots;
+        double xlarge = 35 + nroots * 5;
+        int off = nroots * (nroots - 1) / 2;
+        int n, i, k, nlane, nlarge;
+        __MD rx, rt, rs;
+        for (n = 0; n < count; n += SIMDD) {
+                nlane = MIN(count - n, SIMDD);
+                nlarge = 0;
+                for (k = 0; k < nlane; k++) {
+                        nlarge += x[n+k] >= xlarge;
+                }
+                if (nlarge == nlane) {
+                        // u = rt/(x-rt) => t^2 = rt/x
+                        rx = MM_LOAD(x+n);
+                        rs = MM_SQRT(MM_DIV(MM_SET1(PIE4), rx));
+                        for (i = 0; i < nroots; i++) {
+                                rt = MM_SET1(POLY_LARGEX_RT[off+i]);
+                                MM_STORE(t2+i*stride+n, MM_DIV(rt, rx));
+                                MM_STORE(w +i*stride+n, MM_MUL(MM_SET1(POLY_LARGEX_WW[off+i]), rs));
+                        }
+                } else {
+                        for (k = 0; k < nlane; k++) {
+                                CINTrys_roots(nroots, x[n+k], roots, weights);
+                                for (i = 0; i < nroots; i++) {
+                                        t2[i*stride+n+k] = roots[i] / (roots[i] + 1);
+                                        w [i*stride+n+k] = weights[i];
+                                }
+                        }
+                }
+                for (k = nlane; k < SIMDD; k++) {
+                        for (i = 0; i < nroots; i++) {
+                                t2[i*stride+n+k] = 0;
+                                w [i*stride+n+k] = 0;
+                        }
+                }
+        }
+}
+
 void CINTrys_roots(int nroots, double x, double *u, double *w)
 {
         if (x <= SMALLX_LIMIT) {
@@ -136,6 +186,11 @@ void CINTrys_roots(int nroots, double x, double *u, double *w)
         case 6: case 7: case 8: case 9: case 10: case 11: case 12: case 13: case 14:
                 err = polyfit_roots(nroots, x, u, w);
                 break;
+        case 15: case 16: case 17: case 18: case 19: case 20: case 21: case 22:
+        case 23: case 24: case 25: case 26: case 27: case 28: case 29: case 30:
+        case 31: case 32:
+                err = polyfit_roots_lazy(nroots, x, u, w);
+                break;
         default:
                 err = segment_solve(nroots, x, 0., u, w, 50, CINTqrys_jacobi, CINTqrys_laguerre);
         }
@@ -1824,6 +1879,260 @@ static int polyfit_roots(int nroots, double x, double* rr, double* ww)
         return 0;
 }
 
+/*
+ * Rys roots and weights from the recurrence coefficients of the orthogonal
+ * polynomials, which are generated by the discretized Stieltjes procedure.
+ * The weight function exp(-x t^2) on [lower, 1] is discretized with
+ * Gauss-Legendre quadrature.  Unlike the moment based methods, it does not
+ * lose accuracy for large nroots.  It is used to generate the polynomial fits
+ * for nroots > 14.
+ */
+#define STIELTJES_NPOINTS       256
+static double *_gauss_legendre_tw = NULL;
+
+static double *gauss_legendre_points()
+{
+        double *tw = __atomic_load_n(&_gauss_legendre_tw, __ATOMIC_ACQUIRE);
+        if (tw != NULL) {
+                return tw;
+        }
+
+        int n = STIELTJES_NPOINTS;
+        int i, j, it;
+        double z, p1, p2, p3, dp;
+        tw = malloc(sizeof(double) * n * 2);
+        for (i = 0; i < n; i++) {
+                z = cos(M_PI * (i + .75) / (n + .5));
+                dp = 1;
+                for (it = 0; it < 8; it++) {
+                        p1 = 1;
+                        p2 = 0;
+                        for (j = 0; j < n; j++) {
+                                p3 = p2;
+                                p2 = p1;
+                                p1 = ((2 * j + 1) * z * p2 - j * p3) / (j + 1);
+                        }
+                        dp = n * (z * p1 - p2) / (z * z - 1);
+                        z -= p1 / dp;
+                }
+                // nodes and weights on [0, 1]
+                tw[i] = (1 - z) * .5;
+                tw[n+i] = 1 / ((1 - z * z) * dp * dp);
+        }
+
+        double *tw0 = NULL;
+        if (!__atomic_compare_exchange_n(&_gauss_legendre_tw, &tw0, tw, 0,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                free(tw);
+                tw = tw0;
+        }
+        return tw;
+}
+
+// The number of eigenvalues of the Jacobi matrix smaller than lambda
+static int _sturm_count(int n, double *a, double *b, double lambda)
+{
+        int k;
+        int count = 0;
+        double d = a[0] - lambda;
+        if (d == 0) {
+                d = -DBL_MIN;
+        }
+        count += d < 0;
+        for (k = 1; k < n; k++) {
+                d = a[k] - lambda - b[k] / d;
+                if (d == 0) {
+                        d = -DBL_MIN;
+                }
+                count += d < 0;
+        }
+        return count;
+}
+
+int CINTrys_stieltjes(int nroots, double x, double lower, double *roots, double *weights)
+{
+        int npts = STIELTJES_NPOINTS;
+        double *tw = gauss_legendre_points();
+        double s[STIELTJES_NPOINTS];
+        double wt[STIELTJES_NPOINTS];
+        double p0[STIELTJES_NPOINTS];
+        double p1[STIELTJES_NPOINTS];
+        double a[MXRYSROOTS];
+        double b[MXRYSROOTS];
+        double h[MXRYSROOTS+1];
+        double t, p2, sa, hk;
+        int i, k, it;
+
+        h[0] = 0;
+        for (i = 0; i < npts; i++) {
+                t = lower + (1 - lower) * tw[i];
+                s[i] = t * t;
+                wt[i] = (1 - lower) * tw[npts+i] * exp(-x * s[i]);
+                p0[i] = 0;
+                p1[i] = 1;
+                h[0] += wt[i];
+        }
+        if (h[0] == 0) {
+                for (k = 0; k < nroots; k++) {
+                        roots[k] = 0;
+                        weights[k] = 0;
+                }
+                return 0;
+        }
+
+        for (k = 0; k < nroots; k++) {
+                sa = 0;
+                for (i = 0; i < npts; i++) {
+                        sa += wt[i] * s[i] * p1[i] * p1[i];
+                }
+                a[k] = sa / h[k];
+                if (k == 0) {
+                        b[k] = 0;
+                } else {
+                        b[k] = h[k] / h[k-1];
+                }
+                hk = 0;
+                for (i = 0; i < npts; i++) {
+                        p2 = (s[i] - a[k]) * p1[i] - b[k] * p0[i];
+                        p0[i] = p1[i];
+                        p1[i] = p2;
+                        hk += wt[i] * p2 * p2;
+                }
+                h[k+1] = hk;
+                if (hk == 0) {
+                        fprintf(stderr, "libcint::rys_stieltjes zero norm for roots %d (k=%d)\n",
+                                nroots, k);
+                        return k + 1;
+                }
+        }
+
+        double lo, hi, mid, r, q0, q1, q2, dq0, dq1, dq2, dum;
+        for (k = 0; k < nroots; k++) {
+                // bisection for the k-th eigenvalue of the Jacobi matrix, then
+                // Newton iterations on the three-term recurrence
+                lo = 0;
+                hi = 1;
+                for (it = 0; it < 40; it++) {
+                        mid = (lo + hi) * .5;
+                        if (_sturm_count(nroots, a, b, mid) > k) {
+                                hi = mid;
+                        } else {
+                                lo = mid;
+                        }
+                }
+                r = (lo + hi) * .5;
+                for (it = 0; it < 3; it++) {
+                        q0 = 0;
+                        q1 = 1;
+                        dq0 = 0;
+                        dq1 = 0;
+                        for (i = 0; i < nroots; i++) {
+                                q2 = (r - a[i]) * q1 - b[i] * q0;
+                                dq2 = q1 + (r - a[i]) * dq1 - b[i] * dq0;
+                                q0 = q1;
+                                q1 = q2;
+                                dq0 = dq1;
+                                dq1 = dq2;
+                        }
+                        if (dq1 == 0) {
+                                break;
+                        }
+                        r -= q1 / dq1;
+                }
+
+                // Christoffel numbers
+                q0 = 0;
+                q1 = 1;
+                dum = 1;
+                for (i = 0; i < nroots - 1; i++) {
+                        q2 = (r - a[i]) * q1 - b[i] * q0;
+                        q0 = q1;
+                        q1 = q2;
+                        dum += q1 * q1 * h[0] / h[i+1];
+                }
+                roots[k] = r / (1 - r);
+                weights[k] = h[0] / dum;
+        }
+        return 0;
+}
+
+/*
+ * Polynomial fits for 15 <= nroots <= 32.  The x-axis is divided into
+ * segments of length 2.5 for x < 40 and length 2 for x >= 40.  In each
+ * segment the roots and weights are fitted to 14 Chebyshev polynomials.  The
+ * coefficients are generated with CINTrys_stieltjes when a segment is first
+ * used, then shared by all threads.
+ */
+#define POLYFIT_LAZY_NROOTS0    15
+#define POLYFIT_LAZY_SEGMENTS   (16 + (35+5*MXRYSROOTS-40)/2 + 1)
+static double *_polyfit_lazy_data[MXRYSROOTS-POLYFIT_LAZY_NROOTS0+1][POLYFIT_LAZY_SEGMENTS];
+
+void _CINT_chebyshev_fit14(double *cs, const double *fx, int n);
+void _CINT_clenshaw_roots(double *rr, const double *cs, double u, int n);
+
+static double *polyfit_segment(int nroots, int it)
+{
+        double **pdata = &_polyfit_lazy_data[nroots-POLYFIT_LAZY_NROOTS0][it];
+        double *data = __atomic_load_n(pdata, __ATOMIC_ACQUIRE);
+        if (data != NULL) {
+                return data;
+        }
+
+        double x0, dx;
+        if (it < 16) {
+                x0 = it * 2.5;
+                dx = 2.5;
+        } else {
+                x0 = 40. + (it - 16) * 2.;
+                dx = 2.;
+        }
+        double fx[MXRYSROOTS * 14];
+        double fw[MXRYSROOTS * 14];
+        int k, err;
+        double t;
+        for (k = 0; k < 14; k++) {
+                t = cos(M_PI * (2 * k + 1) / 28);
+                err = CINTrys_stieltjes(nroots, x0 + (t + 1) * .5 * dx, 0.,
+                                        fx + k * nroots, fw + k * nroots);
+                if (err) {
+                        return NULL;
+                }
+        }
+        data = malloc(sizeof(double) * nroots * 14 * 2);
+        _CINT_chebyshev_fit14(data, fx, nroots);
+        _CINT_chebyshev_fit14(data + nroots * 14, fw, nroots);
+
+        double *data0 = NULL;
+        if (!__atomic_compare_exchange_n(pdata, &data0, data, 0,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                free(data);
+                data = data0;
+        }
+        return data;
+}
+
+static int polyfit_roots_lazy(int nroots, double x, double* rr, double* ww)
+{
+        int it;
+        double tt;
+        if (x < 40) {
+                it = (int)(x * .4);
+                tt = (x - it * 2.5) * .8 - 1.;
+        } else {
+                x -= 40.;
+                it = (int)(x * .5);
+                tt = (x - it * 2.) - 1.;
+                it += 16;
+        }
+        double *data = polyfit_segment(nroots, it);
+        if (data == NULL) {
+                return 1;
+        }
+        _CINT_clenshaw_roots(rr, data, tt, nroots);
+        _CINT_clenshaw_roots(ww, data + nroots * 14, tt, nroots);
+        return 0;
+}
+
 #define POLYNOMIAL_VALUE1(p, a, order, x) \
 p = a[order]; \
 for (i = 1; i <= order; i++) { \
@@ -1898,7 +2207,7 @@ static int _rdk_rys_roots(int nroots, double *fmt_ints,
 {
         int i, k, j, order;
         int nroots1 = nroots + 1;
-        double rt[MXRYSROOTS + MXRYSROOTS * MXRYSROOTS];
+        double rt[(MXRYSROOTS+1) + (MXRYSROOTS+1) * (MXRYSROOTS+1)];
         double *cs = rt + nroots1;
         double *a;
         double root, poly, dum;
@@ -1954,7 +2263,7 @@ static int _rdk_rys_roots(int nroots, double *fmt_ints,
 
 int CINTrys_schmidt(int nroots, double x, double lower, double *roots, double *weights)
 {
-        double fmt_ints[MXRYSROOTS*2];
+        double fmt_ints[MXRYSROOTS*2+1];
         if (lower == 0) {
                 gamma_inc_like(fmt_ints, x, nroots*2);
         } else {
@@ -2049,9 +2358,9 @@ int CINTlrys_schmidt(int nroots, double x, double lower, double *roots, double *
 {
         int i, k, j, order, error;
         int nroots1 = nroots + 1;
-        long double fmt_ints[MXRYSROOTS * 2 + MXRYSROOTS * MXRYSROOTS];
+        long double fmt_ints[(MXRYSROOTS+1) * 2 + (MXRYSROOTS+1) * (MXRYSROOTS+1)];
         long double *qcs = fmt_ints + nroots1 * 2;
-        double rt[MXRYSROOTS + MXRYSROOTS * MXRYSROOTS];
+        double rt[MXRYSROOTS + (MXRYSROOTS+1) * (MXRYSROOTS+1)];
         double *cs = rt + nroots;
         double *a;
         double root, poly, dum, dum0;
@@ -2169,9 +2478,9 @@ int CINTqrys_schmidt(int nroots, double x, double lower, double *roots, double *
 {
         int i, k, j, order, error;
         int nroots1 = nroots + 1;
-        __float128 fmt_ints[MXRYSROOTS * 2 + MXRYSROOTS * MXRYSROOTS];
+        __float128 fmt_ints[(MXRYSROOTS+1) * 2 + (MXRYSROOTS+1) * (MXRYSROOTS+1)];
         __float128 *qcs = fmt_ints + nroots1 * 2;
-        double rt[MXRYSROOTS + MXRYSROOTS * MXRYSROOTS];
+        double rt[MXRYSROOTS + (MXRYSROOTS+1) * (MXRYSROOTS+1)];
         double *cs = rt + nroots;
         double *a;
         double root, poly, dum, dum0;
@@ -23,6 +23,8 @@
 
 void CINTrys_roots(int nroots, double x, double *u, double *w);
 void _CINTrys_roots_batch(int nroots, double *x, double *u, double *w, int count);
+void _CINTrys_roots_grids(int nroots, double *x, double *t2, double *w,
+                          int count, int stride);
 void CINTsr_rys_roots(int nroots, double x, double lower, double *u, double *w);
 int _CINTsr_rys_roots_batch(CINTEnvVars *envs, double *x, double *theta,
                             double *u, double *w, double *cutoff, int count);
@@ -32,6 +34,7 @@ void _CINTstg_roots_batch(int nroots, double *ta, double *ua, double* rr, double
 int CINTsr_rys_polyfits(int nroots, double x, double lower, double *u, double *w);
 
 int CINTrys_schmidt(int nroots, double x, double lower, double *roots, double *weights);
+int CINTrys_stieltjes(int nroots, double x, double lower, double *roots, double *weights);
 int CINTlrys_schmidt(int nroots, double x, double lower, double *roots, double *weights);
 int CINTrys_laguerre(int n, double x, double lower, double *roots, double *weights);
 int CINTlrys_laguerre(int n, double x, double lower, double *roots, double *weights);
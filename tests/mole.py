@@ -0,0 +1,122 @@
+'''
+Minimal molecule setup (atm, bas, env) for the ctypes tests, without pyscf
+'''
+
+import ctypes
+import numpy
+
+cint = ctypes.CDLL('../build/libcint.so')
+cint.CINTgto_norm.restype = ctypes.c_double
+cint.CINTcgto_spheric.restype = ctypes.c_int
+cint.CINTcgto_cart.restype = ctypes.c_int
+
+PTR_EXPCUTOFF   = 0
+PTR_COMMON_ORIG = 1
+PTR_RANGE_OMEGA = 8
+PTR_ENV_START   = 20
+
+CHARGE_OF  = 0
+PTR_COORD  = 1
+NUC_MOD_OF = 2
+ATM_SLOTS  = 6
+
+ATOM_OF   = 0
+ANG_OF    = 1
+NPRIM_OF  = 2
+NCTR_OF   = 3
+PTR_EXP   = 5
+PTR_COEFF = 6
+BAS_SLOTS = 8
+
+POINT_NUC = 1
+
+def ptr(a):
+    return a.ctypes.data_as(ctypes.c_void_p)
+
+# (l, exponents, contraction coefficients[nctr][nprim])
+WATER_BASIS = {
+    8: [(0, [5484.67, 825.235, 188.047, 52.9645, 16.8976, 5.79964],
+            [[.00183107, .0139501, .0684451, .232714, .470193, .358521]]),
+        (0, [15.5396, 3.59993, 1.01376], [[-.110778, -.148026, 1.13077],
+                                          [.0708743, .339753, .727159]]),
+        (0, [.270006], [[1.]]),
+        (1, [15.5396, 3.59993, 1.01376], [[.0708743, .339753, .727159]]),
+        (1, [.270006], [[1.]]),
+        (2, [.8], [[1.]]),
+        (3, [1.1, .45], [[.6, .5]])],
+    1: [(0, [18.7311, 2.82539, .640122], [[.0334946, .234727, .813757]]),
+        (0, [.161278], [[1.]]),
+        (1, [1.1, .3], [[.7, .4]]),
+        (2, [.75], [[1.]])],
+}
+
+WATER = [(8, (0., 0., 0.)),
+         (1, (0., 1.4, 1.1)),
+         (1, (0., -1.4, 1.1))]
+
+class Mole:
+    def __init__(self, atoms=WATER, basis=WATER_BASIS, maxl=None):
+        atm = []
+        bas = []
+        env = [0.] * PTR_ENV_START
+        for ia, (charge, coord) in enumerate(atoms):
+            atm.append([charge, len(env), POINT_NUC, 0, 0, 0])
+            env.extend(coord)
+        for ia, (charge, coord) in enumerate(atoms):
+            for l, es, cs in basis[charge]:
+                if maxl is not None and l > maxl:
+                    continue
+                cs = numpy.asarray(cs)
+                ptr_exp = len(env)
+                env.extend(es)
+                ptr_coeff = len(env)
+                norm = [cint.CINTgto_norm(ctypes.c_int(l), ctypes.c_double(e))
+                        for e in es]
+                env.extend((cs * norm).ravel())
+                bas.append([ia, l, len(es), cs.shape[0], 0, ptr_exp, ptr_coeff, 0])
+        self.atm = numpy.asarray(atm, dtype=numpy.int32)
+        self.bas = numpy.asarray(bas, dtype=numpy.int32)
+        self.env = numpy.asarray(env, dtype=numpy.double)
+        self.natm = len(atm)
+        self.nbas = len(bas)
+        self.ao_loc = numpy.zeros(self.nbas+1, dtype=numpy.int32)
+        for i in range(self.nbas):
+            self.ao_loc[i+1] = self.ao_loc[i] + cint.CINTcgto_spheric(
+                ctypes.c_int(i), ptr(self.bas))
+        self.nao = int(self.ao_loc[-1])
+
+    def args(self):
+        return (ptr(self.atm), ctypes.c_int(self.natm),
+                ptr(self.bas), ctypes.c_int(self.nbas), ptr(self.env))
+
+    def optimizer(self, fname):
+        opt = ctypes.c_void_p()
+        getattr(cint, fname)(ctypes.byref(opt), *self.args())
+        return opt
+
+    def del_optimizer(self, opt):
+        cint.CINTdel_optimizer(ctypes.byref(opt))
+
+    def shell_block(self, fname, shls, ncomp=1, opt=None):
+        '''Spherical integrals of one shell tuple, in the Fortran order of
+        the library, i.e. shape (di, dj, ..., ncomp)'''
+        dims = [int(self.ao_loc[i+1] - self.ao_loc[i]) for i in shls]
+        out = numpy.zeros(dims + [ncomp], order='F')
+        shls = numpy.asarray(shls, dtype=numpy.int32)
+        getattr(cint, fname)(ptr(out), None, ptr(shls), *self.args(),
+                             opt, None)
+        return out
+
+    def int2e(self, fname='int2e_sph', ncomp=1, opt=None):
+        '''The full (nao,nao,nao,nao,ncomp) tensor'''
+        nao = self.nao
+        ao_loc = self.ao_loc
+        eri = numpy.zeros((nao, nao, nao, nao, ncomp))
+        for i in range(self.nbas):
+            for j in range(self.nbas):
+                for k in range(self.nbas):
+                    for l in range(self.nbas):
+                        eri[ao_loc[i]:ao_loc[i+1], ao_loc[j]:ao_loc[j+1],
+                            ao_loc[k]:ao_loc[k+1], ao_loc[l]:ao_loc[l+1]] = \
+                                self.shell_block(fname, (i, j, k, l), ncomp, opt)
+        return eri
@@ -0,0 +1,106 @@
+import ctypes
+import numpy
+from mole import cint, Mole, ptr
+
+def pack_tril(a):
+    '''a[i,j,...] -> a[ij,...] for i >= j, ij = i*(i+1)/2+j'''
+    idx = numpy.tril_indices(a.shape[0])
+    return a[idx]
+
+def slice_eri(mol, eri, sh0, sh1, ksh0=None, ksh1=None):
+    if ksh0 is None:
+        ksh0, ksh1 = sh0, sh1
+    i0, i1 = mol.ao_loc[sh0], mol.ao_loc[sh1]
+    k0, k1 = mol.ao_loc[ksh0], mol.ao_loc[ksh1]
+    return eri[i0:i1,i0:i1,k0:k1,k0:k1]
+
+def test_fill_s8_s4():
+    print('test CINTeri_fill_s8 and CINTeri_fill_s4 against int2e_sph')
+    mol = Mole(maxl=2)
+    eri = mol.int2e()[...,0]
+    opt = mol.optimizer('int2e_optimizer')
+    for sh0, sh1 in [(0, mol.nbas), (2, 9)]:
+        ref = slice_eri(mol, eri, sh0, sh1)
+        ref = pack_tril(pack_tril(ref).transpose(1,2,0)).T
+        ref = pack_tril(ref)
+        for o in (None, opt):
+            out = numpy.zeros(ref.size)
+            shls_slice = numpy.asarray([sh0, sh1], dtype=numpy.int32)
+            cint.CINTeri_fill_s8(ptr(out), cint.int2e_sph, ptr(mol.ao_loc),
+                                 ptr(shls_slice), o, *mol.args())
+            assert abs(out - ref).max() < 1e-12
+
+    for ish0, ish1, ksh0, ksh1 in [(0, mol.nbas, 0, mol.nbas), (1, 8, 5, 12)]:
+        ref = slice_eri(mol, eri, ish0, ish1, ksh0, ksh1)
+        ref = pack_tril(pack_tril(ref).transpose(1,2,0)).T
+        for o in (None, opt):
+            out = numpy.zeros(ref.shape)
+            shls_slice = numpy.asarray([ish0, ish1, ksh0, ksh1], dtype=numpy.int32)
+            cint.CINTeri_fill_s4(ptr(out), cint.int2e_sph, ptr(mol.ao_loc),
+                                 ptr(shls_slice), o, *mol.args())
+            assert abs(out - ref).max() < 1e-12
+    mol.del_optimizer(opt)
+    print('test_fill_s8_s4 .. pass')
+
+def test_ket_ao2mo():
+    print('test CINTeri_ket_ao2mo against int2e_sph')
+    mol = Mole(maxl=2)
+    eri = mol.int2e()[...,0]
+    ao_loc = mol.ao_loc
+    numpy.random.seed(2)
+    opt = mol.optimizer('int2e_optimizer')
+    for ish0, ish1, jsh0, jsh1, ksh0, ksh1 in [(0, mol.nbas, 0, mol.nbas, 0, mol.nbas),
+                                               (2, 7, 0, 4, 3, 11)]:
+        i0, i1 = ao_loc[ish0], ao_loc[ish1]
+        j0, j1 = ao_loc[jsh0], ao_loc[jsh1]
+        k0, k1 = ao_loc[ksh0], ao_loc[ksh1]
+        ref = eri[i0:i1,j0:j1,k0:k1,k0:k1]
+        nao_k = k1 - k0
+        nmo_k, nmo_l = 5, 3
+        mo_k = numpy.random.rand(nmo_k, nao_k)
+        mo_l = numpy.random.rand(nmo_l, nao_k)
+        shls_slice = numpy.asarray([ish0, ish1, jsh0, jsh1, ksh0, ksh1], dtype=numpy.int32)
+        for o in (None, opt):
+            out = numpy.zeros((nmo_l, nmo_k, j1-j0, i1-i0))
+            cint.CINTeri_ket_ao2mo(ptr(out), cint.int2e_sph, ptr(ao_loc), ptr(shls_slice),
+                                   ptr(mo_k), ctypes.c_int(nmo_k),
+                                   ptr(mo_l), ctypes.c_int(nmo_l), o, *mol.args())
+            assert abs(out - numpy.einsum('ijkl,pk,ql->qpji', ref, mo_k, mo_l)).max() < 1e-11
+
+            # only the first index transformed
+            out = numpy.zeros((nao_k, nmo_k, j1-j0, i1-i0))
+            cint.CINTeri_ket_ao2mo(ptr(out), cint.int2e_sph, ptr(ao_loc), ptr(shls_slice),
+                                   ptr(mo_k), ctypes.c_int(nmo_k),
+                                   None, ctypes.c_int(0), o, *mol.args())
+            assert abs(out - numpy.einsum('ijkl,pk->lpji', ref, mo_k)).max() < 1e-11
+    mol.del_optimizer(opt)
+    print('test_ket_ao2mo .. pass')
+
+def test_cholesky():
+    print('test the reconstruction of CINTcholesky_eri')
+    mol = Mole(maxl=2)
+    eri = mol.int2e()[...,0]
+    opt = mol.optimizer('int2e_optimizer')
+    for sh0, sh1 in [(0, mol.nbas), (3, 10)]:
+        ref = slice_eri(mol, eri, sh0, sh1)
+        ref = pack_tril(pack_tril(ref).transpose(1,2,0)).T
+        npair = ref.shape[0]
+        shls_slice = numpy.asarray([sh0, sh1], dtype=numpy.int32)
+        for threshold in (1e-6, 1e-10):
+            out = numpy.zeros((npair, npair))
+            nvec = cint.CINTcholesky_eri(ptr(out), ctypes.c_int(npair),
+                                         ctypes.c_double(threshold), cint.int2e_sph,
+                                         ptr(mol.ao_loc), ptr(shls_slice), opt, *mol.args())
+            assert 0 < nvec < npair
+            lvec = out[:nvec]
+            err = abs(lvec.T.dot(lvec) - ref).max()
+            print(npair, threshold, nvec, err)
+            # the residual matrix is bounded by its largest diagonal
+            assert err < threshold
+    mol.del_optimizer(opt)
+    print('test_cholesky .. pass')
+
+if __name__ == '__main__':
+    test_fill_s8_s4()
+    test_ket_ao2mo()
+    test_cholesky()
@@ -0,0 +1,172 @@
+import os
+import ctypes
+import tempfile
+import threading
+import numpy
+from mole import cint, Mole, ptr, WATER, PTR_EXPCUTOFF, ANG_OF, NPRIM_OF
+
+cint.CINTquartet_cost.restype = ctypes.c_double
+cint.CINTeri_cache_create.restype = ctypes.c_void_p
+cint.CINTeri_file_open.restype = ctypes.c_void_p
+cint.CINTeri_file_ntask.restype = ctypes.c_size_t
+cint.CINTeri_file_shls.restype = ctypes.POINTER(ctypes.c_int)
+cint.CINTeri_file_block.restype = ctypes.POINTER(ctypes.c_double)
+cint.CINTeri_file_read.restype = ctypes.c_size_t
+
+DIGEST = ctypes.CFUNCTYPE(None, ctypes.POINTER(ctypes.c_double),
+                          ctypes.POINTER(ctypes.c_int), ctypes.c_int, ctypes.c_void_p)
+
+def quartets(mol):
+    return numpy.asarray([(i, j, k, l) for i in range(mol.nbas) for j in range(0, mol.nbas, 2)
+                          for k in range(0, mol.nbas, 3) for l in range(1, mol.nbas, 2)],
+                         dtype=numpy.int32)
+
+def test_pipeline():
+    print('test CINTpipeline_eri')
+    mol = Mole(maxl=2)
+    shls = quartets(mol)
+    ao_loc = mol.ao_loc
+    blocks = {}
+    consumers = set()
+    # exceptions raised in the callbacks are not propagated
+    duplicates = []
+    lock = threading.Lock()
+    def digest(eri, task_shls, consumer_id, data):
+        key = tuple(task_shls[n] for n in range(4))
+        dims = [int(ao_loc[i+1] - ao_loc[i]) for i in key]
+        blk = numpy.ctypeslib.as_array(eri, shape=(numpy.prod(dims),)).copy()
+        with lock:
+            if key in blocks:
+                duplicates.append(key)
+            blocks[key] = blk.reshape(dims, order='F')
+            consumers.add(consumer_id)
+    f_digest = DIGEST(digest)
+
+    opt = mol.optimizer('int2e_optimizer')
+    nproducer, nconsumer = 2, 2
+    err = cint.CINTpipeline_eri(cint.int2e_sph, ctypes.c_int(1), ctypes.c_int(4),
+                                ptr(shls), ctypes.c_size_t(len(shls)), ptr(ao_loc), opt,
+                                f_digest, None, ctypes.c_int(nproducer),
+                                ctypes.c_int(nconsumer), *mol.args())
+    assert err == 0
+    assert not duplicates
+    assert len(blocks) == len(shls)
+    assert consumers.issubset(range(nconsumer))
+    max_error = max(abs(blocks[tuple(s)] - mol.shell_block('int2e_sph', s, opt=opt)[...,0]).max()
+                    for s in shls)
+    mol.del_optimizer(opt)
+    assert max_error < 1e-14
+    print('test_pipeline .. pass')
+
+def test_quartet_cost():
+    print('test CINTquartet_cost')
+    shift = numpy.array([0., 0., 25.])
+    atoms = WATER + [(z, tuple(numpy.add(c, shift))) for z, c in WATER]
+    mol = Mole(atoms=atoms, maxl=2)
+    def costs(opt):
+        return numpy.array([cint.CINTquartet_cost(opt, ptr(s)) for s in quartets(mol)])
+
+    assert cint.CINTquartet_cost(None, ptr(quartets(mol)[0])) == -1
+    opt = mol.optimizer('int2e_optimizer')
+    c = costs(opt)
+    mol.del_optimizer(opt)
+    # pairs of the two distant molecules are screened
+    assert (c >= 0).all()
+    assert (c == 0).any() and (c > 0).any()
+
+    # (dd|dd) of the same primitives costs more than (ss|ss)
+    s_sh = [i for i in range(mol.nbas) if mol.bas[i,ANG_OF] == 0 and mol.bas[i,NPRIM_OF] == 1][0]
+    d_sh = [i for i in range(mol.nbas) if mol.bas[i,ANG_OF] == 2 and mol.bas[i,NPRIM_OF] == 1][0]
+    opt = mol.optimizer('int2e_optimizer')
+    cost_s = cint.CINTquartet_cost(opt, ptr(numpy.asarray([s_sh]*4, dtype=numpy.int32)))
+    cost_d = cint.CINTquartet_cost(opt, ptr(numpy.asarray([d_sh]*4, dtype=numpy.int32)))
+    mol.del_optimizer(opt)
+    assert cost_d > cost_s > 0
+
+    # a tighter env[PTR_EXPCUTOFF] drops primitive pairs
+    mol.env[PTR_EXPCUTOFF] = 10
+    opt = mol.optimizer('int2e_optimizer')
+    c1 = costs(opt)
+    mol.del_optimizer(opt)
+    mol.env[PTR_EXPCUTOFF] = 0
+    assert (c1 <= c).all() and (c1 < c).any()
+    print('test_quartet_cost .. pass')
+
+def test_eri_cache():
+    print('test CINTeri_cache')
+    mol = Mole(maxl=2)
+    moved = [(z, tuple(numpy.add(c, (.1, 0, -.2*ia)))) for ia, (z, c) in enumerate(WATER)]
+    mol1 = Mole(atoms=moved, maxl=2)
+    shls_list = quartets(mol)
+    opt = mol.optimizer('int2e_optimizer')
+    for max_memory in (0, 200000, 1 << 30):
+        ec = ctypes.c_void_p(cint.CINTeri_cache_create(cint.int2e_sph, ptr(mol.ao_loc),
+                                                      ctypes.c_size_t(max_memory), opt))
+        # evaluated twice to read the stored quartets back
+        for m in (mol, mol, mol1, mol1):
+            if m is mol1:
+                cint.CINTOpt_update_geometry(opt, *mol1.args())
+            max_error = 0
+            for shls in shls_list:
+                dims = [int(m.ao_loc[i+1] - m.ao_loc[i]) for i in shls]
+                out = numpy.zeros(dims, order='F')
+                cint.CINTeri_cache_eval(ec, ptr(out), None, ptr(shls), *m.args(), None)
+                ref = m.shell_block('int2e_sph', shls)[...,0]
+                max_error = max(max_error, abs(out - ref).max())
+            assert max_error < 1e-12
+        cint.CINTeri_cache_del(ec)
+        cint.CINTOpt_update_geometry(opt, *mol.args())
+    # intors without the 8-fold symmetry of the canonical quartets
+    for intor in (cint.int2e_ip1_sph, cint.int2e_rsh_sph):
+        assert cint.CINTeri_cache_create(intor, ptr(mol.ao_loc),
+                                         ctypes.c_size_t(1 << 20), opt) is None
+    mol.del_optimizer(opt)
+    print('test_eri_cache .. pass')
+
+def test_eri_file():
+    print('test CINTeri_file')
+    mol = Mole(maxl=2)
+    shls = quartets(mol)
+    ntask = len(shls)
+    tmpdir = tempfile.mkdtemp()
+    path = os.path.join(tmpdir, 'eri').encode()
+    for fname, ncomp in (('int2e', 1), ('int2e_ip1', 3)):
+        opt = mol.optimizer(fname + '_optimizer')
+        refs = [mol.shell_block(fname + '_sph', s, ncomp, opt=opt) for s in shls]
+        for cutoff in (0, 1e-8):
+            err = cint.CINTeri_file_write(path, getattr(cint, fname + '_sph'),
+                                          ctypes.c_int(ncomp), ctypes.c_int(4),
+                                          ptr(shls), ctypes.c_size_t(ntask),
+                                          ptr(mol.ao_loc), ctypes.c_double(cutoff), opt,
+                                          *mol.args())
+            assert err == 0
+            f = ctypes.c_void_p(cint.CINTeri_file_open(path))
+            assert f.value is not None
+            assert cint.CINTeri_file_ntask(f) == ntask
+            max_error = 0
+            for task, ref in enumerate(refs):
+                task = ctypes.c_size_t(task)
+                task_shls = cint.CINTeri_file_shls(f, task)
+                assert [task_shls[n] for n in range(4)] == list(shls[task.value])
+                out = numpy.zeros(ref.shape, order='F')
+                cint.CINTeri_file_read(ptr(out), f, task)
+                max_error = max(max_error, abs(out - ref).max())
+                block = cint.CINTeri_file_block(f, task)
+                if block:
+                    block = numpy.ctypeslib.as_array(block, shape=(ref.size,))
+                    assert (block == out.ravel(order='F')).all()
+            cint.CINTeri_file_close(f)
+            if cutoff == 0:
+                assert max_error == 0
+            else:
+                assert max_error < cutoff
+        mol.del_optimizer(opt)
+    os.remove(path)
+    os.rmdir(tmpdir)
+    print('test_eri_file .. pass')
+
+if __name__ == '__main__':
+    test_pipeline()
+    test_quartet_cost()
+    test_eri_cache()
+    test_eri_file()
@@ -0,0 +1,103 @@
+import ctypes
+import numpy
+from mole import cint, Mole, ptr, PTR_RANGE_OMEGA
+
+PTR_RINV_ORIG = 4
+PTR_RINV_ZETA = 7
+NGRIDS        = 11
+PTR_GRIDS     = 12
+
+def rinv_matrix(mol, r):
+    '''<i|1/|r-R||j> of all shells'''
+    mol.env[PTR_RINV_ORIG:PTR_RINV_ORIG+3] = r
+    nao = mol.nao
+    ao_loc = mol.ao_loc
+    v = numpy.zeros((nao, nao))
+    for i in range(mol.nbas):
+        for j in range(mol.nbas):
+            v[ao_loc[i]:ao_loc[i+1],ao_loc[j]:ao_loc[j+1]] = \
+                    mol.shell_block('int1e_rinv_sph', (i, j))[...,0]
+    mol.env[PTR_RINV_ORIG:PTR_RINV_ORIG+3] = 0
+    return v
+
+def test_esp_grids():
+    print('test CINTesp_grids against int1e_rinv')
+    mol = Mole(maxl=2)
+    numpy.random.seed(3)
+    dm = numpy.random.rand(mol.nao, mol.nao) - .5
+    dm = dm + dm.T
+    # grids inside and around the molecule
+    grids = numpy.random.rand(57, 3) * 8 - 4
+    ref = numpy.array([numpy.einsum('ij,ij->', dm, rinv_matrix(mol, r)) for r in grids])
+    out = numpy.zeros(len(grids))
+    cint.CINTesp_grids_sph(ptr(out), ptr(dm), ptr(grids), ctypes.c_int(len(grids)),
+                           *mol.args())
+    print(abs(out - ref).max())
+    assert abs(out - ref).max() < 1e-10
+    print('test_esp_grids .. pass')
+
+def test_point_charges_fock():
+    print('test CINTpoint_charges_fock against int1e_rinv')
+    mol = Mole(maxl=2)
+    numpy.random.seed(5)
+    # charges next to the molecule and far away for the multipole expansion
+    coords = numpy.vstack([numpy.random.rand(20, 3) * 8 - 4,
+                           numpy.random.rand(300, 3) * 60 - 30])
+    charges = numpy.random.rand(len(coords)) - .5
+    for zeta in (0, 2.5):
+        mol.env[PTR_RINV_ZETA] = zeta
+        ref = sum(q * rinv_matrix(mol, r) for q, r in zip(charges, coords))
+        out = numpy.zeros((mol.nao, mol.nao))
+        cint.CINTpoint_charges_fock_sph(ptr(out), ptr(coords), ptr(charges),
+                                        ctypes.c_int(len(coords)), *mol.args())
+        print(zeta, abs(out - ref).max())
+        assert abs(out - ref).max() < 1e-10
+    mol.env[PTR_RINV_ZETA] = 0
+    print('test_point_charges_fock .. pass')
+
+def test_int1e_grids_far():
+    '''int1e_grids for blocks of grid points of large x only, which take the
+    vectorized large-x roots, and mixed blocks'''
+    print('test int1e_grids against int1e_rinv far from the molecule')
+    mol = Mole(maxl=2)
+    numpy.random.seed(7)
+    direction = numpy.random.rand(40, 3) - .5
+    direction /= numpy.linalg.norm(direction, axis=1)[:,None]
+    grids = numpy.vstack([direction * (numpy.random.rand(40, 1) * 30 + 15),
+                          numpy.random.rand(13, 3) * 6 - 3])
+    env0 = mol.env
+    mol.env = numpy.hstack([env0, grids.ravel()])
+    mol.env[NGRIDS] = len(grids)
+    mol.env[PTR_GRIDS] = len(env0)
+    ao_loc = mol.ao_loc
+    # erf(omega r)/r is the potential of a Gaussian charge of zeta = omega^2
+    for omega, zeta in ((0, 0), (0, 2.5), (.4, 0)):
+        mol.env[PTR_RANGE_OMEGA] = omega
+        mol.env[PTR_RINV_ZETA] = zeta
+        max_error = 0
+        for i in range(mol.nbas):
+            for j in range(mol.nbas):
+                shls = numpy.asarray([i, j, 0, len(grids)], dtype=numpy.int32)
+                di = ao_loc[i+1] - ao_loc[i]
+                dj = ao_loc[j+1] - ao_loc[j]
+                out = numpy.zeros((len(grids), di, dj), order='F')
+                cint.int1e_grids_sph(ptr(out), None, ptr(shls), *mol.args(),
+                                     None, None)
+                mol.env[PTR_RANGE_OMEGA] = 0
+                mol.env[PTR_RINV_ZETA] = zeta + omega**2
+                for ig, r in enumerate(grids):
+                    mol.env[PTR_RINV_ORIG:PTR_RINV_ORIG+3] = r
+                    ref = mol.shell_block('int1e_rinv_sph', (i, j))[...,0]
+                    max_error = max(max_error, abs(out[ig] - ref).max())
+                mol.env[PTR_RANGE_OMEGA] = omega
+                mol.env[PTR_RINV_ZETA] = zeta
+        mol.env[PTR_RINV_ORIG:PTR_RINV_ORIG+3] = 0
+        print(omega, zeta, max_error)
+        assert max_error < 1e-10
+    mol.env = env0
+    print('test_int1e_grids_far .. pass')
+
+if __name__ == '__main__':
+    test_esp_grids()
+    test_point_charges_fock()
+    test_int1e_grids_far()
@@ -0,0 +1,69 @@
+import ctypes
+import numpy
+from mole import cint, Mole, ptr, PTR_COMMON_ORIG
+
+INT1E_MULTI_OVLP = 0
+INT1E_MULTI_KIN  = 1
+INT1E_MULTI_NUC  = 2
+INT1E_MULTI_R    = 3
+INT1E_MULTI_RR   = 4
+
+# operator, ncomp, the single-operator integral
+OPS = [(INT1E_MULTI_OVLP, 1, 'int1e_ovlp_sph'),
+       (INT1E_MULTI_KIN , 1, 'int1e_kin_sph'),
+       (INT1E_MULTI_NUC , 1, 'int1e_nuc_sph'),
+       (INT1E_MULTI_R   , 3, 'int1e_r_sph'),
+       (INT1E_MULTI_RR  , 9, 'int1e_rr_sph')]
+
+def int1e(mol, fname, ncomp):
+    '''out[comp,j,i] of all shells'''
+    nao = mol.nao
+    ao_loc = mol.ao_loc
+    out = numpy.zeros((ncomp, nao, nao))
+    for i in range(mol.nbas):
+        for j in range(mol.nbas):
+            blk = mol.shell_block(fname, (i, j), ncomp)
+            out[:,ao_loc[j]:ao_loc[j+1],ao_loc[i]:ao_loc[i+1]] = blk.transpose(2,1,0)
+    return out
+
+def test_int1e_multi():
+    print('test int1e_multi against the single-operator integrals')
+    mol = Mole()
+    mol.env[PTR_COMMON_ORIG:PTR_COMMON_ORIG+3] = (.1, -.2, .3)
+    ref = numpy.vstack([int1e(mol, fname, ncomp) for op, ncomp, fname in OPS])
+
+    # all operators, and a subset in a different order
+    for sel in [[0, 1, 2, 3, 4], [4, 2, 0]]:
+        ops = numpy.asarray([OPS[i][0] for i in sel], dtype=numpy.int32)
+        ncomp = cint.int1e_multi_ncomp(ptr(ops), ctypes.c_int(len(ops)))
+        assert ncomp == sum(OPS[i][1] for i in sel)
+        offsets = numpy.cumsum([0] + [OPS[i][1] for i in range(len(OPS))])
+        ref_sel = numpy.vstack([ref[offsets[i]:offsets[i+1]] for i in sel])
+
+        opt = ctypes.c_void_p()
+        cint.int1e_multi_optimizer(ctypes.byref(opt), ptr(ops), ctypes.c_int(len(ops)),
+                                   *mol.args())
+        nao = mol.nao
+        ao_loc = mol.ao_loc
+        out = numpy.zeros((ncomp, nao, nao))
+        for i in range(mol.nbas):
+            for j in range(mol.nbas):
+                di = ao_loc[i+1] - ao_loc[i]
+                dj = ao_loc[j+1] - ao_loc[j]
+                blk = numpy.zeros((di, dj, ncomp), order='F')
+                shls = numpy.asarray([i, j], dtype=numpy.int32)
+                cint.int1e_multi_sph(ptr(blk), None, ptr(ops), ctypes.c_int(len(ops)),
+                                     ptr(shls), *mol.args(), opt, None)
+                out[:,ao_loc[j]:ao_loc[j+1],ao_loc[i]:ao_loc[i+1]] = blk.transpose(2,1,0)
+        mol.del_optimizer(opt)
+        assert abs(out - ref_sel).max() < 1e-12
+
+        fill = numpy.zeros((ncomp, nao, nao))
+        shls_slice = numpy.asarray([0, mol.nbas, 0, mol.nbas], dtype=numpy.int32)
+        cint.int1e_multi_fill_sph(ptr(fill), ptr(ops), ctypes.c_int(len(ops)),
+                                  ptr(shls_slice), *mol.args())
+        assert abs(fill - ref_sel).max() < 1e-12
+    print('test_int1e_multi .. pass')
+
+if __name__ == '__main__':
+    test_int1e_multi()
@@ -0,0 +1,68 @@
+import ctypes
+import numpy
+from mole import cint, Mole, ptr
+
+# generally contracted g and h shells of many primitives, for which the
+# cost model of CINTinit_int2e_EnvVars transforms the primitive integrals
+# to spherical before the contraction (c2s_prim)
+GEN_CTR_BASIS = {
+    8: [(4, [9.1, 4.3, 2.2, 1.1, .55, .27],
+            [[.2, .3, .4, .3, .2, .1], [.1, -.2, .3, -.4, .5, .6],
+             [.5, .4, -.3, .2, .1, .3], [-.1, .2, .6, .3, -.2, .4],
+             [.3, -.3, .2, .5, .4, -.1]]),
+        (1, [3.1, .8], [[.5, .6]])],
+    1: [(5, [6.5, 3.1, 1.6, .8, .4],
+            [[.3, .4, .3, .2, .1], [-.2, .3, .5, -.4, .6],
+             [.4, -.1, .2, .6, .3], [.1, .5, -.3, .2, .4]]),
+        (2, [1.2, .5, .2], [[.3, .4, .5], [.6, -.2, .3]])],
+}
+
+def c2s_matrix(l):
+    '''The (2l+1, nf) transformation of CINTc2s_ket_sph'''
+    nf = (l + 1) * (l + 2) // 2
+    if l < 2:
+        # s and p functions are returned in place
+        return numpy.eye(nf)
+    c = numpy.zeros((l*2+1, nf))
+    cart = numpy.zeros(nf)
+    sph = numpy.zeros(l*2+1)
+    for n in range(nf):
+        cart[:] = 0
+        cart[n] = 1
+        cint.CINTc2s_ket_sph(ptr(sph), ctypes.c_int(1), ptr(cart), ctypes.c_int(l))
+        c[:,n] = sph
+    return c
+
+def test_c2s_prim():
+    '''int2e_sph of the primitive-spherical path (c2s_prim = 1) against the
+    contracted Cartesian integrals of int2e_cart transformed to spherical,
+    i.e. the c2s_prim = 0 order of the transformations'''
+    print('test int2e_sph with c2s_prim for high-l general contractions')
+    mol = Mole(basis=GEN_CTR_BASIS)
+    opt = mol.optimizer('int2e_optimizer')
+    bas = mol.bas
+    max_error = 0
+    for shls in [(0, 1, 3, 3), (2, 3, 1, 1), (0, 0, 1, 1), (2, 1, 0, 1),
+                 (0, 3, 4, 1), (4, 5, 1, 3)]:
+        shls = numpy.asarray(shls, dtype=numpy.int32)
+        ls = [int(bas[i,1]) for i in shls]
+        nctrs = [int(bas[i,3]) for i in shls]
+        nfs = [(l + 1) * (l + 2) // 2 for l in ls]
+        cart = numpy.zeros([nf*nc for nf, nc in zip(nfs, nctrs)], order='F')
+        cint.int2e_cart(ptr(cart), None, ptr(shls), *mol.args(), opt, None)
+        cart = cart.reshape(nfs[0], nctrs[0], nfs[1], nctrs[1],
+                            nfs[2], nctrs[2], nfs[3], nctrs[3], order='F')
+        ref = numpy.einsum('ai,bj,ck,dl,iujvkwlx->aubvcwdx',
+                           *[c2s_matrix(l) for l in ls], cart,
+                           optimize=True)
+        ref = ref.reshape([(l*2+1)*nc for l, nc in zip(ls, nctrs)], order='F')
+
+        out = mol.shell_block('int2e_sph', shls, opt=opt)[...,0]
+        max_error = max(max_error, abs(out - ref).max())
+    mol.del_optimizer(opt)
+    print('max error', max_error)
+    assert max_error < 1e-10
+    print('test_c2s_prim .. pass')
+
+if __name__ == '__main__':
+    test_c2s_prim()
@@ -0,0 +1,126 @@
+import ctypes
+import threading
+import numpy
+from mole import cint, Mole, ptr, WATER, PTR_RANGE_OMEGA
+
+# a contracted h shell next to s shells
+HIGH_L_BASIS = {
+    8: [(0, [15.5396, 3.59993, 1.01376], [[.0708743, .339753, .727159]]),
+        (5, [3.2, 1.4, .6, .25], [[.2, .4, .4, .3]])],
+    1: [(0, [18.7311, 2.82539, .640122], [[.0334946, .234727, .813757]]),
+        (5, [2.5, .9, .3], [[.3, .5, .4]])],
+}
+
+def test_high_l_multi_comp_cache():
+    '''The cache size reported by the size query must hold the buffers of
+    the optimized loop for multi-component integrals with len0 > leng'''
+    print('test high-l multi-component int2e with optimizer')
+    mol = Mole(basis=HIGH_L_BASIS)
+    opt = mol.optimizer('int2e_ipip1_optimizer')
+    ncomp = 9
+    guard = 64
+    max_error = 0
+    for shls in [(1, 1, 0, 1), (1, 3, 2, 1), (3, 3, 0, 1), (1, 1, 1, 1)]:
+        shls = numpy.asarray(shls, dtype=numpy.int32)
+        dims = [int(mol.ao_loc[i+1] - mol.ao_loc[i]) for i in shls]
+        cache_size = cint.int2e_ipip1_sph(None, None, ptr(shls), *mol.args(),
+                                          opt, None)
+        cache = numpy.empty(cache_size + guard)
+        cache[cache_size:] = 1e300
+        out = numpy.zeros(dims + [ncomp], order='F')
+        cint.int2e_ipip1_sph(ptr(out), None, ptr(shls), *mol.args(),
+                             opt, ptr(cache))
+        assert (cache[cache_size:] == 1e300).all()
+
+        ref = mol.shell_block('int2e_ipip1_sph', shls, ncomp)
+        max_error = max(max_error, abs(out - ref).max())
+    mol.del_optimizer(opt)
+    assert max_error < 1e-9
+    print('test_high_l_multi_comp_cache .. pass')
+
+def test_optimizer_rys_order():
+    '''One optimizer used with operators of different numbers of Rys roots'''
+    print('test optimizer shared by calls with different omega')
+    mol = Mole(maxl=2)
+    shls_list = [(i, j, k, l) for i in range(mol.nbas) for j in range(mol.nbas)
+                 for k in range(0, mol.nbas, 2) for l in range(0, mol.nbas, 3)]
+    def eri(omega, opt):
+        mol.env[PTR_RANGE_OMEGA] = omega
+        return [mol.shell_block('int2e_sph', shls, opt=opt)[...,0]
+                for shls in shls_list]
+
+    def max_error(a, b):
+        return max(abs(x - y).max() for x, y in zip(a, b))
+
+    ref0 = eri(0., None)
+    ref1 = eri(-.6, None)
+
+    # optimizer at omega=0, first called with omega=-0.6
+    mol.env[PTR_RANGE_OMEGA] = 0.
+    opt = mol.optimizer('int2e_optimizer')
+    assert max_error(eri(-.6, opt), ref1) < 1e-10
+    assert max_error(eri(0., opt), ref0) < 1e-10
+    mol.del_optimizer(opt)
+
+    # optimizer at omega=-0.6, first called with omega=0
+    mol.env[PTR_RANGE_OMEGA] = -.6
+    opt = mol.optimizer('int2e_optimizer')
+    assert max_error(eri(0., opt), ref0) < 1e-10
+    assert max_error(eri(-.6, opt), ref1) < 1e-10
+    mol.del_optimizer(opt)
+    mol.env[PTR_RANGE_OMEGA] = 0.
+    print('test_optimizer_rys_order .. pass')
+
+def test_update_geometry():
+    '''Pair data updated in place (one optimizer) and re-acquired (shared)'''
+    print('test CINTOpt_update_geometry')
+    mol = Mole(maxl=2)
+    moved = [(z, tuple(numpy.add(c, (.1, -.2, .15*ia))))
+             for ia, (z, c) in enumerate(WATER)]
+    mol1 = Mole(atoms=moved, maxl=2)
+    ref = mol1.int2e()
+
+    opt = mol.optimizer('int2e_optimizer')
+    cint.CINTOpt_update_geometry(opt, *mol1.args())
+    assert abs(mol1.int2e(opt=opt) - ref).max() < 1e-12
+
+    opt1 = mol.optimizer('int2e_optimizer')
+    opt2 = mol.optimizer('int2e_optimizer')
+    cint.CINTOpt_update_geometry(opt1, *mol1.args())
+    assert abs(mol1.int2e(opt=opt1) - ref).max() < 1e-12
+    # opt2 keeps the pair data of the old geometry
+    assert abs(mol.int2e(opt=opt2) - mol.int2e()).max() < 1e-12
+    for o in (opt, opt1, opt2):
+        mol.del_optimizer(o)
+    print('test_update_geometry .. pass')
+
+def test_concurrent_optimizers():
+    '''Optimizers of the same basis created and released by several threads
+    share the basis data'''
+    print('test optimizers created concurrently')
+    mol = Mole(maxl=2)
+    shls_list = [(i, j, k, l) for i in range(mol.nbas) for j in range(0, mol.nbas, 2)
+                 for k in range(0, mol.nbas, 3) for l in range(mol.nbas)]
+    ref = [mol.shell_block('int2e_sph', shls) for shls in shls_list]
+    errors = []
+    def run():
+        for n in range(10):
+            opt = mol.optimizer('int2e_optimizer')
+            if n % 3 == 0:
+                errors.append(max(abs(mol.shell_block('int2e_sph', shls, opt=opt) - r).max()
+                                  for shls, r in zip(shls_list, ref)))
+            mol.del_optimizer(opt)
+    threads = [threading.Thread(target=run) for i in range(8)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert len(errors) == 32
+    assert max(errors) < 1e-12
+    print('test_concurrent_optimizers .. pass')
+
+if __name__ == '__main__':
+    test_high_l_multi_comp_cache()
+    test_optimizer_rys_order()
+    test_update_geometry()
+    test_concurrent_optimizers()
@@ -0,0 +1,80 @@
+import ctypes
+import numpy
+from mole import cint, Mole, ptr, PTR_RANGE_OMEGA
+
+NRSH_OMEGA = 14
+PTR_RSH_OMEGA = 15
+PTR_RSH_COEFF = 16
+
+def set_rsh_operators(mol, omegas, coeffs=None):
+    '''Append omegas and coeffs to mol.env and point the int2e_rsh slots to them'''
+    env = list(mol.env)
+    mol.env = numpy.asarray(env + list(omegas) + list(coeffs or []), dtype=numpy.double)
+    mol.env[NRSH_OMEGA] = len(omegas)
+    mol.env[PTR_RSH_OMEGA] = len(env)
+    if coeffs is None:
+        mol.env[PTR_RSH_COEFF] = 0
+    else:
+        mol.env[PTR_RSH_COEFF] = len(env) + len(omegas)
+
+def test_int2e_rsh():
+    print('test int2e_rsh against int2e with env[PTR_RANGE_OMEGA]')
+    mol = Mole(maxl=2)
+    omegas = [0., .4, -.6]
+    coeffs = [.25, -.6, 1.3]
+    nomega = len(omegas)
+    shls_list = [(i, j, k, l) for i in range(mol.nbas) for j in range(0, mol.nbas, 2)
+                 for k in range(0, mol.nbas, 3) for l in range(1, mol.nbas, 2)]
+
+    refs = []
+    for omega in omegas:
+        mol.env[PTR_RANGE_OMEGA] = omega
+        refs.append([mol.shell_block('int2e_sph', shls)[...,0] for shls in shls_list])
+    mol.env[PTR_RANGE_OMEGA] = 0
+
+    opt = mol.optimizer('int2e_optimizer')
+    max_error = 0
+    for n, shls in enumerate(shls_list):
+        for o in (None, opt):
+            set_rsh_operators(mol, omegas)
+            out = mol.shell_block('int2e_rsh_sph', shls, nomega, o)
+            for m in range(nomega):
+                max_error = max(max_error, abs(out[...,m] - refs[m][n]).max())
+
+            set_rsh_operators(mol, omegas, coeffs)
+            out = mol.shell_block('int2e_rsh_sph', shls, 1, o)[...,0]
+            ref = sum(c * refs[m][n] for m, c in enumerate(coeffs))
+            max_error = max(max_error, abs(out - ref).max())
+    mol.del_optimizer(opt)
+    print(max_error)
+    assert max_error < 1e-12
+    print('test_int2e_rsh .. pass')
+
+def test_int2e_rsh_fill():
+    print('test int2e_rsh with CINTeri_fill_s8')
+    mol = Mole(maxl=1)
+    omegas = [0., -.6]
+    coeffs = [.5, 1.2]
+    ref = 0
+    for omega, c in zip(omegas, coeffs):
+        mol.env[PTR_RANGE_OMEGA] = omega
+        ref = ref + c * mol.int2e()[...,0]
+    mol.env[PTR_RANGE_OMEGA] = 0
+    idx = numpy.tril_indices(mol.nao)
+    ref = ref[idx][:,idx[0],idx[1]]
+    ref = ref[numpy.tril_indices(len(idx[0]))]
+
+    set_rsh_operators(mol, omegas, coeffs)
+    opt = mol.optimizer('int2e_optimizer')
+    for o in (None, opt):
+        out = numpy.zeros(ref.size)
+        shls_slice = numpy.asarray([0, mol.nbas], dtype=numpy.int32)
+        cint.CINTeri_fill_s8(ptr(out), cint.int2e_rsh_sph, ptr(mol.ao_loc),
+                             ptr(shls_slice), o, *mol.args())
+        assert abs(out - ref).max() < 1e-12
+    mol.del_optimizer(opt)
+    print('test_int2e_rsh_fill .. pass')
+
+if __name__ == '__main__':
+    test_int2e_rsh()
+    test_int2e_rsh_fill()
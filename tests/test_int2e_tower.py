@@ -0,0 +1,63 @@
+import numpy
+from mole import Mole, WATER, WATER_BASIS, PTR_COORD, ATOM_OF
+
+# shells of the bra on a ghost atom of their own, for the finite differences
+BASIS = dict(WATER_BASIS)
+BASIS[0] = [(0, [1.3], [[1.]]),
+            (1, [.9, .3], [[.6, .5]]),
+            (2, [1.2], [[1.]])]
+ATOMS = WATER + [(0, (.3, .2, -.8))]
+GHOST = 3
+
+def test_tower_vs_int2e_ip():
+    print('test int2e_tower1/2 against int2e, int2e_ip1, int2e_ipip1')
+    mol = Mole(atoms=ATOMS, basis=BASIS, maxl=2)
+    ghost = [i for i in range(mol.nbas) if mol.bas[i,ATOM_OF] == GHOST]
+    max_error = 0
+    for ish in ghost:
+        for shls in [(ish, 0, 1, 2), (ish, 3, 5, 4), (ish, ish, 6, 6), (ish, 7, ish, 1)]:
+            t1 = mol.shell_block('int2e_tower1_sph', shls, 4)
+            t2 = mol.shell_block('int2e_tower2_sph', shls, 13)
+            ref0 = mol.shell_block('int2e_sph', shls)
+            ref1 = mol.shell_block('int2e_ip1_sph', shls, 3)
+            ref2 = mol.shell_block('int2e_ipip1_sph', shls, 9)
+            max_error = max(max_error,
+                            abs(t1[...,:1] - ref0).max(),
+                            abs(t1[...,1:] - ref1).max(),
+                            abs(t2[...,:4] - t1).max(),
+                            abs(t2[...,4:] - ref2).max())
+    print(max_error)
+    assert max_error < 1e-12
+    print('test_tower_vs_int2e_ip .. pass')
+
+def test_tower3_finite_difference():
+    '''The third order block against -d/dR_i of int2e_ipip1'''
+    print('test int2e_tower3 against finite differences of int2e_ipip1')
+    mol = Mole(atoms=ATOMS, basis=BASIS, maxl=2)
+    ptr_coord = mol.atm[GHOST,PTR_COORD]
+    ghost = [i for i in range(mol.nbas) if mol.bas[i,ATOM_OF] == GHOST]
+    h = 1e-4
+    max_error = 0
+    for ish in ghost:
+        for shls in [(ish, 0, 1, 2), (ish, 3, 5, 4), (ish, 7, 6, 1)]:
+            t3 = mol.shell_block('int2e_tower3_sph', shls, 40)
+            t2 = mol.shell_block('int2e_tower2_sph', shls, 13)
+            d3 = numpy.empty_like(t3[...,13:])
+            for x in range(3):
+                mol.env[ptr_coord+x] += h
+                e1 = mol.shell_block('int2e_ipip1_sph', shls, 9)
+                mol.env[ptr_coord+x] -= 2*h
+                e0 = mol.shell_block('int2e_ipip1_sph', shls, 9)
+                mol.env[ptr_coord+x] += h
+                # the last nabla of the component runs slowest
+                d3[...,x*9:x*9+9] = -(e1 - e0) / (2*h)
+            max_error = max(max_error,
+                            abs(t3[...,:13] - t2).max(),
+                            abs(t3[...,13:] - d3).max())
+    print(max_error)
+    assert max_error < 1e-6
+    print('test_tower3_finite_difference .. pass')
+
+if __name__ == '__main__':
+    test_tower_vs_int2e_ip()
+    test_tower3_finite_difference()
@@ -0,0 +1,49 @@
+import numpy
+from mole import Mole
+
+PTR_MIXED_PRECISION = 13
+MIXED_PRECISION_LMAX = 8
+
+# s-g shells with tight and diffuse exponents
+BASIS = {
+    8: [(0, [50., 10.], [[.4, .6]]),
+        (0, [.5], [[1.]]),
+        (1, [20., 4.], [[.5, .5]]),
+        (2, [8., 2.], [[.5, .5]]),
+        (3, [5., 1.2], [[.5, .5]]),
+        (4, [3., .8], [[.5, .5]])],
+    1: [(0, [5., 1.], [[.5, .5]]),
+        (1, [3.], [[1.]]),
+        (2, [2.], [[1.]]),
+        (3, [1.5], [[1.]])],
+}
+
+def test_mixed_precision_accuracy():
+    print('test mixed precision int2e')
+    mol = Mole(basis=BASIS)
+    mol_f32 = Mole(basis=BASIS)
+    mol_f32.env[PTR_MIXED_PRECISION] = 1
+    ls = mol.bas[:,1]
+    max_value = 0
+    max_error = 0
+    max_error_high_l = 0
+    for i in range(mol.nbas):
+        for j in range(i+1):
+            for k in range(mol.nbas):
+                for l in range(k+1):
+                    shls = (i, j, k, l)
+                    ref = mol.shell_block('int2e_sph', shls)
+                    dat = mol_f32.shell_block('int2e_sph', shls)
+                    max_value = max(max_value, abs(ref).max())
+                    if ls[i] + ls[j] + ls[k] + ls[l] <= MIXED_PRECISION_LMAX:
+                        max_error = max(max_error, abs(dat - ref).max())
+                    else:
+                        max_error_high_l = max(max_error_high_l, abs(dat - ref).max())
+    print(max_value, max_error, max_error_high_l)
+    assert max_error < 1e-7 * max_value
+    # evaluated in double precision above MIXED_PRECISION_LMAX
+    assert max_error_high_l < 1e-13
+    print('test_mixed_precision_accuracy .. pass')
+
+if __name__ == '__main__':
+    test_mixed_precision_accuracy()
@@ -0,0 +1,64 @@
+import ctypes
+import numpy
+from mole import cint, Mole, ptr, WATER, PTR_COMMON_ORIG, ATOM_OF
+
+cint.CINTquartet_is_far.restype = ctypes.c_int
+
+def test_pair_multipole():
+    print('test int1e_pair_multipole against int1e_ovlp and int1e_r')
+    mol = Mole(maxl=2)
+    center = numpy.array([.2, -.4, .9])
+    mol.env[PTR_COMMON_ORIG:PTR_COMMON_ORIG+3] = center
+    nmom = cint.CINTpair_multipole_ncomp(ctypes.c_int(2))
+    assert nmom == 10
+    max_error = 0
+    for i in range(mol.nbas):
+        for j in range(mol.nbas):
+            shls = numpy.asarray([i, j], dtype=numpy.int32)
+            di = mol.ao_loc[i+1] - mol.ao_loc[i]
+            dj = mol.ao_loc[j+1] - mol.ao_loc[j]
+            out = numpy.zeros((di, dj, nmom), order='F')
+            cint.int1e_pair_multipole_sph(ptr(out), None, ctypes.c_int(2), ptr(center),
+                                          ptr(shls), *mol.args(), None, None)
+            s = mol.shell_block('int1e_ovlp_sph', (i, j))
+            r = mol.shell_block('int1e_r_sph', (i, j), 3)
+            max_error = max(max_error, abs(out[...,:1] - s).max(),
+                            abs(out[...,1:4] - r).max())
+    print(max_error)
+    assert max_error < 1e-12
+    print('test_pair_multipole .. pass')
+
+def test_int2e_far():
+    print('test int2e_far for two distant molecules')
+    shift = numpy.array([0., 14., 9.])
+    atoms = WATER + [(z, tuple(numpy.add(c, shift))) for z, c in WATER]
+    mol = Mole(atoms=atoms, maxl=2)
+    order = 8
+    eps = 1e-9
+    on_a = [i for i in range(mol.nbas) if mol.bas[i,ATOM_OF] < 3]
+    on_b = [i for i in range(mol.nbas) if mol.bas[i,ATOM_OF] >= 3]
+    nfar = 0
+    max_error = 0
+    for i in on_a[::2]:
+        for j in on_a[::3]:
+            for k in on_b[::2]:
+                for l in on_b[::3]:
+                    shls = numpy.asarray([i, j, k, l], dtype=numpy.int32)
+                    if not cint.CINTquartet_is_far(ctypes.c_int(order), ctypes.c_double(eps),
+                                                   ptr(shls), *mol.args()):
+                        continue
+                    nfar += 1
+                    dims = [int(mol.ao_loc[x+1] - mol.ao_loc[x]) for x in shls]
+                    out = numpy.zeros(dims, order='F')
+                    cint.int2e_far_sph(ptr(out), None, ctypes.c_int(order), ptr(shls),
+                                       *mol.args(), None)
+                    ref = mol.shell_block('int2e_sph', shls)[...,0]
+                    max_error = max(max_error, abs(out - ref).max())
+    print(nfar, max_error)
+    assert nfar > 0
+    assert max_error < eps
+    print('test_int2e_far .. pass')
+
+if __name__ == '__main__':
+    test_pair_multipole()
+    test_int2e_far()
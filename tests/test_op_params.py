@@ -0,0 +1,133 @@
+import ctypes
+import threading
+import numpy
+from mole import cint, Mole, ptr, PTR_COMMON_ORIG, PTR_RANGE_OMEGA
+
+PTR_RINV_ORIG = 4
+NGRIDS        = 11
+PTR_GRIDS     = 12
+
+class CINTOpParams(ctypes.Structure):
+    _fields_ = [('common_orig', ctypes.c_double * 3),
+                ('rinv_orig', ctypes.c_double * 3),
+                ('rinv_zeta', ctypes.c_double),
+                ('range_omega', ctypes.c_double),
+                ('f12_zeta', ctypes.c_double),
+                ('gtg_zeta', ctypes.c_double),
+                ('grids', ctypes.c_void_p)]
+
+def op_params(mol, **kwargs):
+    params = CINTOpParams()
+    cint.CINTinit_op_params(ctypes.byref(params), ptr(mol.env))
+    for key, val in kwargs.items():
+        if key in ('common_orig', 'rinv_orig'):
+            getattr(params, key)[:] = val
+        else:
+            setattr(params, key, val)
+    return params
+
+def call_with_params(mol, fname, params, shls, ncomp=1, dims=None):
+    if dims is None:
+        dims = [int(mol.ao_loc[i+1] - mol.ao_loc[i]) for i in shls]
+    out = numpy.zeros(list(dims) + [ncomp], order='F')
+    shls = numpy.asarray(shls, dtype=numpy.int32)
+    cint.CINTcall_with_params(getattr(cint, fname), ctypes.byref(params),
+                              ptr(out), None, ptr(shls), *mol.args(), None, None)
+    return out
+
+def test_params_vs_env():
+    print('test CINTcall_with_params against the parameters in env')
+    mol = Mole(maxl=2)
+    env0 = mol.env.copy()
+    max_error = 0
+    # the overridden parameters change the integrals
+    min_change = 1e9
+
+    for omega in (.3, -.5):
+        params = op_params(mol, range_omega=omega)
+        for shls in [(0, 6, 3, 8), (5, 9, 12, 1), (3, 10, 2, 13)]:
+            out = call_with_params(mol, 'int2e_sph', params, shls)
+            mol.env[PTR_RANGE_OMEGA] = omega
+            ref = mol.shell_block('int2e_sph', shls)
+            mol.env[:] = env0
+            max_error = max(max_error, abs(out - ref).max())
+        min_change = min(min_change, abs(out - mol.shell_block('int2e_sph', shls)).max())
+
+    r = (.3, -.8, 1.2)
+    params = op_params(mol, rinv_orig=r)
+    for shls in [(0, 6), (3, 8), (5, 12)]:
+        out = call_with_params(mol, 'int1e_rinv_sph', params, shls)
+        mol.env[PTR_RINV_ORIG:PTR_RINV_ORIG+3] = r
+        ref = mol.shell_block('int1e_rinv_sph', shls)
+        mol.env[:] = env0
+        max_error = max(max_error, abs(out - ref).max())
+    min_change = min(min_change, abs(out - mol.shell_block('int1e_rinv_sph', shls)).max())
+
+    r = (-1.1, .4, .7)
+    params = op_params(mol, common_orig=r)
+    for shls in [(0, 6), (3, 8), (5, 12)]:
+        out = call_with_params(mol, 'int1e_r_sph', params, shls, 3)
+        mol.env[PTR_COMMON_ORIG:PTR_COMMON_ORIG+3] = r
+        ref = mol.shell_block('int1e_r_sph', shls, 3)
+        mol.env[:] = env0
+        max_error = max(max_error, abs(out - ref).max())
+    min_change = min(min_change, abs(out - mol.shell_block('int1e_r_sph', shls, 3)).max())
+
+    numpy.random.seed(7)
+    grids = numpy.random.rand(23, 3) * 6 - 3
+    params = op_params(mol)
+    params.grids = grids.ctypes.data
+    for i, j in [(0, 6), (3, 8), (5, 12)]:
+        di = int(mol.ao_loc[i+1] - mol.ao_loc[i])
+        dj = int(mol.ao_loc[j+1] - mol.ao_loc[j])
+        shls = (i, j, 0, len(grids))
+        out = call_with_params(mol, 'int1e_grids_sph', params, shls,
+                               dims=(len(grids), di, dj))
+        mol.env = numpy.hstack([env0, grids.ravel()])
+        mol.env[NGRIDS] = len(grids)
+        mol.env[PTR_GRIDS] = len(env0)
+        ref = numpy.zeros((len(grids), di, dj, 1), order='F')
+        cint.int1e_grids_sph(ptr(ref), None, ptr(numpy.asarray(shls, dtype=numpy.int32)),
+                             *mol.args(), None, None)
+        mol.env = env0.copy()
+        max_error = max(max_error, abs(out - ref).max())
+    print(max_error, min_change)
+    assert max_error < 1e-12
+    assert min_change > 1e-4
+    print('test_params_vs_env .. pass')
+
+def test_concurrent_params():
+    '''Two threads evaluate the same integrals on the same env with different
+    operator parameters'''
+    print('test CINTcall_with_params in two threads')
+    mol = Mole(maxl=2)
+    shls_list = [(i, j, k, l) for i in range(0, mol.nbas, 2) for j in range(mol.nbas)
+                 for k in range(1, mol.nbas, 3) for l in range(0, mol.nbas, 4)]
+    omegas = (.4, -.7)
+    refs = []
+    for omega in omegas:
+        mol.env[PTR_RANGE_OMEGA] = omega
+        refs.append([mol.shell_block('int2e_sph', shls) for shls in shls_list])
+    mol.env[PTR_RANGE_OMEGA] = 0
+
+    errors = [0] * len(omegas)
+    def run(n):
+        params = op_params(mol, range_omega=omegas[n])
+        for cycle in range(3):
+            for shls, ref in zip(shls_list, refs[n]):
+                out = call_with_params(mol, 'int2e_sph', params, shls)
+                errors[n] = max(errors[n], abs(out - ref).max())
+
+    threads = [threading.Thread(target=run, args=(n,)) for n in range(len(omegas))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    print(errors)
+    assert max(errors) < 1e-12
+    assert mol.env[PTR_RANGE_OMEGA] == 0
+    print('test_concurrent_params .. pass')
+
+if __name__ == '__main__':
+    test_params_vs_env()
+    test_concurrent_params()
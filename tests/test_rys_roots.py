@@ -117,6 +117,36 @@ def test_rys_roots_weights():
     assert max_w_error < 1e-7
     print('test_rys_roots_weights .. pass')
 
+def test_rys_roots_weights_high_order():
+    print('test rys_roots_weights for 15-32 roots')
+    import mpmath
+    # 60 digits (set by rys_wheeler) are not enough for the moment method
+    # of the reference with 32 roots
+    dps, mpmath.mp.dps = mpmath.mp.dps, 120
+    def check(nroots, x):
+        r_ref, w_ref = rys_roots.rys_roots_weights(nroots, x)
+        r_ref = np.array(r_ref).astype(float)
+        w_ref = np.array(w_ref).astype(float)
+        r, w = cint_call('CINTrys_roots', nroots, x)
+        return np.array([abs((r-r_ref)/r_ref).max(),
+                         abs(w-w_ref).max() / w_ref.max()])
+
+    max_r_error = 0
+    max_w_error = 0
+    # both sides of the segment boundary at x=40
+    es = [1e-3, .7, 5., 18., 37.5, 41., 90.]
+    for i in range(15, 33):
+        for x in es:
+            diffs = check(i, x)
+            if diffs[0] > 1e-13 or diffs[1] > 1e-13:
+                print('Errors for root', i, x, diffs)
+            max_r_error = max(max_r_error, diffs[0])
+            max_w_error = max(max_w_error, diffs[1])
+    mpmath.mp.dps = dps
+    assert max_r_error < 1e-12
+    assert max_w_error < 1e-12
+    print('test_rys_roots_weights_high_order .. pass')
+
 
 def test_rys_roots_weights_erfc():
     print('test sr-rys_roots_weights')
@@ -183,4 +213,5 @@ def test_stg_roots():
 if __name__ == '__main__':
     test_stg_roots()
     test_rys_roots_weights()
+    test_rys_roots_weights_high_order()
     test_rys_roots_weights_erfc()